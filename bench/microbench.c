@@ -0,0 +1,419 @@
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ball.h"
+#include "body.h"
+#include "collision.h"
+#include "polygon.h"
+#include "scene.h"
+#include "table.h"
+#include "timing.h"
+#include "vector.h"
+
+// Times the small kernels the physics runs thousands of times per tick:
+// the vec_* operations, the polygon functions on a ball's 50-gon,
+// find_collision() between cushions and balls, find_collision_balls() and body_tick().
+// For each one, prints the time and the number of allocations per call,
+// and with -o, writes the results as JSON so they can be compared between commits.
+// usage: microbench [-t seconds] [-f filter] [-c commit] [-o out.json]
+// -t is the least time to spend timing each benchmark (default 0.2),
+// -f runs only the benchmarks whose names contain the filter,
+// and -c is stored in the JSON to say which commit was measured.
+//
+// Allocations are counted by wrapping malloc(), calloc() and realloc(),
+// so this must be linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc (see "make bench").
+
+const double DEFAULT_MIN_SECONDS = 0.2;
+// How many different vectors the vec_* benchmarks cycle through
+#define NUM_VECTORS 1024
+const double DT = 1.0 / 120;
+const double BALL_SIZE = 10.5;
+const double BODY_MASS = 171;
+// How far towards the middle of the table a ball is moved to miss a cushion
+const double MISS_DISTANCE = 100;
+
+size_t allocations = 0;
+size_t allocated_bytes = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    allocations++;
+    allocated_bytes += size;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    allocations++;
+    allocated_bytes += count * size;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size) {
+    allocations++;
+    allocated_bytes += size;
+    return __real_realloc(pointer, size);
+}
+
+// Results are added into this so the calls cannot be optimized away
+volatile double sink;
+
+/**
+ * What every benchmark works on, set up once before any are timed.
+ */
+typedef struct {
+    vector_t vectors[NUM_VECTORS];
+    list_t *ball_shape;
+    scene_t *table;
+    // Balls overlapping and missing the first cushion
+    body_t *cushion_hit;
+    body_t *cushion_miss;
+    // Two balls touching, and two balls far apart
+    body_t *touching[2];
+    body_t *apart[2];
+    body_t *moving;
+} fixture_t;
+
+/**
+ * Calls a kernel iterations times.
+ */
+typedef void (*bench_func_t)(fixture_t *fixture, size_t iterations);
+
+typedef struct {
+    const char *name;
+    bench_func_t run;
+} benchmark_t;
+
+typedef struct {
+    size_t iterations;
+    double ns_per_op;
+    double allocs_per_op;
+    double bytes_per_op;
+} bench_result_t;
+
+body_t *make_bench_ball(vector_t centroid) {
+    body_t *ball = body_init(make_ball_shape(BALL_SIZE), BODY_MASS, (rgb_color_t){1, 1, 1});
+    body_set_centroid(ball, centroid);
+    return ball;
+}
+
+fixture_t *fixture_init(void) {
+    fixture_t *fixture = malloc(sizeof(fixture_t));
+    assert(fixture != NULL);
+    srand(0);
+    for (size_t i = 0; i < NUM_VECTORS; i++) {
+        fixture->vectors[i] = (vector_t){
+            rand() / (double)RAND_MAX * 200 - 100,
+            rand() / (double)RAND_MAX * 200 - 100
+        };
+    }
+    fixture->ball_shape = make_ball_shape(BALL_SIZE);
+    polygon_translate(fixture->ball_shape, (vector_t){300, 200});
+
+    fixture->table = table_scene_init();
+    vector_t middle = VEC_ZERO;
+    for (size_t i = 0; i < TABLE_CUSHIONS; i++) {
+        middle = vec_add(middle, body_get_centroid(table_get_cushion(fixture->table, i)));
+    }
+    middle = vec_multiply(1.0 / TABLE_CUSHIONS, middle);
+    vector_t cushion = body_get_centroid(table_get_cushion(fixture->table, 0));
+    vector_t inwards = vec_normalize(vec_subtract(middle, cushion));
+    fixture->cushion_hit = make_bench_ball(cushion);
+    fixture->cushion_miss = make_bench_ball(vec_add(cushion, vec_multiply(MISS_DISTANCE, inwards)));
+
+    fixture->touching[0] = make_bench_ball(middle);
+    fixture->touching[1] = make_bench_ball(vec_add(middle, (vector_t){1.5 * BALL_SIZE, 0}));
+    fixture->apart[0] = make_bench_ball(middle);
+    fixture->apart[1] = make_bench_ball(vec_add(middle, (vector_t){10 * BALL_SIZE, 0}));
+    fixture->moving = make_bench_ball(middle);
+    return fixture;
+}
+
+void fixture_free(fixture_t *fixture) {
+    list_free(fixture->ball_shape);
+    scene_free(fixture->table);
+    body_free(fixture->cushion_hit);
+    body_free(fixture->cushion_miss);
+    for (size_t i = 0; i < 2; i++) {
+        body_free(fixture->touching[i]);
+        body_free(fixture->apart[i]);
+    }
+    body_free(fixture->moving);
+    free(fixture);
+}
+
+vector_t nth_vector(fixture_t *fixture, size_t i) {
+    return fixture->vectors[i % NUM_VECTORS];
+}
+
+void bench_vec_add(fixture_t *fixture, size_t iterations) {
+    vector_t sum = VEC_ZERO;
+    for (size_t i = 0; i < iterations; i++) {
+        sum = vec_add(sum, nth_vector(fixture, i));
+    }
+    sink += sum.x + sum.y;
+}
+
+void bench_vec_subtract(fixture_t *fixture, size_t iterations) {
+    vector_t sum = VEC_ZERO;
+    for (size_t i = 0; i < iterations; i++) {
+        sum = vec_subtract(sum, nth_vector(fixture, i));
+    }
+    sink += sum.x + sum.y;
+}
+
+void bench_vec_multiply(fixture_t *fixture, size_t iterations) {
+    double sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        sum += vec_multiply(0.5, nth_vector(fixture, i)).x;
+    }
+    sink += sum;
+}
+
+void bench_vec_dot(fixture_t *fixture, size_t iterations) {
+    double sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        sum += vec_dot(nth_vector(fixture, i), nth_vector(fixture, i + 1));
+    }
+    sink += sum;
+}
+
+void bench_vec_cross(fixture_t *fixture, size_t iterations) {
+    double sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        sum += vec_cross(nth_vector(fixture, i), nth_vector(fixture, i + 1));
+    }
+    sink += sum;
+}
+
+void bench_vec_rotate(fixture_t *fixture, size_t iterations) {
+    double sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        sum += vec_rotate(nth_vector(fixture, i), i * 0.001).x;
+    }
+    sink += sum;
+}
+
+void bench_vec_magnitude(fixture_t *fixture, size_t iterations) {
+    double sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        sum += vec_magnitude(nth_vector(fixture, i));
+    }
+    sink += sum;
+}
+
+void bench_vec_normalize(fixture_t *fixture, size_t iterations) {
+    double sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        sum += vec_normalize(nth_vector(fixture, i)).x;
+    }
+    sink += sum;
+}
+
+void bench_polygon_area(fixture_t *fixture, size_t iterations) {
+    double sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        sum += polygon_area(fixture->ball_shape);
+    }
+    sink += sum;
+}
+
+void bench_polygon_centroid(fixture_t *fixture, size_t iterations) {
+    double sum = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        sum += polygon_centroid(fixture->ball_shape).x;
+    }
+    sink += sum;
+}
+
+void bench_polygon_rotate(fixture_t *fixture, size_t iterations) {
+    vector_t point = {300, 200};
+    for (size_t i = 0; i < iterations; i++) {
+        polygon_rotate(fixture->ball_shape, 0.01, point);
+    }
+}
+
+void bench_collision_cushion_hit(fixture_t *fixture, size_t iterations) {
+    list_t *cushion = body_borrow_shape(table_get_cushion(fixture->table, 0));
+    list_t *ball = body_borrow_shape(fixture->cushion_hit);
+    size_t hits = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        hits += find_collision(cushion, ball).collided;
+    }
+    assert(hits == iterations);
+}
+
+void bench_collision_cushion_miss(fixture_t *fixture, size_t iterations) {
+    list_t *cushion = body_borrow_shape(table_get_cushion(fixture->table, 0));
+    list_t *ball = body_borrow_shape(fixture->cushion_miss);
+    size_t hits = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        hits += find_collision(cushion, ball).collided;
+    }
+    assert(hits == 0);
+}
+
+void bench_collision_50gon(fixture_t *fixture, size_t iterations) {
+    list_t *shape1 = body_borrow_shape(fixture->touching[0]);
+    list_t *shape2 = body_borrow_shape(fixture->touching[1]);
+    size_t hits = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        hits += find_collision(shape1, shape2).collided;
+    }
+    assert(hits == iterations);
+}
+
+void bench_collision_balls_hit(fixture_t *fixture, size_t iterations) {
+    size_t hits = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        hits += find_collision_balls(fixture->touching[0], fixture->touching[1]).collided;
+    }
+    assert(hits == iterations);
+}
+
+void bench_collision_balls_miss(fixture_t *fixture, size_t iterations) {
+    size_t hits = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        hits += find_collision_balls(fixture->apart[0], fixture->apart[1]).collided;
+    }
+    assert(hits == 0);
+}
+
+void bench_body_tick(fixture_t *fixture, size_t iterations) {
+    body_t *body = fixture->moving;
+    for (size_t i = 0; i < iterations; i++) {
+        // Reversing every tick keeps the ball near where it started
+        body_set_velocity(body, (vector_t){i % 2 == 0 ? 300 : -300, 100});
+        body_add_force(body, (vector_t){-10, 5});
+        body_tick(body, DT);
+    }
+    sink += body_get_centroid(body).x;
+}
+
+const benchmark_t BENCHMARKS[] = {
+    {"vec_add", bench_vec_add},
+    {"vec_subtract", bench_vec_subtract},
+    {"vec_multiply", bench_vec_multiply},
+    {"vec_dot", bench_vec_dot},
+    {"vec_cross", bench_vec_cross},
+    {"vec_rotate", bench_vec_rotate},
+    {"vec_magnitude", bench_vec_magnitude},
+    {"vec_normalize", bench_vec_normalize},
+    {"polygon_area/50gon", bench_polygon_area},
+    {"polygon_centroid/50gon", bench_polygon_centroid},
+    {"polygon_rotate/50gon", bench_polygon_rotate},
+    {"find_collision/cushion_hit", bench_collision_cushion_hit},
+    {"find_collision/cushion_miss", bench_collision_cushion_miss},
+    {"find_collision/50gon_hit", bench_collision_50gon},
+    {"find_collision_balls/hit", bench_collision_balls_hit},
+    {"find_collision_balls/miss", bench_collision_balls_miss},
+    {"body_tick", bench_body_tick}
+};
+const size_t NUM_BENCHMARKS = sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]);
+
+/**
+ * Runs a benchmark with more and more iterations until it takes at least min_seconds,
+ * like Go's testing.B, and measures the last run.
+ */
+bench_result_t run_benchmark(const benchmark_t *benchmark, fixture_t *fixture, double min_seconds) {
+    size_t iterations = 1;
+    while (true) {
+        size_t allocations_before = allocations;
+        size_t bytes_before = allocated_bytes;
+        struct timespec start = timing_now();
+        benchmark->run(fixture, iterations);
+        double seconds = seconds_since(start);
+        if (seconds >= min_seconds) {
+            return (bench_result_t){
+                .iterations = iterations,
+                .ns_per_op = seconds * 1e9 / iterations,
+                .allocs_per_op = (double)(allocations - allocations_before) / iterations,
+                .bytes_per_op = (double)(allocated_bytes - bytes_before) / iterations
+            };
+        }
+        // Aim a little past min_seconds, growing at most 100 times per run
+        double scale = seconds > 0 ? 1.2 * min_seconds / seconds : 100;
+        iterations = (size_t)(iterations * (scale < 100 ? scale : 100)) + 1;
+    }
+}
+
+void write_json(
+    FILE *file,
+    const char *commit,
+    const bench_result_t *results,
+    const bool *ran
+) {
+    fprintf(file, "{\n  \"commit\": \"%s\",\n  \"benchmarks\": [", commit);
+    bool first = true;
+    for (size_t i = 0; i < NUM_BENCHMARKS; i++) {
+        if (!ran[i]) {
+            continue;
+        }
+        fprintf(file, "%s\n    {\"name\": \"%s\", \"iterations\": %zu, \"ns_per_op\": %.3f, "
+                "\"allocs_per_op\": %.3f, \"bytes_per_op\": %.1f}",
+                first ? "" : ",", BENCHMARKS[i].name, results[i].iterations,
+                results[i].ns_per_op, results[i].allocs_per_op, results[i].bytes_per_op);
+        first = false;
+    }
+    fprintf(file, "\n  ]\n}\n");
+}
+
+int main(int argc, char **argv) {
+    double min_seconds = DEFAULT_MIN_SECONDS;
+    const char *filter = NULL;
+    const char *commit = "";
+    const char *out_path = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:f:c:o:")) != -1) {
+        switch (opt) {
+            case 't':
+                min_seconds = atof(optarg);
+                break;
+            case 'f':
+                filter = optarg;
+                break;
+            case 'c':
+                commit = optarg;
+                break;
+            case 'o':
+                out_path = optarg;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-t seconds] [-f filter] [-c commit] [-o out.json]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+
+    fixture_t *fixture = fixture_init();
+    bench_result_t results[NUM_BENCHMARKS];
+    bool ran[NUM_BENCHMARKS];
+    printf("%-30s %12s %12s %10s %10s\n", "benchmark", "iterations", "ns/op", "allocs/op", "B/op");
+    for (size_t i = 0; i < NUM_BENCHMARKS; i++) {
+        ran[i] = filter == NULL || strstr(BENCHMARKS[i].name, filter) != NULL;
+        if (!ran[i]) {
+            continue;
+        }
+        results[i] = run_benchmark(&BENCHMARKS[i], fixture, min_seconds);
+        printf("%-30s %12zu %12.2f %10.2f %10.1f\n", BENCHMARKS[i].name, results[i].iterations,
+               results[i].ns_per_op, results[i].allocs_per_op, results[i].bytes_per_op);
+    }
+    fixture_free(fixture);
+
+    if (out_path != NULL) {
+        FILE *file = fopen(out_path, "w");
+        if (file == NULL) {
+            perror(out_path);
+            return 1;
+        }
+        write_json(file, commit, results, ran);
+        fclose(file);
+    }
+    return 0;
+}
@@ -0,0 +1,23 @@
+#include <stdio.h>
+#include "sdl_wrapper.h"
+
+// Decodes every image the game draws and renders its font,
+// and writes the results to an asset pack that the game maps in at startup.
+// Run it from the repository root again whenever an asset changes.
+// usage: asset_packer [pack]
+
+const char DEFAULT_PACK[] = "./assets/assets.pack";
+
+int main(int argc, char **argv) {
+    if (argc > 2) {
+        fprintf(stderr, "usage: %s [pack]\n", argv[0]);
+        return 1;
+    }
+    const char *path = argc == 2 ? argv[1] : DEFAULT_PACK;
+    if (!sdl_write_asset_pack(path)) {
+        fprintf(stderr, "could not write %s\n", path);
+        return 1;
+    }
+    printf("wrote %s\n", path);
+    return 0;
+}
@@ -7,6 +7,7 @@
 #include "forces.h"
 #include "scene.h"
 #include "sdl_wrapper.h"
+#include "spring_network.h"
 
 const int MIN_Y = 0;
 const int MIN_X = 0;
@@ -59,6 +60,8 @@ body_t *generate_circle() {
 }
 
 void populate_scene(scene_t *scene) {
+    list_t *circles = list_init(NUM_CIRCLES, NULL);
+    spring_network_t *springs = spring_network_init();
     for (size_t i = 0; i < NUM_CIRCLES; i++) {
         // create anchor
         body_t *anchor = generate_anchor();
@@ -71,12 +74,16 @@ void populate_scene(scene_t *scene) {
         scene_add_body(scene, anchor);
         scene_add_body(scene, circle);
         // create spring force between each circle and anchor
-        create_spring(scene, SPRING_K * pow(K_DECAY, i), anchor, circle);
-        create_drag(scene, DRAG_GAMMA, circle);
+        size_t anchor_index = spring_network_add_body(springs, anchor);
+        size_t circle_index = spring_network_add_body(springs, circle);
+        spring_network_add(springs, SPRING_K * pow(K_DECAY, i), anchor_index, circle_index);
+        list_add(circles, circle);
         // add initial impulse to each body
         vector_t impulse = {0, INIT_IMPULSE};
         body_add_impulse(circle, impulse);
     }
+    create_spring_network(scene, springs);
+    create_group_drag(scene, DRAG_GAMMA, circles);
 }
 
 int main() {
@@ -0,0 +1,119 @@
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "forces.h"
+#include "scene.h"
+#include "timing.h"
+
+// Compares the integrators on two scenes whose energy should stay constant:
+// a planet orbiting a sun and a mass on a spring to a fixed anchor.
+// For each integrator and dt, prints the worst relative energy error over the
+// run and the time per tick, to pick the cheapest integrator that holds energy.
+// usage: integrator_bench [seconds]
+
+const double DEFAULT_SECONDS = 20;
+const double DTS[] = {1.0 / 120, 1.0 / 60, 1.0 / 30};
+const size_t NUM_DTS = sizeof(DTS) / sizeof(DTS[0]);
+const integrator_t INTEGRATORS[] = {
+    INTEGRATOR_TRAPEZOID, INTEGRATOR_SEMI_IMPLICIT_EULER,
+    INTEGRATOR_VELOCITY_VERLET, INTEGRATOR_RK4
+};
+const char *INTEGRATOR_NAMES[] = {"trapezoid", "euler", "verlet", "rk4"};
+const size_t NUM_INTEGRATORS = sizeof(INTEGRATORS) / sizeof(INTEGRATORS[0]);
+
+const double G = 20;
+const double SUN_MASS = 1e6;
+const double PLANET_MASS = 1;
+const double ORBIT_RADIUS = 200;
+const double SPRING_K = 100;
+const double SPRING_MASS = 25;
+const double SPRING_STRETCH = 100;
+const double BODY_SIZE = 2;
+
+body_t *make_body(vector_t center, double mass) {
+    list_t *points = list_init(4, (free_func_t)free);
+    for (int i = 0; i < 4; i++) {
+        vector_t *point = malloc(sizeof(vector_t));
+        assert(point != NULL);
+        point->x = center.x + (i == 0 || i == 3 ? -BODY_SIZE : BODY_SIZE);
+        point->y = center.y + (i < 2 ? -BODY_SIZE : BODY_SIZE);
+        list_add(points, point);
+    }
+    return body_init(points, mass, (rgb_color_t){1, 1, 1});
+}
+
+double kinetic_energy(body_t *body) {
+    vector_t v = body_get_velocity(body);
+    return 0.5 * body_get_mass(body) * vec_dot(v, v);
+}
+
+// a circular orbit with zero total momentum
+scene_t *orbit_scene(void) {
+    scene_t *scene = scene_init();
+    body_t *sun = make_body(VEC_ZERO, SUN_MASS);
+    body_t *planet = make_body((vector_t){ORBIT_RADIUS, 0}, PLANET_MASS);
+    double speed = sqrt(G * SUN_MASS / ORBIT_RADIUS);
+    body_set_velocity(planet, (vector_t){0, speed});
+    body_set_velocity(sun, (vector_t){0, -speed * PLANET_MASS / SUN_MASS});
+    scene_add_body(scene, sun);
+    scene_add_body(scene, planet);
+    create_newtonian_gravity(scene, G, sun, planet);
+    return scene;
+}
+
+double orbit_energy(scene_t *scene) {
+    body_t *sun = scene_get_body(scene, 0);
+    body_t *planet = scene_get_body(scene, 1);
+    double r = vec_magnitude(vec_subtract(body_get_centroid(sun), body_get_centroid(planet)));
+    return kinetic_energy(sun) + kinetic_energy(planet) - G * SUN_MASS * PLANET_MASS / r;
+}
+
+scene_t *spring_scene(void) {
+    scene_t *scene = scene_init();
+    body_t *anchor = make_body(VEC_ZERO, DBL_MAX);
+    body_t *mass = make_body((vector_t){SPRING_STRETCH, 0}, SPRING_MASS);
+    scene_add_body(scene, anchor);
+    scene_add_body(scene, mass);
+    create_spring(scene, SPRING_K, anchor, mass);
+    return scene;
+}
+
+double spring_energy(scene_t *scene) {
+    body_t *mass = scene_get_body(scene, 1);
+    vector_t x = vec_subtract(body_get_centroid(mass), body_get_centroid(scene_get_body(scene, 0)));
+    return kinetic_energy(mass) + 0.5 * SPRING_K * vec_dot(x, x);
+}
+
+void run(const char *name, scene_t *(*make)(void), double (*energy)(scene_t *), double seconds) {
+    printf("%s\n%-10s %8s %12s %10s\n", name, "integrator", "dt", "max dE/E", "us/tick");
+    for (size_t i = 0; i < NUM_INTEGRATORS; i++) {
+        for (size_t j = 0; j < NUM_DTS; j++) {
+            scene_t *scene = make();
+            scene_set_integrator(scene, INTEGRATORS[i]);
+            double start_energy = energy(scene);
+            double worst = 0;
+            int ticks = (int)(seconds / DTS[j]);
+            struct timespec start = timing_now();
+            for (int t = 0; t < ticks; t++) {
+                scene_tick(scene, DTS[j]);
+                double error = fabs(energy(scene) - start_energy) / fabs(start_energy);
+                worst = error > worst ? error : worst;
+            }
+            double elapsed = seconds_since(start);
+            printf("%-10s %8.5f %12.3e %10.2f\n", INTEGRATOR_NAMES[i], DTS[j], worst,
+                   elapsed * 1e6 / ticks);
+            scene_free(scene);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    double seconds = argc > 1 ? atof(argv[1]) : DEFAULT_SECONDS;
+    assert(seconds > 0);
+    run("orbit", orbit_scene, orbit_energy, seconds);
+    printf("\n");
+    run("spring", spring_scene, spring_energy, seconds);
+    return 0;
+}
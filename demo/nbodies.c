@@ -18,6 +18,8 @@ const int MIN_RADIUS = 10;
 const double DENSITY = 2;
 const int VERTICES = 4;
 const double G = 20;
+// Barnes-Hut accuracy; 0 computes every pair exactly
+const double THETA = 0.5;
 const double STAR_SCALE = 0.5;
 
 int generate_random_range(int lower, int upper) {
@@ -82,14 +84,14 @@ body_t *generate_body() {
 
 void scene_setup(scene_t *scene) {
     // add all bodies to initial scene
+    list_t *bodies = list_init(N_BODIES, NULL);
     for (int i = 0; i < N_BODIES; i++) {
-        scene_add_body(scene, generate_body());
-        // add gravity between all bodies
-        for (size_t j = 0; j < i; j++) {
-            create_newtonian_gravity(scene, G, scene_get_body(scene, i),
-                                     scene_get_body(scene, j));
-        }
+        body_t *body = generate_body();
+        scene_add_body(scene, body);
+        list_add(bodies, body);
     }
+    // add gravity between all bodies
+    create_nbody_gravity(scene, G, bodies, THETA);
 }
 
 int main() {
@@ -0,0 +1,136 @@
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "forces.h"
+#include "polygon.h"
+#include "scene.h"
+#include "timing.h"
+
+// Times n-body gravity without a window and measures how far the
+// Barnes-Hut approximation is from computing every pair exactly.
+// usage: nbody_sim [-s seed] [-n bodies] [-k ticks] [-q theta] [-m mode] [-x]
+// The mode picks the force creator: "tree" for create_nbody_gravity(),
+// "group" for create_group_gravity() or "pairs" for one
+// create_newtonian_gravity() per pair, as nbodies.c used to do.
+// With -x, the first tick is also run in exact mode (theta = 0)
+// and the relative RMS error in the resulting velocities is printed.
+
+const int DEFAULT_BODIES = 10000;
+const int DEFAULT_TICKS = 10;
+const double DEFAULT_THETA = 0.5;
+const double DT = 1.0 / 60.0;
+const double G = 20;
+const double DENSITY = 2;
+const double SIZE = 4;
+const vector_t WORLD = {4000, 2000};
+
+double random_range(double max) {
+    return max * rand() / RAND_MAX;
+}
+
+// a small square at a random position
+body_t *random_body(void) {
+    vector_t center = {random_range(WORLD.x), random_range(WORLD.y)};
+    double half = SIZE * (0.5 + random_range(1)) / 2;
+    list_t *points = list_init(4, (free_func_t)free);
+    for (int i = 0; i < 4; i++) {
+        vector_t *point = malloc(sizeof(vector_t));
+        assert(point != NULL);
+        point->x = center.x + (i == 0 || i == 3 ? -half : half);
+        point->y = center.y + (i < 2 ? -half : half);
+        list_add(points, point);
+    }
+    double mass = polygon_area(points) * DENSITY;
+    return body_init(points, mass, (rgb_color_t){1, 1, 1});
+}
+
+// a scene with the same random bodies for the same seed
+scene_t *make_scene(unsigned int seed, int n, double theta, const char *mode) {
+    srand(seed);
+    scene_t *scene = scene_init();
+    list_t *bodies = list_init(n, NULL);
+    for (int i = 0; i < n; i++) {
+        body_t *body = random_body();
+        scene_add_body(scene, body);
+        list_add(bodies, body);
+    }
+    if (strcmp(mode, "pairs") == 0) {
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < i; j++) {
+                create_newtonian_gravity(scene, G, list_get(bodies, i), list_get(bodies, j));
+            }
+        }
+        list_free(bodies);
+    } else if (strcmp(mode, "group") == 0) {
+        create_group_gravity(scene, G, bodies);
+    } else {
+        create_nbody_gravity(scene, G, bodies, theta);
+    }
+    return scene;
+}
+
+int main(int argc, char **argv) {
+    unsigned int seed = time(0);
+    int n = DEFAULT_BODIES;
+    int ticks = DEFAULT_TICKS;
+    double theta = DEFAULT_THETA;
+    const char *mode = "tree";
+    bool compare = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:n:k:q:m:x")) != -1) {
+        switch (opt) {
+            case 's': seed = strtoul(optarg, NULL, 10); break;
+            case 'n': n = atoi(optarg); break;
+            case 'k': ticks = atoi(optarg); break;
+            case 'q': theta = atof(optarg); break;
+            case 'm': mode = optarg; break;
+            case 'x': compare = true; break;
+            default:
+                fprintf(stderr, "usage: %s [-s seed] [-n bodies] [-k ticks] [-q theta] [-m tree|group|pairs] [-x]\n", argv[0]);
+                return 1;
+        }
+    }
+    assert(n > 0 && ticks > 0 && theta >= 0);
+    if (strcmp(mode, "tree") != 0 && strcmp(mode, "group") != 0 && strcmp(mode, "pairs") != 0) {
+        fprintf(stderr, "unknown mode %s\n", mode);
+        return 1;
+    }
+
+    printf("seed %u, %d bodies, %s, theta %g\n", seed, n, mode, theta);
+    scene_t *scene = make_scene(seed, n, theta, mode);
+    struct timespec start = timing_now();
+    scene_tick(scene, DT);
+    double first = seconds_since(start);
+
+    if (compare) {
+        scene_t *exact = make_scene(seed, n, 0, "tree");
+        start = timing_now();
+        scene_tick(exact, DT);
+        double exact_time = seconds_since(start);
+        double error = 0, norm = 0;
+        for (int i = 0; i < n; i++) {
+            vector_t want = body_get_velocity(scene_get_body(exact, i));
+            vector_t got = body_get_velocity(scene_get_body(scene, i));
+            vector_t diff = vec_subtract(got, want);
+            error += vec_dot(diff, diff);
+            norm += vec_dot(want, want);
+        }
+        printf("exact tick: %.2f ms, relative RMS error: %.2e\n",
+               exact_time * 1e3, norm > 0 ? sqrt(error / norm) : 0);
+        scene_free(exact);
+    }
+
+    start = timing_now();
+    for (int i = 1; i < ticks; i++) {
+        scene_tick(scene, DT);
+    }
+    double total = first + seconds_since(start);
+    printf("%d ticks: %.2f ms/tick, %.1f ticks/s\n", ticks, total * 1e3 / ticks, ticks / total);
+    scene_free(scene);
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "netplay.h"
+#include "scene.h"
+#include "table.h"
+#include "timing.h"
+#include "transport.h"
+
+// Plays a game between two computer players over a loopback that delays and drops packets,
+// each side with its own table and rollback, then checks both tables ended up the same
+// and prints how much rolling back it took.
+// usage: netplay_sim [-s seed] [-n ticks] [-l latency] [-p loss] [-r max_rollback]
+// The latency is in ticks each way.
+
+const int DEFAULT_TICKS = 120 * 60;
+const int DEFAULT_LATENCY = 6;
+const double DEFAULT_LOSS = 0.05;
+const int DEFAULT_MAX_ROLLBACK = 20;
+const double DT = 1.0 / 120.0;
+// How likely a player is to shoot on each tick of their turn
+const double SHOOT_CHANCE = 1.0 / 90;
+// How far a player sweeps the cue each tick while aiming, in radians
+const double AIM_STEP = 0.02;
+const double SHOT_MIN_POWER = 0.5;
+const double SHOT_MAX_POWER = 2.0;
+// How long a 60 Hz frame is, which a rollback has to fit in
+const double FRAME_SECONDS = 1.0 / 60.0;
+// The rollback length the frame budget is checked for
+const int BUDGET_TICKS = 10;
+
+double random_fraction(void) {
+    return (double)rand() / RAND_MAX;
+}
+
+/**
+ * Decides what a computer player does this tick, from their own view of the table.
+ */
+net_input_t choose_input(scene_t *scene, int player, double *aim) {
+    int state = scene_get_state(scene);
+    if (scene_get_turn(scene) != player || (state != PLACING && state != FIRING)
+        || balls_moving(scene_get_balls(scene))) {
+        return (net_input_t) {0};
+    }
+    *aim += AIM_STEP;
+    if (random_fraction() >= SHOOT_CHANCE) {
+        return (net_input_t) {.actions = NET_AIM, .angle = *aim};
+    }
+    net_input_t input = {
+        .actions = NET_SHOOT,
+        .angle = random_fraction() * 2 * M_PI,
+        .power = SHOT_MIN_POWER + random_fraction() * (SHOT_MAX_POWER - SHOT_MIN_POWER)
+    };
+    if (state == PLACING) {
+        input.actions |= NET_PLACE;
+        input.position = CUE_BALL_START;
+    }
+    return input;
+}
+
+int main(int argc, char **argv) {
+    unsigned int seed = time(0);
+    int ticks = DEFAULT_TICKS;
+    int latency = DEFAULT_LATENCY;
+    double loss = DEFAULT_LOSS;
+    int max_rollback = DEFAULT_MAX_ROLLBACK;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:n:l:p:r:")) != -1) {
+        switch (opt) {
+            case 's': seed = strtoul(optarg, NULL, 10); break;
+            case 'n': ticks = atoi(optarg); break;
+            case 'l': latency = atoi(optarg); break;
+            case 'p': loss = atof(optarg); break;
+            case 'r': max_rollback = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-s seed] [-n ticks] [-l latency] [-p loss] "
+                                "[-r max_rollback]\n", argv[0]);
+                return 1;
+        }
+    }
+    assert(ticks > 0 && latency >= 0 && 0 <= loss && loss < 1);
+    assert(max_rollback > 0 && max_rollback < NETPLAY_WINDOW);
+
+    loopback_t *loopback = loopback_init(latency, loss, seed);
+    scene_t *scenes[2];
+    netplay_t *games[2];
+    double aims[2] = {0, M_PI};
+    for (int p = 0; p < 2; p++) {
+        // Both sides rack the same way
+        srand(seed);
+        scenes[p] = scene_init();
+        scene_set_state(scenes[p], MENU);
+        populate_scene(scenes[p]);
+        scene_set_state(scenes[p], PLACING);
+        games[p] = netplay_init(scenes[p], p, loopback_get_end(loopback, p), DT, max_rollback);
+    }
+
+    struct timespec start = timing_now();
+    for (int i = 0; i < ticks; i++) {
+        for (int p = 0; p < 2; p++) {
+            netplay_advance(games[p], choose_input(scenes[p], p, &aims[p]));
+        }
+        loopback_tick(loopback);
+    }
+    // Then both sides catch up to the same tick and wait for all of each other's input
+    uint32_t end = netplay_get_tick(games[0]) > netplay_get_tick(games[1])
+        ? netplay_get_tick(games[0])
+        : netplay_get_tick(games[1]);
+    while (netplay_get_confirmed_tick(games[0]) < end || netplay_get_confirmed_tick(games[1]) < end) {
+        for (int p = 0; p < 2; p++) {
+            if (netplay_get_tick(games[p]) < end) {
+                netplay_advance(games[p], (net_input_t) {0});
+            }
+            else {
+                netplay_poll(games[p]);
+            }
+        }
+        loopback_tick(loopback);
+    }
+    double elapsed = seconds_since(start);
+
+    size_t sent, lost;
+    loopback_get_counts(loopback, &sent, &lost);
+    printf("seed %u, %d ticks played, %u simulated, latency %d, %.0f%% loss, max rollback %d\n",
+           seed, ticks, netplay_get_tick(games[0]), latency, loss * 100, max_rollback);
+    printf("%zu packets sent, %zu lost, %.3f s\n", sent, lost, elapsed);
+    double worst_per_tick = 0;
+    for (int p = 0; p < 2; p++) {
+        netplay_stats_t stats = netplay_get_stats(games[p]);
+        double per_tick = stats.resimulated_ticks > 0
+            ? stats.rollback_seconds / stats.resimulated_ticks
+            : 0;
+        if (per_tick > worst_per_tick) {
+            worst_per_tick = per_tick;
+        }
+        printf("player %d: %zu rollbacks, %zu ticks resimulated (at most %zu at once, "
+               "%.3f ms), %zu stalls, %.3f ms per resimulated tick\n",
+               p + 1, stats.rollbacks, stats.resimulated_ticks, stats.max_resimulated_ticks,
+               stats.max_rollback_seconds * 1e3, stats.stalls, per_tick * 1e3);
+    }
+    printf("resimulating %d ticks takes about %.3f ms of a %.1f ms frame\n",
+           BUDGET_TICKS, BUDGET_TICKS * worst_per_tick * 1e3, FRAME_SECONDS * 1e3);
+    double checksums[2] = {table_ball_checksum(scenes[0]), table_ball_checksum(scenes[1])};
+    bool in_sync = checksums[0] == checksums[1]
+                   && scene_get_state(scenes[0]) == scene_get_state(scenes[1])
+                   && scene_get_turn(scenes[0]) == scene_get_turn(scenes[1]);
+    printf("%s: state %d, ball checksums %.17g and %.17g\n", in_sync ? "in sync" : "OUT OF SYNC",
+           scene_get_state(scenes[0]), checksums[0], checksums[1]);
+
+    for (int p = 0; p < 2; p++) {
+        netplay_free(games[p]);
+        scene_free(scenes[p]);
+    }
+    loopback_free(loopback);
+    return in_sync ? 0 : 1;
+}
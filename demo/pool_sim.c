@@ -0,0 +1,87 @@
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "ball.h"
+#include "player.h"
+#include "scene.h"
+#include "table.h"
+
+// Plays shots on a pool table without a window, printing one line per shot.
+// usage: pool_sim [-s seed] [-n shots] [-a aim_degrees] [-p power] [-t dt] [-P]
+// Without -a, each shot is aimed in a random direction.
+// With -P, prints where the time in scene_tick() went when the game ends.
+
+const int DEFAULT_SHOTS = 10;
+const double DEFAULT_POWER = 2.0;
+const double DEFAULT_DT = 1.0 / 60.0;
+const int MAX_SHOT_TICKS = 60 * 120;
+
+size_t total_sunk(scene_t *scene) {
+    size_t sunk = 0;
+    for (size_t i = 0; i < list_size(scene_get_players(scene)); i++) {
+        sunk += list_size(player_get_balls_sunk(scene_get_player(scene, i)));
+    }
+    return sunk;
+}
+
+int play_shot(scene_t *scene, double aim, double power, double dt) {
+    if (scene_get_state(scene) == PLACING) {
+        table_place_cue_ball(scene, CUE_BALL_START);
+    }
+    return table_play_shot(scene, aim + M_PI, power, dt, MAX_SHOT_TICKS);
+}
+
+int main(int argc, char **argv) {
+    unsigned int seed = time(0);
+    int shots = DEFAULT_SHOTS;
+    double power = DEFAULT_POWER;
+    double dt = DEFAULT_DT;
+    double aim_degrees = NAN;
+    bool profile = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:n:a:p:t:P")) != -1) {
+        switch (opt) {
+            case 's': seed = strtoul(optarg, NULL, 10); break;
+            case 'n': shots = atoi(optarg); break;
+            case 'a': aim_degrees = atof(optarg); break;
+            case 'p': power = atof(optarg); break;
+            case 't': dt = atof(optarg); break;
+            case 'P': profile = true; break;
+            default:
+                fprintf(stderr, "usage: %s [-s seed] [-n shots] [-a aim_degrees] [-p power] [-t dt] [-P]\n", argv[0]);
+                return 1;
+        }
+    }
+    assert(dt > 0);
+    srand(seed);
+
+    scene_t *scene = scene_init();
+    assert(scene != NULL);
+    populate_scene(scene);
+    scene_set_profiling(scene, profile);
+    printf("seed %u\n", seed);
+    for (int shot = 0; shot < shots; shot++) {
+        int state = scene_get_state(scene);
+        if (state == GAME_OVER_1 || state == GAME_OVER_2 || state == SETTLING) {
+            break;
+        }
+        double aim = isnan(aim_degrees)
+            ? 2 * M_PI * ((double)rand() / RAND_MAX)
+            : aim_degrees * M_PI / 180.0;
+        int turn = scene_get_turn(scene);
+        size_t sunk_before = total_sunk(scene);
+        int ticks = play_shot(scene, aim, power, dt);
+        printf("shot %d: player %d, %d ticks, %zu sunk, state %d\n",
+               shot + 1, turn + 1, ticks, total_sunk(scene) - sunk_before,
+               scene_get_state(scene));
+    }
+    if (profile) {
+        scene_print_profile(scene, stdout);
+    }
+    scene_free(scene);
+    return 0;
+}
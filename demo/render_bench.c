@@ -0,0 +1,146 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "scene.h"
+#include "sdl_wrapper.h"
+#include "table.h"
+#include "timing.h"
+
+// Draws frames of a game offscreen, without a display, and prints how long
+// each part of a frame took on average and at worst.
+// The table is racked, then a break shot is played while frames are drawn.
+// usage: render_bench [-s seed] [-f frames] [-w width] [-h height]
+//                     [-a aim_degrees] [-p power] [-o prefix] [-e extension] [-k every] [-d]
+// With -o, every k-th frame is saved as <prefix><frame number><extension>,
+// where an extension of .png saves PNG images and anything else raw RGBA.
+// With -d, every body's collision shape is drawn instead of the sprites,
+// and only the time for the whole frame is reported.
+
+const int DEFAULT_FRAMES = 600;
+const int DEFAULT_WIDTH = 1000;
+const int DEFAULT_HEIGHT = 500;
+const double DEFAULT_POWER = 2.0;
+const double FRAME_DT = 1.0 / 60.0;
+const vector_t SCENE_MIN = {0, 0};
+const vector_t SCENE_MAX = {1000, 500};
+#define NUM_PHASES 6
+const char *const PHASE_NAMES[NUM_PHASES] = {"clear", "background", "sprites", "text", "present", "total"};
+
+/**
+ * Draws the shapes of the scene's bodies as one frame and reports how long it took,
+ * as render_timings_t with everything but the total left at 0.
+ */
+render_timings_t draw_shapes(scene_t *scene) {
+    struct timespec start = timing_now();
+    sdl_clear();
+    sdl_draw_shapes(scene);
+    sdl_show();
+    render_timings_t timings = {0};
+    timings.total = seconds_since(start);
+    return timings;
+}
+
+void timings_to_array(render_timings_t timings, double *phases) {
+    phases[0] = timings.clear;
+    phases[1] = timings.background;
+    phases[2] = timings.sprites;
+    phases[3] = timings.text;
+    phases[4] = timings.present;
+    phases[5] = timings.total;
+}
+
+int main(int argc, char **argv) {
+    unsigned int seed = time(0);
+    int frames = DEFAULT_FRAMES;
+    int width = DEFAULT_WIDTH, height = DEFAULT_HEIGHT;
+    double aim_degrees = 0;
+    double power = DEFAULT_POWER;
+    const char *prefix = NULL;
+    const char *extension = ".png";
+    int every = 1;
+    bool shapes = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:f:w:h:a:p:o:e:k:d")) != -1) {
+        switch (opt) {
+            case 's': seed = strtoul(optarg, NULL, 10); break;
+            case 'f': frames = atoi(optarg); break;
+            case 'w': width = atoi(optarg); break;
+            case 'h': height = atoi(optarg); break;
+            case 'a': aim_degrees = atof(optarg); break;
+            case 'p': power = atof(optarg); break;
+            case 'o': prefix = optarg; break;
+            case 'e': extension = optarg; break;
+            case 'k': every = atoi(optarg); break;
+            case 'd': shapes = true; break;
+            default:
+                fprintf(stderr, "usage: %s [-s seed] [-f frames] [-w width] [-h height] "
+                                "[-a aim_degrees] [-p power] [-o prefix] [-e extension] [-k every] [-d]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    assert(frames > 0 && every > 0);
+    srand(seed);
+
+    sdl_init_headless(SCENE_MIN, SCENE_MAX, width, height);
+    scene_t *scene = scene_init();
+    populate_scene(scene);
+    table_place_cue_ball(scene, CUE_BALL_START);
+    // brings the cue out
+    update_game_state(scene);
+    table_aim(scene, aim_degrees * M_PI / 180.0 + M_PI);
+    table_shoot(scene, power);
+
+    double sums[NUM_PHASES] = {0}, worst[NUM_PHASES] = {0};
+    int saved = 0;
+    for (int frame = 0; frame < frames; frame++) {
+        scene_tick(scene, FRAME_DT);
+        update_game_state(scene);
+        table_park_sunk_balls(scene);
+        render_timings_t timings;
+        if (shapes) {
+            timings = draw_shapes(scene);
+        }
+        else {
+            sdl_render_scene(scene);
+            timings = sdl_get_render_timings();
+        }
+
+        double phases[NUM_PHASES];
+        timings_to_array(timings, phases);
+        for (int i = 0; i < NUM_PHASES; i++) {
+            sums[i] += phases[i];
+            if (phases[i] > worst[i]) worst[i] = phases[i];
+        }
+        if (prefix != NULL && frame % every == 0) {
+            char path[1024];
+            snprintf(path, sizeof(path), "%s%05d%s", prefix, frame, extension);
+            if (!sdl_save_frame(path)) {
+                fprintf(stderr, "could not save %s\n", path);
+                return 1;
+            }
+            saved++;
+        }
+    }
+
+    printf("seed %u, %d frames at %dx%d", seed, frames, width, height);
+    if (shapes) {
+        printf(", %zu shapes each", scene_bodies(scene));
+    }
+    if (prefix != NULL) {
+        printf(", %d saved", saved);
+    }
+    printf("\n%-12s %10s %10s\n", "phase", "mean us", "worst us");
+    for (int i = 0; i < NUM_PHASES; i++) {
+        printf("%-12s %10.1f %10.1f\n", PHASE_NAMES[i], sums[i] / frames * 1e6, worst[i] * 1e6);
+    }
+    printf("%.1f frames/s\n", frames / sums[NUM_PHASES - 1]);
+
+    scene_free(scene);
+    sdl_free_images();
+    return 0;
+}
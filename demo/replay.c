@@ -0,0 +1,95 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "ai.h"
+#include "controls.h"
+#include "input_log.h"
+#include "scene.h"
+#include "table.h"
+#include "timing.h"
+
+// Plays a game recorded with "pool -r" again, without a window and as fast as possible,
+// then prints how long it took and a checksum of where the balls ended up.
+// Replaying the same recording always gives the same checksum.
+// The computer player's moves are searched for again, the same way pool made them.
+// usage: replay [-i interval] recording
+// With -i, also prints how long each interval of that many ticks took.
+
+void apply_event(scene_t *scene, input_event_t event) {
+    if (event.device == INPUT_KEY) {
+        controls_on_key(event.key, event.type, event.held_time, scene);
+    }
+    else {
+        controls_on_mouse(event.type, scene, event.held_time, event.position);
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t interval = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "i:")) != -1) {
+        switch (opt) {
+            case 'i': interval = strtoul(optarg, NULL, 10); break;
+            default:
+                fprintf(stderr, "usage: %s [-i interval] recording\n", argv[0]);
+                return 1;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "usage: %s [-i interval] recording\n", argv[0]);
+        return 1;
+    }
+    input_log_t *log = input_log_load(argv[optind]);
+    if (log == NULL) {
+        fprintf(stderr, "could not read %s\n", argv[optind]);
+        return 1;
+    }
+    double dt = input_log_get_dt(log);
+    uint32_t ticks = input_log_get_ticks(log);
+    size_t events = input_log_size(log);
+
+    // Set up the table the same way pool does
+    srand(input_log_get_seed(log));
+    scene_t *scene = scene_init();
+    scene_set_state(scene, MENU);
+    populate_scene(scene);
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    ai_t *ai = ai_init(cpus > 0 ? cpus : 1, dt, AI_DEFAULT_SHOTS, 0);
+
+    struct timespec start, interval_start;
+    start = timing_now();
+    interval_start = start;
+    size_t next_event = 0;
+    for (uint32_t tick = 0; tick < ticks; tick++) {
+        // Input is handled between ticks, after the number of ticks it was stamped with
+        while (next_event < events && input_log_get(log, next_event).tick == tick) {
+            apply_event(scene, input_log_get(log, next_event++));
+        }
+        scene_tick(scene, dt);
+        update_game_state(scene);
+        table_park_sunk_balls(scene);
+        ai_take_turn(ai, scene);
+        if (interval > 0 && (tick + 1) % interval == 0) {
+            printf("ticks %u-%u: %.3f ms, state %d\n", tick + 1 - interval, tick,
+                   seconds_since(interval_start) * 1e3, scene_get_state(scene));
+            interval_start = timing_now();
+        }
+    }
+    while (next_event < events) {
+        apply_event(scene, input_log_get(log, next_event++));
+    }
+    double elapsed = seconds_since(start);
+
+    printf("seed %u, %u ticks of %.6f s, %zu events\n",
+           input_log_get_seed(log), ticks, dt, events);
+    printf("%.3f s, %.0f ticks/s, %.1fx real time\n",
+           elapsed, ticks / elapsed, ticks * dt / elapsed);
+    printf("final state %d, ball checksum %.17g\n", scene_get_state(scene), table_ball_checksum(scene));
+
+    ai_free(ai);
+    scene_free(scene);
+    input_log_free(log);
+    return 0;
+}
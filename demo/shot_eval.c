@@ -0,0 +1,99 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "batch.h"
+#include "scene.h"
+#include "table.h"
+#include "timing.h"
+
+// Evaluates one shot on a freshly racked table by playing many randomly
+// perturbed copies of it in parallel, then prints how often each outcome
+// happened and how many shots per second were simulated.
+// usage: shot_eval [-s seed] [-n trials] [-j threads] [-a aim_degrees]
+//                  [-p power] [-e spread_degrees] [-t dt]
+
+const int DEFAULT_TRIALS = 256;
+const int DEFAULT_THREADS = 4;
+const double DEFAULT_POWER = 2.0;
+const double DEFAULT_SPREAD = 1.0;
+const double DEFAULT_DT = 1.0 / 60.0;
+const int MAX_SHOT_TICKS = 60 * 120;
+const double POWER_SPREAD = 0.05;
+
+double random_offset(double spread) {
+    return spread * (2.0 * rand() / RAND_MAX - 1.0);
+}
+
+int main(int argc, char **argv) {
+    unsigned int seed = time(0);
+    int trials = DEFAULT_TRIALS;
+    int threads = DEFAULT_THREADS;
+    double aim_degrees = 0;
+    double power = DEFAULT_POWER;
+    double spread_degrees = DEFAULT_SPREAD;
+    double dt = DEFAULT_DT;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:n:j:a:p:e:t:")) != -1) {
+        switch (opt) {
+            case 's': seed = strtoul(optarg, NULL, 10); break;
+            case 'n': trials = atoi(optarg); break;
+            case 'j': threads = atoi(optarg); break;
+            case 'a': aim_degrees = atof(optarg); break;
+            case 'p': power = atof(optarg); break;
+            case 'e': spread_degrees = atof(optarg); break;
+            case 't': dt = atof(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-s seed] [-n trials] [-j threads] [-a aim_degrees] "
+                                "[-p power] [-e spread_degrees] [-t dt]\n", argv[0]);
+                return 1;
+        }
+    }
+    assert(trials > 0 && threads > 0 && dt > 0);
+    srand(seed);
+
+    scene_t *scene = scene_init();
+    populate_scene(scene);
+    table_state_t *table = malloc(sizeof(table_state_t));
+    assert(table != NULL);
+    table_save(scene, table);
+    scene_free(scene);
+
+    shot_t *shots = malloc(trials * sizeof(shot_t));
+    shot_outcome_t *outcomes = malloc(trials * sizeof(shot_outcome_t));
+    assert(shots != NULL && outcomes != NULL);
+    for (int i = 0; i < trials; i++) {
+        double aim = (aim_degrees + random_offset(spread_degrees)) * M_PI / 180.0;
+        shots[i].angle = aim + M_PI;
+        shots[i].power = power * (1 + random_offset(POWER_SPREAD));
+        shots[i].cue_ball = CUE_BALL_START;
+    }
+
+    batch_t *batch = batch_init(threads);
+    struct timespec start = timing_now();
+    batch_run(batch, table, shots, outcomes, trials, dt, MAX_SHOT_TICKS);
+    double elapsed = seconds_since(start);
+    batch_free(batch);
+
+    int potted = 0, scratches = 0, fouls = 0, unsettled = 0;
+    long ticks = 0;
+    for (int i = 0; i < trials; i++) {
+        potted += outcomes[i].sunk != 0;
+        scratches += outcomes[i].scratch;
+        fouls += outcomes[i].foul;
+        unsettled += outcomes[i].state == SETTLING;
+        ticks += outcomes[i].ticks;
+    }
+    printf("seed %u, %d trials on %d threads\n", seed, trials, threads);
+    printf("potted a ball: %d, scratched: %d, fouled: %d, did not settle: %d\n",
+           potted, scratches, fouls, unsettled);
+    printf("%.1f ticks per shot, %.1f shots/s, %.0f ticks/s\n",
+           (double)ticks / trials, trials / elapsed, ticks / elapsed);
+
+    free(shots);
+    free(outcomes);
+    free(table);
+    return 0;
+}
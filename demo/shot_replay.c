@@ -0,0 +1,77 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "scene.h"
+#include "shot_log.h"
+#include "table.h"
+#include "timing.h"
+
+// Plays a game recorded with "pool -g" again, without a window and as fast as possible,
+// then prints how long it took and a checksum of where the balls ended up.
+// usage: shot_replay [-t tick]... [-o out] shots
+// Each -t seeks to that tick, in the order given, and prints how long the seek took
+// and the checksum there, which is the same however the tick was reached.
+// With -o, the recording is saved again with every table the replay saved along the way.
+
+// The most -t options
+#define MAX_SEEKS 64
+
+int main(int argc, char **argv) {
+    uint32_t seeks[MAX_SEEKS];
+    size_t num_seeks = 0;
+    const char *out_path = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:o:")) != -1) {
+        switch (opt) {
+            case 't':
+                assert(num_seeks < MAX_SEEKS);
+                seeks[num_seeks++] = strtoul(optarg, NULL, 10);
+                break;
+            case 'o': out_path = optarg; break;
+            default:
+                fprintf(stderr, "usage: %s [-t tick]... [-o out] shots\n", argv[0]);
+                return 1;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "usage: %s [-t tick]... [-o out] shots\n", argv[0]);
+        return 1;
+    }
+    shot_log_t *log = shot_log_load(argv[optind]);
+    if (log == NULL) {
+        fprintf(stderr, "could not read %s\n", argv[optind]);
+        return 1;
+    }
+    uint32_t ticks = shot_log_get_ticks(log);
+    double dt = shot_log_get_dt(log);
+    printf("seed %u, %u ticks of %.6f s, %zu shots, %zu saved tables\n",
+           shot_log_get_seed(log), ticks, dt, shot_log_shots(log), shot_log_snapshots(log));
+
+    shot_replay_t *replay = shot_replay_init(log);
+    struct timespec start = timing_now();
+    shot_replay_seek(replay, ticks);
+    double elapsed = seconds_since(start);
+    scene_t *scene = shot_replay_get_scene(replay);
+    printf("%.3f s, %.0f ticks/s, %.1fx real time\n",
+           elapsed, ticks / elapsed, ticks * dt / elapsed);
+    printf("final state %d, ball checksum %.17g\n", scene_get_state(scene), table_ball_checksum(scene));
+
+    for (size_t i = 0; i < num_seeks; i++) {
+        start = timing_now();
+        shot_replay_seek(replay, seeks[i]);
+        elapsed = seconds_since(start);
+        scene = shot_replay_get_scene(replay);
+        printf("tick %u: %.3f ms, state %d, ball checksum %.17g\n",
+               seeks[i], elapsed * 1e3, scene_get_state(scene), table_ball_checksum(scene));
+    }
+
+    shot_replay_free(replay);
+    if (out_path != NULL && !shot_log_save(log, out_path)) {
+        fprintf(stderr, "could not save %s\n", out_path);
+        shot_log_free(log);
+        return 1;
+    }
+    shot_log_free(log);
+    return 0;
+}
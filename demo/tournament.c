@@ -0,0 +1,350 @@
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "ai.h"
+#include "ball.h"
+#include "player.h"
+#include "rng.h"
+#include "scene.h"
+#include "table.h"
+#include "thread_pool.h"
+#include "timing.h"
+
+// Plays many complete games without a window, in parallel, between two shot policies,
+// and prints aggregate statistics as CSV: how the break went, how long games took,
+// how often shots fouled and how many ticks each shot took.
+// The policies swap seats every game, so each breaks in half of them.
+// Every game is racked from its own seed, so the results do not depend on the number of threads.
+// usage: tournament [-s seed] [-n games] [-j threads] [-a policy] [-b policy]
+//                   [-c candidates] [-m max_shots] [-t dt] [-o games.csv]
+// The policies are "random", the default, and "ai"; -c is how many shots "ai" screens per move.
+// With -o, also writes one row per game.
+
+const int DEFAULT_GAMES = 1000;
+const int DEFAULT_THREADS = 4;
+const size_t DEFAULT_CANDIDATES = 64;
+const int DEFAULT_MAX_SHOTS = 200;
+const double DEFAULT_DT = 1.0 / 120.0;
+const double MAX_SHOT_SECONDS = 120;
+// The powers the random policy shoots at, see table_shoot()
+const double RANDOM_MIN_POWER = 0.5;
+const double RANDOM_MAX_POWER = 2.0;
+// How many spots the random policy tries before putting the cue ball down anyway
+const int RANDOM_PLACEMENT_TRIES = 16;
+
+/**
+ * A way of choosing shots. Each worker thread has its own state for each seat,
+ * made with init and freed with free.
+ */
+typedef struct policy {
+    const char *name;
+    void *(*init)(size_t candidates, double dt);
+    /**
+     * Chooses a shot for the player whose turn it is.
+     * rng is the game's own random number state, so the game does not depend
+     * on which worker plays it.
+     */
+    shot_t (*choose)(void *state, scene_t *scene, uint64_t *rng);
+    void (*free)(void *state);
+} policy_t;
+
+void *random_policy_init(size_t candidates, double dt) {
+    return NULL;
+}
+
+/**
+ * Returns whether the cue ball can be put down at a spot without touching another ball.
+ */
+bool spot_clear(scene_t *scene, vector_t spot, double radius) {
+    list_t *balls = scene_get_balls(scene);
+    for (size_t i = 1; i < list_size(balls); i++) {
+        vector_t ball = body_get_centroid(ball_get_body(list_get(balls, i)));
+        if (vec_magnitude(vec_subtract(ball, spot)) < 2 * radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+shot_t random_policy_choose(void *state, scene_t *scene, uint64_t *rng) {
+    shot_t shot = {
+        .angle = rng_between(rng, 0, 2 * M_PI),
+        .power = rng_between(rng, RANDOM_MIN_POWER, RANDOM_MAX_POWER)
+    };
+    double radius = ball_get_radius(list_get(scene_get_balls(scene), 0));
+    vector_t min = vec_add(KITCHEN[0], (vector_t){radius + 1, radius + 1});
+    vector_t max = vec_subtract(KITCHEN[1], (vector_t){1, radius + 1});
+    for (int i = 0; i < RANDOM_PLACEMENT_TRIES; i++) {
+        shot.cue_ball = (vector_t) {rng_between(rng, min.x, max.x), rng_between(rng, min.y, max.y)};
+        if (spot_clear(scene, shot.cue_ball, radius)) {
+            break;
+        }
+    }
+    return shot;
+}
+
+void random_policy_free(void *state) {
+}
+
+void *ai_policy_init(size_t candidates, double dt) {
+    // The games already run in parallel, so each search gets one thread.
+    // With no time limit the search only depends on the table.
+    return ai_init(1, dt, candidates, 0);
+}
+
+shot_t ai_policy_choose(void *state, scene_t *scene, uint64_t *rng) {
+    return ai_choose_shot(state, scene);
+}
+
+void ai_policy_free(void *state) {
+    ai_free(state);
+}
+
+const policy_t POLICIES[] = {
+    {"random", random_policy_init, random_policy_choose, random_policy_free},
+    {"ai", ai_policy_init, ai_policy_choose, ai_policy_free}
+};
+const size_t NUM_POLICIES = sizeof(POLICIES) / sizeof(POLICIES[0]);
+
+/**
+ * How one game went. Policy 0 is the one given with -a, policy 1 the one given with -b.
+ */
+typedef struct game_stats {
+    /** Which policy broke */
+    int breaker;
+    /** Which policy won, or -1 if the game did not finish */
+    int winner;
+    int shots;
+    long ticks;
+    int break_potted;
+    bool break_scratch;
+    bool break_kept_turn;
+    /** Shots after which the other player had the cue ball in hand */
+    int scratches;
+    /** Shots that sunk one of the other player's balls */
+    int fouls;
+    double seconds;
+} game_stats_t;
+
+typedef struct tournament {
+    unsigned int seed;
+    double dt;
+    int max_shots;
+    int max_shot_ticks;
+    const policy_t *policies[2];
+    /** Each worker's state for policy 0 and policy 1 */
+    void **states;
+    game_stats_t *games;
+} tournament_t;
+
+/**
+ * populate_scene() shuffles the rack with rand(), so racking is done one game at a time.
+ */
+pthread_mutex_t rack_lock = PTHREAD_MUTEX_INITIALIZER;
+
+size_t sunk_by(scene_t *scene, int player) {
+    return list_size(player_get_balls_sunk(scene_get_player(scene, player)));
+}
+
+void play_game(void *aux, size_t index, size_t worker) {
+    tournament_t *tournament = aux;
+    game_stats_t *stats = &tournament->games[index];
+    struct timespec start = timing_now();
+
+    pthread_mutex_lock(&rack_lock);
+    srand(tournament->seed + index);
+    scene_t *scene = scene_init();
+    scene_set_state(scene, MENU);
+    populate_scene(scene);
+    pthread_mutex_unlock(&rack_lock);
+    // Leave the menu the way its buttons do, with both seats played by policies
+    for (int p = 0; p < TABLE_PLAYERS; p++) {
+        player_set_computer(scene_get_player(scene, p), true);
+    }
+    scene_set_state(scene, PLACING);
+
+    // The policies swap seats every game; seat 0 breaks
+    int seat_policy[TABLE_PLAYERS] = {index % 2, 1 - index % 2};
+    uint64_t rng = rng_seed(0x9e3779b97f4a7c15ULL ^ ((uint64_t)tournament->seed << 32 | index));
+    memset(stats, 0, sizeof(*stats));
+    stats->breaker = seat_policy[0];
+    stats->winner = -1;
+
+    while (stats->shots < tournament->max_shots) {
+        int state = scene_get_state(scene);
+        if (state != PLACING && state != FIRING) {
+            break;
+        }
+        int shooter = scene_get_turn(scene);
+        int policy = seat_policy[shooter];
+        size_t own_before = sunk_by(scene, shooter);
+        size_t other_before = sunk_by(scene, 1 - shooter);
+        void *policy_state = tournament->states[2 * worker + policy];
+        shot_t shot = tournament->policies[policy]->choose(policy_state, scene, &rng);
+        ai_play_shot(scene, shot);
+
+        int ticks = 0;
+        while (scene_get_state(scene) == SETTLING && ticks < tournament->max_shot_ticks) {
+            scene_tick(scene, tournament->dt);
+            update_game_state(scene);
+            table_park_sunk_balls(scene);
+            ticks++;
+        }
+        stats->ticks += ticks;
+        stats->shots++;
+        state = scene_get_state(scene);
+        bool scratch = state == PLACING;
+        stats->scratches += scratch;
+        stats->fouls += sunk_by(scene, 1 - shooter) > other_before;
+        if (stats->shots == 1) {
+            stats->break_potted = sunk_by(scene, shooter) - own_before
+                                  + sunk_by(scene, 1 - shooter) - other_before;
+            stats->break_scratch = scratch;
+            stats->break_kept_turn = state == FIRING && scene_get_turn(scene) == shooter;
+        }
+    }
+    int state = scene_get_state(scene);
+    if (state == GAME_OVER_1) {
+        stats->winner = seat_policy[0];
+    }
+    else if (state == GAME_OVER_2) {
+        stats->winner = seat_policy[1];
+    }
+    scene_free(scene);
+    stats->seconds = seconds_since(start);
+}
+
+const policy_t *find_policy(const char *name) {
+    for (size_t i = 0; i < NUM_POLICIES; i++) {
+        if (strcmp(POLICIES[i].name, name) == 0) {
+            return &POLICIES[i];
+        }
+    }
+    return NULL;
+}
+
+bool write_games(const char *path, tournament_t *tournament, int games) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        return false;
+    }
+    fprintf(file, "game,seed,breaker,winner,shots,ticks,break_potted,break_scratch,"
+                  "break_kept_turn,scratches,fouls,seconds\n");
+    for (int i = 0; i < games; i++) {
+        game_stats_t *game = &tournament->games[i];
+        fprintf(file, "%d,%u,%s,%s,%d,%ld,%d,%d,%d,%d,%d,%.6f\n",
+                i, tournament->seed + i,
+                tournament->policies[game->breaker]->name,
+                game->winner < 0 ? "none" : tournament->policies[game->winner]->name,
+                game->shots, game->ticks, game->break_potted, game->break_scratch,
+                game->break_kept_turn, game->scratches, game->fouls, game->seconds);
+    }
+    return fclose(file) == 0;
+}
+
+int main(int argc, char **argv) {
+    unsigned int seed = time(0);
+    int games = DEFAULT_GAMES;
+    int threads = DEFAULT_THREADS;
+    const char *names[2] = {"random", "random"};
+    size_t candidates = DEFAULT_CANDIDATES;
+    int max_shots = DEFAULT_MAX_SHOTS;
+    double dt = DEFAULT_DT;
+    const char *games_path = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:n:j:a:b:c:m:t:o:")) != -1) {
+        switch (opt) {
+            case 's': seed = strtoul(optarg, NULL, 10); break;
+            case 'n': games = atoi(optarg); break;
+            case 'j': threads = atoi(optarg); break;
+            case 'a': names[0] = optarg; break;
+            case 'b': names[1] = optarg; break;
+            case 'c': candidates = strtoul(optarg, NULL, 10); break;
+            case 'm': max_shots = atoi(optarg); break;
+            case 't': dt = atof(optarg); break;
+            case 'o': games_path = optarg; break;
+            default:
+                fprintf(stderr, "usage: %s [-s seed] [-n games] [-j threads] [-a policy] [-b policy] "
+                                "[-c candidates] [-m max_shots] [-t dt] [-o games.csv]\n", argv[0]);
+                return 1;
+        }
+    }
+    assert(games > 0 && threads > 0 && candidates > 0 && max_shots > 0 && dt > 0);
+    tournament_t tournament = {
+        .seed = seed, .dt = dt, .max_shots = max_shots,
+        .max_shot_ticks = MAX_SHOT_SECONDS / dt
+    };
+    for (int p = 0; p < 2; p++) {
+        tournament.policies[p] = find_policy(names[p]);
+        if (tournament.policies[p] == NULL) {
+            fprintf(stderr, "unknown policy %s\n", names[p]);
+            return 1;
+        }
+    }
+
+    tournament.states = malloc(2 * threads * sizeof(void *));
+    tournament.games = malloc(games * sizeof(game_stats_t));
+    assert(tournament.states != NULL && tournament.games != NULL);
+    for (int i = 0; i < 2 * threads; i++) {
+        tournament.states[i] = tournament.policies[i % 2]->init(candidates, dt);
+    }
+    thread_pool_t *pool = thread_pool_init(threads);
+    struct timespec start = timing_now();
+    thread_pool_run(pool, play_game, &tournament, games);
+    double elapsed = seconds_since(start);
+    thread_pool_free(pool);
+    for (int i = 0; i < 2 * threads; i++) {
+        tournament.policies[i % 2]->free(tournament.states[i]);
+    }
+
+    int finished = 0, wins[2] = {0, 0}, breaker_wins = 0;
+    long shots = 0, ticks = 0, break_potted = 0, break_scratches = 0, break_kept = 0;
+    long scratches = 0, fouls = 0, finished_shots = 0;
+    for (int i = 0; i < games; i++) {
+        game_stats_t *game = &tournament.games[i];
+        if (game->winner >= 0) {
+            finished++;
+            finished_shots += game->shots;
+            wins[game->winner]++;
+            breaker_wins += game->winner == game->breaker;
+        }
+        shots += game->shots;
+        ticks += game->ticks;
+        break_potted += game->break_potted;
+        break_scratches += game->break_scratch;
+        break_kept += game->break_kept_turn;
+        scratches += game->scratches;
+        fouls += game->fouls;
+    }
+    printf("policy_a,policy_b,seed,games,threads,finished,wins_a,wins_b,breaker_wins,"
+           "shots_per_game,shots_per_finished_game,break_potted,break_scratch_rate,"
+           "break_kept_turn_rate,scratch_rate,foul_rate,ticks_per_shot,"
+           "seconds,games_per_second,ticks_per_second\n");
+    printf("%s,%s,%u,%d,%d,%d,%d,%d,%d,%.2f,%.2f,%.3f,%.4f,%.4f,%.4f,%.4f,%.1f,%.3f,%.2f,%.0f\n",
+           names[0], names[1], seed, games, threads, finished, wins[0], wins[1], breaker_wins,
+           (double)shots / games,
+           finished > 0 ? (double)finished_shots / finished : 0,
+           (double)break_potted / games,
+           (double)break_scratches / games,
+           (double)break_kept / games,
+           shots > 0 ? (double)scratches / shots : 0,
+           shots > 0 ? (double)fouls / shots : 0,
+           shots > 0 ? (double)ticks / shots : 0,
+           elapsed, games / elapsed, ticks / elapsed);
+
+    if (games_path != NULL && !write_games(games_path, &tournament, games)) {
+        fprintf(stderr, "could not write %s\n", games_path);
+        free(tournament.states);
+        free(tournament.games);
+        return 1;
+    }
+    free(tournament.states);
+    free(tournament.games);
+    return 0;
+}
@@ -0,0 +1,136 @@
+#ifndef __AI_H__
+#define __AI_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "batch.h"
+#include "scene.h"
+
+/**
+ * A computer opponent that searches for its next shot by playing candidate shots
+ * on copies of the table with a batch, using the same scene_tick() physics as the game,
+ * and scoring what happens by the game's rules for pots, fouls and the 8 ball.
+ *
+ * Every candidate is first screened by simulating only the start of the shot.
+ * The best few are then played out in full, and the best of those is chosen,
+ * so the chosen shot does exactly what the search saw, as long as the game
+ * is ticked with the same dt as the search.
+ */
+typedef struct ai ai_t;
+
+/**
+ * How many candidate shots are screened per move by default.
+ */
+extern const size_t AI_DEFAULT_SHOTS;
+
+/**
+ * How long a move may take by default, in seconds.
+ */
+extern const double AI_DEFAULT_SECONDS;
+
+/**
+ * What the last search did.
+ */
+typedef struct {
+    /** The number of candidate shots screened */
+    size_t screened;
+    /** The number of candidates played out in full */
+    size_t finalists;
+    /** How long the search took, in seconds */
+    double seconds;
+    /** The score of the chosen shot; positive if it keeps the turn */
+    double score;
+} ai_stats_t;
+
+/**
+ * What the shooter is playing for, worked out once per search.
+ */
+typedef struct turn {
+    /** The player taking the shot, 0 or 1 */
+    int shooter;
+    /** The shooter's balls, as a bitmask of ball numbers like shot_outcome_t's sunk */
+    uint16_t own;
+    /** How many balls the shooter had sunk before the shot */
+    int own_before;
+} turn_t;
+
+/**
+ * Scores what a shot did for the shooter, by the rules update_game_state() plays by.
+ * A screened shot may not have finished, so its outcome is judged from what was sunk so far.
+ * Winning scores highest and losing lowest; a shot that keeps the turn scores above 0.
+ *
+ * @param outcome what the shot did, from batch_run()
+ * @param turn who shot and which balls are theirs
+ * @return the score, higher for better shots
+ */
+double score_outcome(const shot_outcome_t *outcome, const turn_t *turn);
+
+/**
+ * Allocates a computer opponent.
+ * With no time limit, the search only depends on the table,
+ * so replaying a game makes the same moves whatever the number of threads.
+ *
+ * @param threads the number of threads to simulate shots on, at least 1
+ * @param dt the length of each tick the game is played with, in seconds
+ * @param max_shots the most candidate shots to screen per move
+ * @param seconds how long a move may take, or 0 for no limit;
+ *   at least one round of candidates is always screened
+ * @return the new opponent
+ */
+ai_t *ai_init(size_t threads, double dt, size_t max_shots, double seconds);
+
+/**
+ * Stops the opponent's threads and frees it.
+ *
+ * @param ai a pointer to an opponent returned from ai_init()
+ */
+void ai_free(ai_t *ai);
+
+/**
+ * Returns whether it is a computer player's turn (see player_set_computer())
+ * and the table is waiting for it to place the cue ball or shoot.
+ *
+ * @param scene a scene set up with populate_scene()
+ */
+bool ai_has_turn(scene_t *scene);
+
+/**
+ * Searches for the best shot for the player whose turn it is.
+ * Only reads the scene, so it may run without any lock
+ * as long as nothing changes the scene meanwhile.
+ *
+ * @param ai a pointer to an opponent returned from ai_init()
+ * @param scene a scene where ai_has_turn() is true
+ * @return the chosen shot
+ */
+shot_t ai_choose_shot(ai_t *ai, scene_t *scene);
+
+/**
+ * Takes a shot the same way the search played it:
+ * places the cue ball if the table is PLACING, brings out the cue, aims and shoots.
+ * The balls then move as the scene is ticked.
+ *
+ * @param scene a scene where ai_has_turn() is true
+ * @param shot the shot to take, e.g. from ai_choose_shot()
+ */
+void ai_play_shot(scene_t *scene, shot_t shot);
+
+/**
+ * Chooses and takes a shot if it is a computer player's turn.
+ * Should be called after each tick, once update_game_state() has run.
+ *
+ * @param ai a pointer to an opponent returned from ai_init()
+ * @param scene a scene set up with populate_scene()
+ * @return whether a shot was taken
+ */
+bool ai_take_turn(ai_t *ai, scene_t *scene);
+
+/**
+ * Gets what the last call to ai_choose_shot() did.
+ *
+ * @param ai a pointer to an opponent returned from ai_init()
+ */
+ai_stats_t ai_get_stats(ai_t *ai);
+
+#endif // #ifndef __AI_H__
@@ -0,0 +1,105 @@
+#ifndef __ASSET_PACK_H__
+#define __ASSET_PACK_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A single file holding every image already decoded to RGBA pixels,
+ * plus the font's glyphs already rendered, so that nothing needs decoding at startup.
+ * The file is memory-mapped when it is opened,
+ * so looking up an asset gives a pointer straight into the file.
+ * Written by asset_packer; the layout depends on the machine's byte order,
+ * so a pack should be built on the machine it is used on.
+ */
+typedef struct asset_pack asset_pack_t;
+
+/**
+ * Collects assets in memory and writes them out as a pack.
+ */
+typedef struct asset_pack_writer asset_pack_writer_t;
+
+/**
+ * What an asset's data holds.
+ */
+typedef enum {
+    /** Pixels, 4 bytes each in R, G, B, A order, one row after another from the top */
+    ASSET_IMAGE,
+    /** An image of every glyph of a font, laid out as described by an ASSET_GLYPH_METRICS */
+    ASSET_GLYPH_ATLAS,
+    /** For each glyph, its x, y, width and height in the atlas and its advance, as int32_ts */
+    ASSET_GLYPH_METRICS
+} asset_kind_t;
+
+/**
+ * The longest name an asset can have, including the terminating '\0'.
+ */
+#define ASSET_NAME_LENGTH 64
+
+/**
+ * Maps a pack into memory and checks its index.
+ *
+ * @param path the pack file
+ * @return the pack, or NULL if the file does not exist or is not a valid pack
+ */
+asset_pack_t *asset_pack_open(const char *path);
+
+/**
+ * Unmaps a pack. Pointers returned from asset_pack_find() are no longer valid afterwards.
+ *
+ * @param pack a pointer to a pack returned from asset_pack_open()
+ */
+void asset_pack_close(asset_pack_t *pack);
+
+/**
+ * Looks up an asset in a pack.
+ *
+ * @param pack a pointer to a pack returned from asset_pack_open()
+ * @param name the name the asset was added with
+ * @param kind what the asset must hold
+ * @param width set to the width of an image or atlas, may be NULL
+ * @param height set to the height of an image or atlas, may be NULL
+ * @param size set to the number of bytes of data, may be NULL
+ * @return a pointer to the asset's data inside the mapped file,
+ *   aligned to 16 bytes, or NULL if there is no such asset
+ */
+const void *asset_pack_find(asset_pack_t *pack, const char *name, asset_kind_t kind,
+                            int *width, int *height, size_t *size);
+
+/**
+ * Allocates a writer with no assets.
+ */
+asset_pack_writer_t *asset_pack_writer_init(void);
+
+/**
+ * Releases the memory allocated for a writer.
+ *
+ * @param writer a pointer to a writer returned from asset_pack_writer_init()
+ */
+void asset_pack_writer_free(asset_pack_writer_t *writer);
+
+/**
+ * Adds an asset to a writer. The data is copied.
+ *
+ * @param writer a pointer to a writer returned from asset_pack_writer_init()
+ * @param name the name to look the asset up by, shorter than ASSET_NAME_LENGTH
+ * @param kind what the data holds
+ * @param width the width of an image or atlas, otherwise 0
+ * @param height the height of an image or atlas, otherwise 0
+ * @param data the bytes of the asset
+ * @param size the number of bytes
+ */
+void asset_pack_writer_add(asset_pack_writer_t *writer, const char *name, asset_kind_t kind,
+                           int width, int height, const void *data, size_t size);
+
+/**
+ * Writes every asset added to a writer to a pack file.
+ *
+ * @param writer a pointer to a writer returned from asset_pack_writer_init()
+ * @param path the file to write
+ * @return whether the whole pack was written
+ */
+bool asset_pack_writer_save(asset_pack_writer_t *writer, const char *path);
+
+#endif // #ifndef __ASSET_PACK_H__
@@ -0,0 +1,89 @@
+#ifndef __BATCH_H__
+#define __BATCH_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "table.h"
+#include "vector.h"
+
+/**
+ * Plays many shots from the same table in parallel, e.g. to evaluate
+ * randomly perturbed versions of a shot.
+ * Each worker thread keeps its own copy of the table,
+ * which is reset with table_load() before every shot,
+ * so no scene is built or freed while the batch runs.
+ */
+typedef struct batch batch_t;
+
+/**
+ * A shot to play on a copy of the table.
+ */
+typedef struct {
+    /** The angle of the cue, see table_aim() */
+    double angle;
+    /** The power of the shot, see table_shoot() */
+    double power;
+    /** Where to put the cue ball first if the table is PLACING */
+    vector_t cue_ball;
+} shot_t;
+
+/**
+ * What happened when a shot was played.
+ */
+typedef struct {
+    /** Bit n is set if ball n was sunk by this shot */
+    uint16_t sunk;
+    /** Whether the cue ball was sunk, even if the balls had not stopped by max_ticks */
+    bool scratch;
+    /** Whether the shooter sunk one of the other player's balls */
+    bool foul;
+    /** The game state once the balls stopped, e.g. GAME_OVER_1 */
+    int8_t state;
+    /** Whose turn it is after the shot */
+    int8_t turn;
+    /** How many ticks the balls took to stop */
+    int32_t ticks;
+    /** Where each ball ended up */
+    vector_t positions[TABLE_BALLS];
+} shot_outcome_t;
+
+/**
+ * Allocates a batch with one worker thread and table per thread.
+ *
+ * @param threads the number of threads to run shots on, at least 1
+ * @return the new batch
+ */
+batch_t *batch_init(size_t threads);
+
+/**
+ * Plays each shot on its own copy of a table and waits for all of them.
+ * A shot gives up after max_ticks if the balls are still moving.
+ * Safe to call repeatedly with different tables and shots.
+ *
+ * @param batch a pointer to a batch returned from batch_init()
+ * @param table the table every shot starts from, in the PLACING or FIRING state
+ * @param shots the shots to play
+ * @param outcomes where to write the outcome of each shot, in the same order
+ * @param count the number of shots
+ * @param dt the length of each tick, in seconds
+ * @param max_ticks the most ticks to simulate for one shot
+ */
+void batch_run(
+    batch_t *batch,
+    const table_state_t *table,
+    const shot_t *shots,
+    shot_outcome_t *outcomes,
+    size_t count,
+    double dt,
+    int max_ticks
+);
+
+/**
+ * Stops the worker threads and frees the batch and its tables.
+ *
+ * @param batch a pointer to a batch returned from batch_init()
+ */
+void batch_free(batch_t *batch);
+
+#endif // #ifndef __BATCH_H__
@@ -0,0 +1,73 @@
+#ifndef __BINARY_IO_H__
+#define __BINARY_IO_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Reads and writes the numbers in the game's recording formats.
+ * Everything is little-endian, whatever the machine.
+ * The readers return false at the end of the file.
+ */
+
+/**
+ * Writes the low bytes of an unsigned integer.
+ *
+ * @param file the file to write to
+ * @param value the integer
+ * @param bytes how many bytes to write, at most 8
+ */
+void write_uint(FILE *file, uint64_t value, int bytes);
+
+/**
+ * Reads an unsigned integer written by write_uint().
+ *
+ * @param file the file to read from
+ * @param value where to store the integer
+ * @param bytes how many bytes were written
+ * @return whether all the bytes were read
+ */
+bool read_uint(FILE *file, uint64_t *value, int bytes);
+
+/**
+ * Writes a double exactly, as its 8 bytes.
+ */
+void write_double(FILE *file, double value);
+
+/**
+ * Reads a double written by write_double().
+ *
+ * @return whether all 8 bytes were read
+ */
+bool read_double(FILE *file, double *value);
+
+/**
+ * Writes an unsigned integer as a varint, 7 bits per byte,
+ * so small values take a single byte.
+ */
+void write_varint(FILE *file, uint32_t value);
+
+/**
+ * Reads a varint written by write_varint().
+ *
+ * @return whether a whole varint was read
+ */
+bool read_varint(FILE *file, uint32_t *value);
+
+/**
+ * Writes a double exactly, in as few bytes as it takes.
+ * A whole number of thousandths, such as a time in milliseconds or a position
+ * in whole pixels, is written as a varint of a few bytes.
+ * Anything else takes a zero byte and then its 8 bytes.
+ */
+void write_compact_double(FILE *file, double value);
+
+/**
+ * Reads a double written by write_compact_double().
+ *
+ * @return whether the whole double was read
+ */
+bool read_compact_double(FILE *file, double *value);
+
+#endif // #ifndef __BINARY_IO_H__
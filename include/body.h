@@ -3,7 +3,9 @@
 
 #include <stdbool.h>
 #include "color.h"
+#include "integrator.h"
 #include "list.h"
+#include "render_component.h"
 #include "vector.h"
 
 /**
@@ -57,6 +59,17 @@ void body_free(body_t *body);
  */
 list_t *body_get_shape(body_t *body);
 
+/**
+ * Gets the current shape of a body without copying it.
+ * The list still belongs to the body, so it must not be modified or freed,
+ * and it changes whenever the body moves.
+ * Useful for read-only checks that run many times per tick.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the polygon describing the body's current position
+ */
+list_t *body_borrow_shape(body_t *body);
+
 /**
  * Gets the current center of mass of a body.
  * While this could be calculated with polygon_centroid(), that becomes too slow
@@ -76,6 +89,17 @@ vector_t body_get_centroid(body_t *body);
  */
 vector_t body_get_velocity(body_t *body);
 
+/**
+ * Gets the distance from a body's center of mass to its farthest vertex.
+ * Bodies only move rigidly, so this is computed once in body_init().
+ * No part of the body lies outside this distance from its centroid,
+ * which makes it a cheap first check for whether two bodies can collide.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the radius of the body's bounding circle
+ */
+double body_get_radius(body_t *body);
+
 void body_set_angle(body_t *body, double angle);
 
 double body_get_angle(body_t *body);
@@ -104,6 +128,23 @@ rgb_color_t body_get_color(body_t *body);
  */
 void *body_get_info(body_t *body);
 
+/**
+ * Gets how a body is drawn.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the component last passed to body_set_render(),
+ *   or one with DRAW_NONE if it was never called
+ */
+render_component_t body_get_render(body_t *body);
+
+/**
+ * Sets how a body is drawn.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param render the sprite, draw kind and layer to draw the body with
+ */
+void body_set_render(body_t *body, render_component_t render);
+
 void body_translate(body_t *body, vector_t x);
 
 /**
@@ -178,6 +219,59 @@ void body_reset_impulse(body_t *body);
  */
 void body_tick(body_t *body, double dt);
 
+/**
+ * Updates the body after a given time interval has elapsed, like body_tick(),
+ * but with a given integrator.
+ * Only integrators that need the forces once per tick can be used here;
+ * scene_tick() handles the others.
+ *
+ * @param body the body to tick
+ * @param dt the number of seconds elapsed since the last tick
+ * @param integrator INTEGRATOR_TRAPEZOID or INTEGRATOR_SEMI_IMPLICIT_EULER
+ */
+void body_step(body_t *body, double dt, integrator_t integrator);
+
+/**
+ * Gets the integrator a body uses instead of its scene's.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's integrator, INTEGRATOR_SCENE unless it was changed
+ */
+integrator_t body_get_integrator(body_t *body);
+
+/**
+ * Makes a body use a different integrator from the rest of its scene.
+ * Use INTEGRATOR_SCENE to go back to the scene's integrator.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param integrator the integrator to use
+ */
+void body_set_integrator(body_t *body, integrator_t integrator);
+
+/**
+ * Gets the total force applied to a body so far this tick.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the sum of the forces passed to body_add_force()
+ */
+vector_t body_get_force(body_t *body);
+
+/**
+ * Gets the total impulse applied to a body so far this tick.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the sum of the impulses passed to body_add_impulse()
+ */
+vector_t body_get_impulse(body_t *body);
+
+/**
+ * Sets the force and impulse on a body to 0
+ * without changing its position or velocity.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_clear_forces(body_t *body);
+
 /**
  * Marks a body for removal--future calls to body_is_removed() will return true.
  * Does not free the body.
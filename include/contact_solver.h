@@ -0,0 +1,106 @@
+#ifndef __CONTACT_SOLVER_H__
+#define __CONTACT_SOLVER_H__
+
+#include <stddef.h>
+#include "body.h"
+
+/**
+ * Resolves contacts between pairs of bodies all together, once per tick.
+ * Unlike create_physics_collision(), which handles each pair on its own
+ * once when it first touches, the solver gathers every pair in contact
+ * and applies sequential impulses to them over several iterations,
+ * so impulses travel through a cluster of touching bodies (like a rack
+ * of balls) in a single tick.
+ * Each pair's impulse is remembered and applied first on the next tick
+ * (warm starting), so resting contacts settle quickly,
+ * and overlapping bodies are pushed apart with Baumgarte stabilization.
+ *
+ * Bodies are treated as circles with their bounding radius
+ * (see body_get_radius()), which is exact for balls.
+ * Bodies with infinite mass or a mass of DBL_MAX do not move.
+ *
+ * Give a solver to a scene with scene_set_contact_solver();
+ * scene_tick() then runs it after the force creators.
+ */
+typedef struct contact_solver contact_solver_t;
+
+/**
+ * Allocates memory for a solver with no pairs.
+ *
+ * @param iterations how many times to go over the contacts each tick;
+ *   more iterations spread impulses further through touching bodies
+ * @param baumgarte the fraction of the overlap to remove each tick,
+ *   between 0 and 1; around 0.2 is typical
+ * @param slop how far bodies can overlap before they are pushed apart,
+ *   so resting contacts do not jitter
+ * @return the new solver
+ */
+contact_solver_t *contact_solver_init(size_t iterations, double baumgarte, double slop);
+
+/**
+ * Releases the memory allocated for a solver.
+ * Does not free the bodies.
+ *
+ * @param solver a pointer to a solver returned from contact_solver_init()
+ */
+void contact_solver_free(contact_solver_t *solver);
+
+/**
+ * Makes a solver handle contacts between two bodies.
+ *
+ * @param solver a pointer to a solver returned from contact_solver_init()
+ * @param elasticity how elastic the contact is, as in create_physics_collision()
+ * @param body1 the first body
+ * @param body2 the second body
+ */
+void contact_solver_add_pair(contact_solver_t *solver, double elasticity, body_t *body1, body_t *body2);
+
+/**
+ * Returns the number of pairs in a solver.
+ *
+ * @param solver a pointer to a solver returned from contact_solver_init()
+ * @return the number of pairs added and not removed
+ */
+size_t contact_solver_pairs(contact_solver_t *solver);
+
+/**
+ * Applies impulses to every pair of bodies in contact so they stop
+ * approaching each other, given the forces and impulses already
+ * applied this tick. Called by scene_tick() after the force creators.
+ *
+ * @param solver a pointer to a solver returned from contact_solver_init()
+ * @param dt the length of the tick, in seconds
+ */
+void contact_solver_solve(contact_solver_t *solver, double dt);
+
+/**
+ * Drops every pair with a body marked for removal.
+ * Called by scene_tick() before the bodies are freed.
+ *
+ * @param solver a pointer to a solver returned from contact_solver_init()
+ */
+void contact_solver_remove_marked(contact_solver_t *solver);
+
+/**
+ * Copies the impulse each pair ended the last tick with,
+ * which is applied first on the next tick, in the order the pairs were added.
+ * Together with the bodies' positions and velocities,
+ * this is what is needed to resume a solver exactly.
+ *
+ * @param solver a pointer to a solver returned from contact_solver_init()
+ * @param impulses the array to write into
+ * @param max the length of impulses; at most this many are written
+ * @return the number of pairs
+ */
+size_t contact_solver_get_impulses(contact_solver_t *solver, double *impulses, size_t max);
+
+/**
+ * Restores impulses saved with contact_solver_get_impulses().
+ *
+ * @param solver a solver with the same pairs as the one the impulses came from
+ * @param impulses the impulses to restore
+ * @param count the number of impulses; at most this many are restored
+ */
+void contact_solver_set_impulses(contact_solver_t *solver, const double *impulses, size_t count);
+
+#endif // #ifndef __CONTACT_SOLVER_H__
@@ -0,0 +1,44 @@
+#ifndef __CONTROLS_H__
+#define __CONTROLS_H__
+
+#include "scene.h"
+#include "input.h"
+#include "vector.h"
+
+/**
+ * How the mouse and keyboard play the game:
+ * clicking a menu button starts a game, the mouse places the cue ball and aims,
+ * and holding then releasing space winds up and takes the shot.
+ * The first menu button plays against the computer, whose turns ignore the mouse and keyboard.
+ * These do not call SDL, so recorded input can be replayed without a window.
+ */
+
+/**
+ * Handles a mouse event. Matches mouse_handler_t, so it can be passed to sdl_on_mouse().
+ *
+ * @param type the type of mouse event
+ * @param scene a scene set up with populate_scene()
+ * @param held_time if a button event, the time the button has been held in seconds
+ * @param position where the mouse was, in window pixels
+ */
+void controls_on_mouse(mouse_event_type_t type, scene_t *scene, double held_time, vector_t position);
+
+/**
+ * Handles a key event. Matches key_handler_t, so it can be passed to sdl_on_key().
+ *
+ * @param key the key, see key_handler_t
+ * @param type the type of key event
+ * @param held_time if a press event, the time the key has been held in seconds
+ * @param scene a scene set up with populate_scene()
+ */
+void controls_on_key(char key, key_event_type_t type, double held_time, scene_t *scene);
+
+/**
+ * Gets how far the cue is pulled back for the shot taken when space is released,
+ * in whole steps of winding up, see table_set_cue().
+ *
+ * @param scene a scene with a cue on the table
+ */
+double controls_get_pull_back(scene_t *scene);
+
+#endif // #ifndef __CONTROLS_H__
@@ -29,6 +29,42 @@ typedef void (*collision_handler_t)
  */
 void create_newtonian_gravity(scene_t *scene, double G, body_t *body1, body_t *body2);
 
+/**
+ * Adds a single force creator to a scene that applies gravity
+ * between every pair of bodies in a list, like calling
+ * create_newtonian_gravity() on each pair.
+ * Uses a Barnes-Hut quadtree, rebuilt every tick, so each tick takes
+ * O(n log n) time instead of O(n^2).
+ * Bodies far enough away are pulled on as a group by their center of mass;
+ * theta sets how far that is, as the ratio of a group's width to its distance.
+ * With theta = 0 nothing is grouped and every pair is computed exactly.
+ * If any of the bodies is removed, the force creator is removed too.
+ *
+ * @param scene the scene containing the bodies
+ * @param G the gravitational proportionality constant
+ * @param bodies the bodies to attract to each other;
+ *   the scene takes ownership of this list, so its freer should be NULL
+ * @param theta the accuracy parameter; 0 is exact, around 0.5 is typical
+ */
+void create_nbody_gravity(scene_t *scene, double G, list_t *bodies, double theta);
+
+/**
+ * Adds a single force creator to a scene that applies gravity
+ * between every pair of bodies in a list, exactly as
+ * calling create_newtonian_gravity() on each pair would.
+ * Each tick still takes O(n^2) time, but the bodies are copied into
+ * contiguous arrays and summed in cache-sized blocks with no calls
+ * in the inner loop, so it is much faster than the per-pair force creators.
+ * Prefer create_nbody_gravity() once there are many thousands of bodies.
+ * If any of the bodies is removed, the force creator is removed too.
+ *
+ * @param scene the scene containing the bodies
+ * @param G the gravitational proportionality constant
+ * @param bodies the bodies to attract to each other;
+ *   the scene takes ownership of this list, so its freer should be NULL
+ */
+void create_group_gravity(scene_t *scene, double G, list_t *bodies);
+
 /**
  * Adds a force creator to a scene that acts like a spring between two bodies.
  * The force creator will be called each tick
@@ -55,6 +91,21 @@ void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2);
  */
 void create_drag(scene_t *scene, double gamma, body_t *body);
 
+/**
+ * Adds one force creator to a scene that applies the drag force from
+ * create_drag() to every body in a list.
+ * This is cheaper than calling create_drag() on each body,
+ * both to set up and every tick.
+ * If any of the bodies is removed, the force creator is removed too,
+ * so only group bodies that stay in the scene together.
+ *
+ * @param scene the scene containing the bodies
+ * @param gamma the proportionality constant between force and velocity
+ * @param bodies the bodies to slow down;
+ *   the scene takes ownership of this list, so its freer should be NULL
+ */
+void create_group_drag(scene_t *scene, double gamma, list_t *bodies);
+
 /**
  * Adds a force creator to a scene that calls a given collision handler
  * function each time two bodies collide.
@@ -124,6 +175,11 @@ void create_physics_collision_with_removal(scene_t *scene, double elasticity, bo
 void create_physics_collision_with_translation(scene_t *scene, double elasticity, body_t *body1, body_t *body2, ball_t *to_move);
 
 
+/**
+ * Bodies slowed by friction are stopped dead once they are this slow.
+ */
+extern const double MIN_FRICTION_SPEED;
+
 /**
  * Adds a force creator that creates a frictional force between the body and
  * whatever surface it's on. This computes the frictional force that will be
@@ -139,4 +195,46 @@ void create_physics_collision_with_translation(scene_t *scene, double elasticity
  */
 void create_ideal_friction(scene_t *scene, double mug, body_t *body);
 
+/**
+ * Adds one force creator to a scene that applies the friction from
+ * create_ideal_friction() to every body in a list.
+ * This is cheaper than calling create_ideal_friction() on each body,
+ * both to set up and every tick.
+ * If any of the bodies is removed, the force creator is removed too,
+ * so only group bodies that stay in the scene together.
+ *
+ * @param scene the scene containing the bodies
+ * @param mug the coefficient of friction times the acceleration due to gravity
+ * @param bodies the bodies that the frictional force is acting upon;
+ *   the scene takes ownership of this list, so its freer should be NULL
+ */
+void create_group_friction(scene_t *scene, double mug, list_t *bodies);
+
+/**
+ * Copies the state of every collision force creator in a scene into flags,
+ * in the order the force creators were added.
+ * A flag is true if the bodies are still touching from a collision
+ * that was already handled, so the handler will not be called again
+ * until they separate.
+ * Together with the bodies' positions and velocities,
+ * this is what is needed to resume a scene exactly.
+ *
+ * @param scene the scene containing the force creators
+ * @param flags the array to write into
+ * @param max the length of flags; at most this many flags are written
+ * @return the number of collision force creators in the scene
+ */
+size_t scene_get_collision_flags(scene_t *scene, bool *flags, size_t max);
+
+/**
+ * Restores flags saved with scene_get_collision_flags().
+ * The scene must have the same collision force creators, in the same order,
+ * as the scene the flags were saved from.
+ *
+ * @param scene the scene containing the force creators
+ * @param flags the flags to restore
+ * @param count the number of flags; at most this many are restored
+ */
+void scene_set_collision_flags(scene_t *scene, const bool *flags, size_t count);
+
 #endif // #ifndef __FORCES_H__
@@ -0,0 +1,32 @@
+#ifndef __INPUT_H__
+#define __INPUT_H__
+
+// Values passed to a key handler when the given arrow key is pressed
+#define LEFT_ARROW 1
+#define UP_ARROW 2
+#define RIGHT_ARROW 3
+#define DOWN_ARROW 4
+#define SPACE 5
+
+/**
+ * The possible types of key events.
+ * Enum types in C are much more primitive than in Java; this is equivalent to:
+ * typedef unsigned int key_handler_t;
+ * #define KEY_PRESSED 0
+ * #define KEY_RELEASED 1
+ */
+typedef enum {
+    KEY_PRESSED,
+    KEY_RELEASED
+} key_event_type_t;
+
+/**
+ * The possible types of mouse events.
+ */
+typedef enum {
+    MOUSE_MOVED,
+    MOUSE_PRESSED,
+    MOUSE_RELEASED
+} mouse_event_type_t;
+
+#endif // #ifndef __INPUT_H__
@@ -0,0 +1,126 @@
+#ifndef __INPUT_LOG_H__
+#define __INPUT_LOG_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "input.h"
+#include "vector.h"
+
+/**
+ * A recording of the key and mouse events of a game, each stamped with
+ * the number of ticks simulated before it was handled.
+ * Together with the seed the table was racked with and the fixed tick length,
+ * this is enough to play the game again exactly, without a window.
+ */
+typedef struct input_log input_log_t;
+
+/**
+ * Where an input event came from.
+ */
+typedef enum {
+    INPUT_KEY,
+    INPUT_MOUSE
+} input_device_t;
+
+/**
+ * One key or mouse event, as passed to a key_handler_t or mouse_handler_t.
+ */
+typedef struct {
+    /** How many ticks had been simulated when the event was handled */
+    uint32_t tick;
+    input_device_t device;
+    /** A key_event_type_t or mouse_event_type_t, depending on the device */
+    int type;
+    /** For key events, the key */
+    char key;
+    /** For key events and mouse button events, how long it had been held */
+    double held_time;
+    /** For mouse events, where the mouse was, in whole pixels */
+    vector_t position;
+} input_event_t;
+
+/**
+ * Allocates an empty recording.
+ *
+ * @param seed the value passed to srand() before the table was racked
+ * @param dt the length of every tick, in seconds
+ * @return the new recording
+ */
+input_log_t *input_log_init(unsigned int seed, double dt);
+
+/**
+ * Releases the memory allocated for a recording.
+ *
+ * @param log a pointer to a recording returned from input_log_init() or input_log_load()
+ */
+void input_log_free(input_log_t *log);
+
+/**
+ * Appends an event to a recording.
+ * Events must be added in the order they were handled,
+ * so their ticks never decrease.
+ *
+ * @param log a pointer to a recording returned from input_log_init()
+ * @param event the event; mouse positions are rounded to whole pixels
+ */
+void input_log_add(input_log_t *log, input_event_t event);
+
+/**
+ * Sets how many ticks were simulated in total, so a replay stops in the same place.
+ *
+ * @param log a pointer to a recording returned from input_log_init()
+ * @param ticks the number of ticks, at least the tick of the last event
+ */
+void input_log_set_ticks(input_log_t *log, uint32_t ticks);
+
+/**
+ * Gets the number of events in a recording.
+ */
+size_t input_log_size(input_log_t *log);
+
+/**
+ * Gets an event from a recording, in the order they were added.
+ *
+ * @param log a pointer to a recording
+ * @param index the index of the event, less than input_log_size()
+ */
+input_event_t input_log_get(input_log_t *log, size_t index);
+
+/**
+ * Gets the seed passed to input_log_init().
+ */
+unsigned int input_log_get_seed(input_log_t *log);
+
+/**
+ * Gets the tick length passed to input_log_init().
+ */
+double input_log_get_dt(input_log_t *log);
+
+/**
+ * Gets the total number of ticks passed to input_log_set_ticks(),
+ * or the tick of the last event if it was never called.
+ */
+uint32_t input_log_get_ticks(input_log_t *log);
+
+/**
+ * Writes a recording to a file in a compact binary format.
+ * Each event takes a few bytes: the ticks since the previous event as a varint,
+ * a byte for the device and type, then the key or the position,
+ * and the held time only for the events that have one.
+ *
+ * @param log a pointer to a recording
+ * @param path the file to write
+ * @return whether the whole recording was written
+ */
+bool input_log_save(input_log_t *log, const char *path);
+
+/**
+ * Reads a recording written by input_log_save().
+ *
+ * @param path the file to read
+ * @return the recording, or NULL if the file could not be read or is not a recording
+ */
+input_log_t *input_log_load(const char *path);
+
+#endif // #ifndef __INPUT_LOG_H__
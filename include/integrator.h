@@ -0,0 +1,41 @@
+#ifndef __INTEGRATOR_H__
+#define __INTEGRATOR_H__
+
+#include <stddef.h>
+
+/**
+ * How a body's position and velocity are advanced each tick.
+ * A scene has one integrator (see scene_set_integrator())
+ * and each body can override it (see body_set_integrator()).
+ *
+ * The trapezoid and semi-implicit Euler integrators use the forces
+ * computed once at the start of the tick.
+ * Velocity Verlet and RK4 call the scene's force creators again at
+ * intermediate positions (once more and three more times respectively),
+ * so they are only suitable for scenes whose force creators have no
+ * side effects, like gravity, springs and drag; a collision handler could
+ * run at a position the body never reaches.
+ * Impulses are applied at the start of the tick by every integrator.
+ */
+typedef enum {
+    /** For bodies only: use the scene's integrator */
+    INTEGRATOR_SCENE,
+    /** Moves at the average of the old and new velocity; see body_tick() */
+    INTEGRATOR_TRAPEZOID,
+    /** Updates the velocity, then moves at the new velocity */
+    INTEGRATOR_SEMI_IMPLICIT_EULER,
+    /** Second order and symplectic, so it keeps orbits and springs' energy */
+    INTEGRATOR_VELOCITY_VERLET,
+    /** Classic fourth order Runge-Kutta */
+    INTEGRATOR_RK4
+} integrator_t;
+
+/**
+ * Returns how many times per tick an integrator needs the forces computed.
+ *
+ * @param integrator any integrator other than INTEGRATOR_SCENE
+ * @return 1 for the trapezoid and Euler integrators, 2 for Verlet, 4 for RK4
+ */
+size_t integrator_stages(integrator_t integrator);
+
+#endif // #ifndef __INTEGRATOR_H__
@@ -5,14 +5,18 @@
 #include "vector.h"
 #include "body.h"
 #include "ball.h"
-#include "sdl_wrapper.h"
+#include "input.h"
+#include "scene.h"
 
-void mouse_handle_firing(int type, body_t *cue, ball_t *cueball, scene_t *scene, double held_time);
+// Mouse positions are in window pixels, which match scene coordinates on the pool table.
+// None of these call SDL, so they can be driven by recorded input without a window.
 
-void mouse_handle_placing (int type, ball_t *cueball, scene_t *scene, const vector_t *area);
+void mouse_handle_firing(mouse_event_type_t type, vector_t mouse, body_t *cue, ball_t *cueball, scene_t *scene, double held_time);
 
-void mouse_handle_menu (int type, scene_t *scene, const vector_t *box1, const vector_t *box2);
+void mouse_handle_placing (mouse_event_type_t type, vector_t mouse, ball_t *cueball, scene_t *scene, const vector_t *area);
 
-bool mouse_within(vector_t min, vector_t max);
+void mouse_handle_menu (mouse_event_type_t type, vector_t mouse, scene_t *scene, const vector_t *box1, const vector_t *box2);
+
+bool mouse_within(vector_t mouse, vector_t min, vector_t max);
 
 #endif // #ifndef __MOUSE_H__
@@ -0,0 +1,139 @@
+#ifndef __NETPLAY_H__
+#define __NETPLAY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "scene.h"
+#include "transport.h"
+#include "vector.h"
+
+/**
+ * Plays a game against another player over a transport, with rollback.
+ * Each player's input for every tick is sent to the other player.
+ * Until it arrives, the other player is predicted to do nothing new
+ * (only to keep aiming where they last aimed), and the game carries on without waiting.
+ * If a placement or shot arrives for a tick that has already been simulated,
+ * the table is put back as it was before that tick and simulated forward again.
+ * The table is saved before every tick, for as far back as a rollback can go.
+ *
+ * A player's input is only used when it is their turn, the same way on both sides,
+ * so both players see the same game once all input has arrived.
+ */
+typedef struct netplay netplay_t;
+
+/**
+ * The most ticks a rollback can go back.
+ */
+#define NETPLAY_WINDOW 64
+
+/**
+ * What a player did in one tick, as a bitmask.
+ */
+typedef enum {
+    /** Turned the cue to angle */
+    NET_AIM = 1,
+    /** Put the cue ball down at position after a scratch */
+    NET_PLACE = 2,
+    /** Shot at angle with power, with the cue pulled back by pull_back */
+    NET_SHOOT = 4
+} net_action_t;
+
+/**
+ * A player's input for one tick.
+ */
+typedef struct {
+    /** The net_action_t bits of what the player did, or 0 for nothing */
+    uint8_t actions;
+    /** For NET_AIM and NET_SHOOT, the angle of the cue, see table_aim() */
+    double angle;
+    /** For NET_PLACE, where the cue ball was put */
+    vector_t position;
+    /** For NET_SHOOT, the power of the shot, see table_shoot() */
+    double power;
+    /** For NET_SHOOT, how far the cue was pulled back, see table_set_cue() */
+    double pull_back;
+} net_input_t;
+
+/**
+ * How much rolling back a game has needed.
+ */
+typedef struct {
+    /** The number of rollbacks */
+    size_t rollbacks;
+    /** The total number of ticks simulated again */
+    size_t resimulated_ticks;
+    /** The most ticks simulated again in one rollback */
+    size_t max_resimulated_ticks;
+    /** The total time spent rolling back, in seconds */
+    double rollback_seconds;
+    /** The longest a rollback took, in seconds */
+    double max_rollback_seconds;
+    /** How many times netplay_advance() waited for the other player */
+    size_t stalls;
+} netplay_stats_t;
+
+/**
+ * Starts playing a game over a transport.
+ *
+ * @param scene the table, racked the same way on both sides, e.g. with the same seed
+ * @param local_player the index of the player whose input is given to netplay_advance()
+ * @param transport the connection to the other player; not freed by netplay_free()
+ * @param dt the length of each tick, in seconds
+ * @param max_rollback how many ticks the game may run ahead of the other player's input,
+ *   less than NETPLAY_WINDOW
+ * @return the new game
+ */
+netplay_t *netplay_init(
+    scene_t *scene,
+    int local_player,
+    transport_t *transport,
+    double dt,
+    size_t max_rollback
+);
+
+/**
+ * Releases the memory allocated for a game, but not its scene or transport.
+ *
+ * @param netplay a pointer to a game returned from netplay_init()
+ */
+void netplay_free(netplay_t *netplay);
+
+/**
+ * Takes the other player's input that has arrived, rolling back if it changes the past,
+ * then simulates one tick with the local player's input,
+ * unless the other player's input is more than max_rollback ticks behind.
+ * Either way, sends the local input the other player has not acknowledged yet.
+ * Should be called once per tick.
+ *
+ * @param netplay a pointer to a game returned from netplay_init()
+ * @param input what the local player did this tick; ignored if the game does not advance
+ * @return whether a tick was simulated
+ */
+bool netplay_advance(netplay_t *netplay, net_input_t input);
+
+/**
+ * Takes the other player's input that has arrived and sends the unacknowledged local input,
+ * like netplay_advance() but without simulating a tick, e.g. while the game is paused.
+ *
+ * @param netplay a pointer to a game returned from netplay_init()
+ */
+void netplay_poll(netplay_t *netplay);
+
+/**
+ * Gets how many ticks have been simulated.
+ */
+uint32_t netplay_get_tick(netplay_t *netplay);
+
+/**
+ * Gets how many ticks of the other player's input have arrived,
+ * so the game up to that tick will not change again.
+ */
+uint32_t netplay_get_confirmed_tick(netplay_t *netplay);
+
+/**
+ * Gets how much rolling back the game has needed so far.
+ */
+netplay_stats_t netplay_get_stats(netplay_t *netplay);
+
+#endif // #ifndef __NETPLAY_H__
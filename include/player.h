@@ -29,6 +29,10 @@ char *player_get_name(player_t *player);
 
 int player_foul(player_t *player);
 
+bool player_is_computer(player_t *player);
+
+void player_set_computer(player_t *player, bool computer);
+
 void player_free (player_t *player);
 
 #endif // #ifndef __PLAYER_H__
@@ -0,0 +1,105 @@
+#ifndef __POLYGON_BATCH_H__
+#define __POLYGON_BATCH_H__
+
+#include <stddef.h>
+#include <SDL2/SDL.h>
+#include "color.h"
+#include "list.h"
+#include "vector.h"
+
+/**
+ * Filled polygons queued up to be drawn in one SDL_RenderGeometry call.
+ * Vertices are mapped from scene coordinates to pixels as they are added,
+ * using a transform that is set once per frame, or taken as pixels as they are
+ * for scenes laid out in window pixels, like the pool table.
+ * Like a sprite batch, its arrays grow as needed and are kept between frames,
+ * so a batch that is reused every frame stops allocating once it is big enough.
+ */
+typedef struct polygon_batch polygon_batch_t;
+
+/**
+ * Allocates an empty batch.
+ * Its transform takes coordinates as pixels, as polygon_batch_set_pixel_transform() does,
+ * and its polygons are opaque.
+ *
+ * @return the new batch
+ */
+polygon_batch_t *polygon_batch_init(void);
+
+/**
+ * Releases the memory allocated for a batch.
+ *
+ * @param batch a pointer to a batch returned from polygon_batch_init()
+ */
+void polygon_batch_free(polygon_batch_t *batch);
+
+/**
+ * Empties a batch so it can be filled for the next frame.
+ * Keeps its transform and alpha.
+ *
+ * @param batch a pointer to a batch returned from polygon_batch_init()
+ */
+void polygon_batch_clear(polygon_batch_t *batch);
+
+/**
+ * Sets how polygons added from now on are mapped onto the screen:
+ * scene_center goes to window_center, scene distances are multiplied by scale,
+ * and the y axis is flipped, since positive y is down on the screen.
+ *
+ * @param batch a pointer to a batch returned from polygon_batch_init()
+ * @param scene_center the point in the scene at the center of the window
+ * @param scale pixels per unit of scene distance
+ * @param window_center the center of the window, in pixels
+ */
+void polygon_batch_set_transform(
+    polygon_batch_t *batch, vector_t scene_center, double scale, vector_t window_center
+);
+
+/**
+ * Makes polygons added from now on be drawn with their coordinates as pixels,
+ * without scaling, moving or flipping them.
+ *
+ * @param batch a pointer to a batch returned from polygon_batch_init()
+ */
+void polygon_batch_set_pixel_transform(polygon_batch_t *batch);
+
+/**
+ * Sets how opaque polygons added from now on are.
+ * Polygons that are not fully opaque are blended onto what was drawn before the batch.
+ *
+ * @param batch a pointer to a batch returned from polygon_batch_init()
+ * @param alpha 255 for opaque down to 0 for invisible
+ */
+void polygon_batch_set_alpha(polygon_batch_t *batch, Uint8 alpha);
+
+/**
+ * Queues a filled polygon. The points are only read, not kept,
+ * so a body's shape can be passed straight from body_borrow_shape().
+ * The polygon is drawn as triangles fanning out from the average of its vertices,
+ * so it must be convex or at least have every edge visible from that point,
+ * as balls, rectangles and stars do.
+ * Polygons are drawn in the order they were added.
+ *
+ * @param batch a pointer to a batch returned from polygon_batch_init()
+ * @param points the vertices of the polygon in scene coordinates, at least 3
+ * @param color the color to fill the polygon with
+ */
+void polygon_batch_add(polygon_batch_t *batch, list_t *points, rgb_color_t color);
+
+/**
+ * Gets the number of polygons queued in a batch.
+ *
+ * @param batch a pointer to a batch returned from polygon_batch_init()
+ */
+size_t polygon_batch_size(polygon_batch_t *batch);
+
+/**
+ * Draws every queued polygon with one SDL_RenderGeometry call.
+ * The batch keeps its polygons, so call polygon_batch_clear() before refilling it.
+ *
+ * @param batch a pointer to a batch returned from polygon_batch_init()
+ * @param renderer the renderer to draw with
+ */
+void polygon_batch_draw(polygon_batch_t *batch, SDL_Renderer *renderer);
+
+#endif // #ifndef __POLYGON_BATCH_H__
@@ -0,0 +1,108 @@
+#ifndef __PREVIEW_H__
+#define __PREVIEW_H__
+
+#include <stdbool.h>
+#include "scene.h"
+#include "vector.h"
+
+/**
+ * Predicts where the cue ball goes while a player aims, up to the first thing it touches.
+ * Only the cue ball is simulated, on a copy of where the other balls, cushions and pockets are,
+ * with the same friction and tick length as the game.
+ * Each aim is simulated a few steps at a time, within a time budget per call,
+ * and kept in a small cache keyed on the angle and power rounded off,
+ * so sweeping the cue back and forth reuses what was already worked out.
+ */
+typedef struct preview preview_t;
+
+/**
+ * What the cue ball touches first.
+ */
+typedef enum {
+    /** Nothing yet; the preview has not finished */
+    PREVIEW_UNKNOWN,
+    /** Nothing; the cue ball stops on its own */
+    PREVIEW_STOPS,
+    /** Another ball */
+    PREVIEW_BALL,
+    /** A cushion */
+    PREVIEW_CUSHION,
+    /** A pocket, i.e. the shot is a scratch */
+    PREVIEW_POCKET
+} preview_contact_t;
+
+/**
+ * The predicted path of the cue ball, in scene coordinates.
+ * Friction only slows the cue ball down, so the path is a straight line from start to end.
+ */
+typedef struct {
+    preview_contact_t contact;
+    /** Where the cue ball starts */
+    vector_t start;
+    /** Where the cue ball touches something or stops, or how far the preview has got */
+    vector_t end;
+    /** The radius of the cue ball */
+    double radius;
+    /** If contact is PREVIEW_BALL, the number of the ball touched */
+    int ball;
+    /** If contact is PREVIEW_BALL, the unit direction the touched ball heads off in */
+    vector_t ball_direction;
+    /**
+     * If contact is PREVIEW_BALL, the unit direction the cue ball glances off in,
+     * or zero if it hits the ball dead on
+     */
+    vector_t cue_direction;
+} aim_preview_t;
+
+/**
+ * Allocates a preview with an empty cache.
+ *
+ * @param dt the length of each tick the game is played with, in seconds
+ * @return the new preview
+ */
+preview_t *preview_init(double dt);
+
+/**
+ * Releases the memory allocated for a preview.
+ *
+ * @param preview a pointer to a preview returned from preview_init()
+ */
+void preview_free(preview_t *preview);
+
+/**
+ * Copies the positions of the balls, cushions and pockets to aim among.
+ * Cheap if nothing has moved since the last call, so it can be called every tick;
+ * otherwise every cached path is thrown away.
+ *
+ * @param preview a pointer to a preview returned from preview_init()
+ * @param scene a scene set up with populate_scene(), with the balls at rest
+ */
+void preview_set_table(preview_t *preview, scene_t *scene);
+
+/**
+ * Picks the aim to refine and report on, reusing the cached path for it if there is one.
+ *
+ * @param preview a pointer to a preview passed to preview_set_table()
+ * @param angle the angle of the cue, see table_aim()
+ * @param power the power of the shot, see table_shoot()
+ */
+void preview_aim(preview_t *preview, double angle, double power);
+
+/**
+ * Simulates more of the current aim's path, until its first contact is found
+ * or the time runs out.
+ *
+ * @param preview a pointer to a preview passed to preview_aim()
+ * @param seconds the most time to spend
+ * @return whether the path is finished
+ */
+bool preview_refine(preview_t *preview, double seconds);
+
+/**
+ * Gets the path of the current aim, as far as it has been simulated.
+ *
+ * @param preview a pointer to a preview passed to preview_aim()
+ */
+aim_preview_t preview_get(preview_t *preview);
+
+#endif // #ifndef __PREVIEW_H__
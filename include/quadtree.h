@@ -0,0 +1,59 @@
+#ifndef __QUADTREE_H__
+#define __QUADTREE_H__
+
+#include <stddef.h>
+#include "vector.h"
+
+/**
+ * A Barnes-Hut quadtree over a set of point masses.
+ * Each node stores the total mass and center of mass of the points inside it,
+ * so the pull of a faraway cluster can be approximated by a single point.
+ * The tree keeps its memory between builds,
+ * so rebuilding it every tick does not allocate once it has grown.
+ */
+typedef struct quadtree quadtree_t;
+
+/**
+ * Allocates memory for an empty quadtree.
+ *
+ * @return the new quadtree
+ */
+quadtree_t *quadtree_init(void);
+
+/**
+ * Releases the memory allocated for a quadtree.
+ *
+ * @param tree a pointer to a quadtree returned from quadtree_init()
+ */
+void quadtree_free(quadtree_t *tree);
+
+/**
+ * Rebuilds the tree over the given points, replacing any previous contents.
+ * The arrays are not copied, so they must not change
+ * until the tree is rebuilt or no longer used.
+ *
+ * @param tree a pointer to a quadtree returned from quadtree_init()
+ * @param positions the position of each point
+ * @param masses the mass of each point
+ * @param count the number of points
+ */
+void quadtree_build(quadtree_t *tree, const vector_t *positions, const double *masses, size_t count);
+
+/**
+ * Computes the Newtonian gravitational force on one of the points
+ * from all of the others.
+ * A node is treated as a single point at its center of mass if its width
+ * divided by its distance from the point is less than theta.
+ * With theta = 0 every pair is computed exactly.
+ * Pairs closer than min_dist are skipped, as in create_newtonian_gravity().
+ *
+ * @param tree a tree built with quadtree_build()
+ * @param index the index of the point to compute the force on
+ * @param G the gravitational proportionality constant
+ * @param theta the accuracy parameter; 0 is exact, around 0.5 is typical
+ * @param min_dist the distance below which no force is applied
+ * @return the total force on the point
+ */
+vector_t quadtree_force(quadtree_t *tree, size_t index, double G, double theta, double min_dist);
+
+#endif // #ifndef __QUADTREE_H__
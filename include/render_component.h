@@ -0,0 +1,71 @@
+#ifndef __RENDER_COMPONENT_H__
+#define __RENDER_COMPONENT_H__
+
+#include <stddef.h>
+
+/**
+ * The images bodies can be drawn with.
+ * Each has a fixed number, so a body's image is looked up once
+ * when the body is made rather than by comparing paths every frame.
+ * The renderer packs every sprite into one atlas, numbered the same way.
+ */
+typedef enum {
+    /** Ball n is drawn with SPRITE_BALL_0 + n */
+    SPRITE_BALL_0,
+    SPRITE_CUE = SPRITE_BALL_0 + 16,
+    NUM_SPRITES
+} sprite_id_t;
+
+/**
+ * How a body is drawn.
+ */
+typedef enum {
+    /** Not drawn, e.g. cushions and pockets, which are part of the background */
+    DRAW_NONE,
+    /** The sprite centered on the body's centroid, upright */
+    DRAW_SPRITE,
+    /** The sprite centered on the body's centroid, turned with the body */
+    DRAW_ROTATED_SPRITE
+} draw_kind_t;
+
+/**
+ * Which layer a body is drawn in.
+ */
+typedef enum {
+    /** Drawn every frame, on top of the static layer */
+    LAYER_DYNAMIC,
+    /**
+     * Drawn along with the background only when it changes;
+     * for bodies that never move
+     */
+    LAYER_STATIC
+} render_layer_t;
+
+/**
+ * Everything the renderer needs to know about a body besides where it is.
+ * Bodies start out with DRAW_NONE; see body_set_render().
+ */
+typedef struct {
+    draw_kind_t kind;
+    render_layer_t layer;
+    sprite_id_t sprite;
+} render_component_t;
+
+/**
+ * Gets the image file a sprite is loaded from.
+ *
+ * @param sprite a sprite less than NUM_SPRITES
+ * @return the path of the image, relative to the working directory
+ */
+const char *sprite_get_path(sprite_id_t sprite);
+
+/**
+ * Gets the direction the sprite's image points in, as drawn in its file.
+ * A DRAW_ROTATED_SPRITE body with this angle is drawn as the file is.
+ *
+ * @param sprite a sprite less than NUM_SPRITES
+ * @return the angle in radians, counterclockwise from the positive x axis
+ */
+double sprite_get_heading(sprite_id_t sprite);
+
+#endif // #ifndef __RENDER_COMPONENT_H__
@@ -0,0 +1,41 @@
+#ifndef __RNG_H__
+#define __RNG_H__
+
+#include <stdint.h>
+
+/**
+ * A small xorshift64* random number generator.
+ * Its state is a single number owned by the caller, so code that needs
+ * reproducible random numbers, like the computer player or a simulated
+ * network, never touches rand() and the game's random numbers,
+ * and each thread can keep its own state.
+ */
+
+/**
+ * Turns a seed into a generator state.
+ * xorshift never leaves 0, so a seed of 0 is replaced with another value.
+ *
+ * @param seed any number
+ * @return a state to pass to rng_unit()
+ */
+uint64_t rng_seed(uint64_t seed);
+
+/**
+ * Advances a generator and returns its next number.
+ *
+ * @param rng a state returned from rng_seed()
+ * @return a number in [0, 1) with 53 random bits
+ */
+double rng_unit(uint64_t *rng);
+
+/**
+ * Advances a generator and returns its next number scaled to a range.
+ *
+ * @param rng a state returned from rng_seed()
+ * @param min the lowest number to return
+ * @param max the number every result is below
+ * @return a number in [min, max)
+ */
+double rng_between(uint64_t *rng, double min, double max);
+
+#endif // #ifndef __RNG_H__
@@ -1,7 +1,10 @@
 #ifndef __SCENE_H__
 #define __SCENE_H__
 
+#include <stdbool.h>
+#include <stdio.h>
 #include "body.h"
+#include "contact_solver.h"
 #include "list.h"
 #include "player.h"
 
@@ -28,6 +31,58 @@ typedef struct scene scene_t;
  */
 typedef void (*force_creator_t)(void *aux);
 
+/**
+ * What kind of force a force creator applies, so profiling can add up its time.
+ * Force creators added with scene_add_bodies_force_creator() are FORCE_USER.
+ */
+typedef enum {
+    FORCE_USER,
+    FORCE_GRAVITY,
+    FORCE_SPRING,
+    FORCE_DRAG,
+    FORCE_COLLISION,
+    FORCE_PHYSICS_COLLISION,
+    FORCE_IDEAL_FRICTION,
+    /** The number of kinds, not a kind */
+    FORCE_KINDS
+} force_kind_t;
+
+/**
+ * The parts of scene_tick() that are not force creators.
+ */
+typedef enum {
+    /** The contact solver, see scene_set_contact_solver() */
+    PHASE_CONTACTS,
+    /** Moving the bodies with their integrators */
+    PHASE_INTEGRATION,
+    /** Removing the bodies and force creators marked for removal */
+    PHASE_REMOVAL,
+    /** The number of phases, not a phase */
+    SCENE_PHASES
+} scene_phase_t;
+
+/**
+ * How many times something ran while profiling, and for how long in total.
+ */
+typedef struct {
+    size_t calls;
+    double seconds;
+} profile_counter_t;
+
+/**
+ * Where the time in scene_tick() went, see scene_set_profiling().
+ */
+typedef struct {
+    /** The number of ticks profiled */
+    size_t ticks;
+    /** The total time in scene_tick(), in seconds */
+    double seconds;
+    /** Every call to a force creator, indexed by force_kind_t */
+    profile_counter_t forces[FORCE_KINDS];
+    /** Each phase, indexed by scene_phase_t */
+    profile_counter_t phases[SCENE_PHASES];
+} scene_profile_t;
+
 /**
  * Allocates memory for an empty scene.
  * Makes a reasonable guess of the number of bodies to allocate space for.
@@ -43,6 +98,52 @@ int scene_set_state(scene_t *scene, int st);
 
 int scene_get_turn(scene_t *scene);
 
+/**
+ * Gets the scene's contact solver.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the solver passed to scene_set_contact_solver(), or NULL
+ */
+contact_solver_t *scene_get_contact_solver(scene_t *scene);
+
+/**
+ * Gives a scene a contact solver to run each tick after the force creators.
+ * The scene takes ownership of the solver, freeing any solver it had before.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param solver a pointer to a solver returned from contact_solver_init(), or NULL
+ */
+void scene_set_contact_solver(scene_t *scene, contact_solver_t *solver);
+
+/**
+ * Returns the length of the tick in progress,
+ * so force creators that integrate implicitly can use it.
+ * Between ticks, this is the length of the last one.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the dt passed to the latest scene_tick(), or 0 before the first
+ */
+double scene_get_dt(scene_t *scene);
+
+/**
+ * Gets the integrator used for bodies that do not override it.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the scene's integrator, INTEGRATOR_TRAPEZOID unless it was changed
+ */
+integrator_t scene_get_integrator(scene_t *scene);
+
+/**
+ * Changes the integrator used for bodies that do not override it.
+ * See integrator_t for which force creators each integrator works with.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param integrator any integrator other than INTEGRATOR_SCENE
+ */
+void scene_set_integrator(scene_t *scene, integrator_t integrator);
+
+void scene_set_turn(scene_t *scene, int turn);
+
 list_t *scene_get_players(scene_t *scene);
 
 void scene_add_player(scene_t *scene, player_t *player);
@@ -135,6 +236,65 @@ void scene_add_bodies_force_creator(
     free_func_t freer
 );
 
+/**
+ * Like scene_add_bodies_force_creator(), but says what kind of force it applies.
+ * The force creators in forces.h all use this.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param kind the kind of force, which profiling adds the force creator's time to
+ * @param forcer a force creator function
+ * @param aux an auxiliary value to pass to forcer when it is called
+ * @param bodies the list of bodies affected by the force creator, or NULL
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_kind_force_creator(
+    scene_t *scene,
+    force_kind_t kind,
+    force_creator_t forcer,
+    void *aux,
+    list_t *bodies,
+    free_func_t freer
+);
+
+/**
+ * Gets the number of force creators in a given scene.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the number of force creators added to the scene
+ */
+size_t scene_force_creators(scene_t *scene);
+
+/**
+ * Gets the function of the force creator at a given index in a scene.
+ * Force creators are kept in the order they were added.
+ * Asserts that the index is valid.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param index the index of the force creator (starting at 0)
+ * @return the forcer passed to scene_add_bodies_force_creator()
+ */
+force_creator_t scene_get_forcer(scene_t *scene, size_t index);
+
+/**
+ * Gets the auxiliary value of the force creator at a given index in a scene.
+ * Asserts that the index is valid.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param index the index of the force creator (starting at 0)
+ * @return the aux passed to scene_add_bodies_force_creator()
+ */
+void *scene_get_force_aux(scene_t *scene, size_t index);
+
+/**
+ * Removes and frees every body marked for removal,
+ * along with any force creators acting on them,
+ * without applying forces or moving anything.
+ * scene_tick() does this at the end of each tick.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+void scene_remove_marked(scene_t *scene);
+
 /**
  * Executes a tick of a given scene over a small time interval.
  * This requires executing all the force creators
@@ -147,4 +307,60 @@ void scene_add_bodies_force_creator(
  */
 void scene_tick(scene_t *scene, double dt);
 
+/**
+ * Gets the kind of the force creator at a given index in a scene.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param index the index of the force creator (starting at 0)
+ * @return the kind passed to scene_add_kind_force_creator(), or FORCE_USER
+ */
+force_kind_t scene_get_force_kind(scene_t *scene, size_t index);
+
+/**
+ * Turns profiling on or off. Profiling is off when a scene is created.
+ * While it is on, scene_tick() times every force creator call and every phase
+ * and adds them to the scene's profile. Each timed call costs two clock reads,
+ * so profiling slows a scene with many cheap force creators noticeably;
+ * while it is off, the only cost is one check per force creator call.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param profiling whether to profile the following ticks
+ */
+void scene_set_profiling(scene_t *scene, bool profiling);
+
+/**
+ * Gets the time spent in each kind of force creator and each phase
+ * over every tick profiled since the scene was created or last reset.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the totals so far
+ */
+scene_profile_t scene_get_profile(scene_t *scene);
+
+/**
+ * Sets all of a scene's profile counters back to zero.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+void scene_reset_profile(scene_t *scene);
+
+/**
+ * Gets the name of a kind of force, e.g. "physics_collision".
+ */
+const char *force_kind_name(force_kind_t kind);
+
+/**
+ * Gets the name of a phase of scene_tick(), e.g. "integration".
+ */
+const char *scene_phase_name(scene_phase_t phase);
+
+/**
+ * Prints a table of a scene's profile: the calls, total time, time per call
+ * and share of the tick time of every kind of force and phase that ran.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param file where to print, e.g. stderr
+ */
+void scene_print_profile(scene_t *scene, FILE *file);
+
 #endif // #ifndef __SCENE_H__
@@ -7,26 +7,8 @@
 #include "scene.h"
 #include "vector.h"
 #include "player.h"
-
-// Values passed to a key handler when the given arrow key is pressed
-#define LEFT_ARROW 1
-#define UP_ARROW 2
-#define RIGHT_ARROW 3
-#define DOWN_ARROW 4
-#define SPACE 5
-
-/**
- * The possible types of key events.
- * Enum types in C are much more primitive than in Java; this is equivalent to:
- * typedef unsigned int key_handler_t;
- * #define KEY_PRESSED 0
- * #define KEY_RELEASED 1
- */
-typedef enum {
-    KEY_PRESSED,
-    KEY_RELEASED
-} key_event_type_t;
-
+#include "preview.h"
+#include "input.h"
 
 /**
  * A keypress handler.
@@ -40,7 +22,33 @@ typedef enum {
  */
 typedef void (*key_handler_t)(char key, key_event_type_t type, double held_time, scene_t *scene);
 
-typedef void (*mouse_handler_t)(int type, scene_t *scene, double held_time);
+/**
+ * A mouse handler.
+ * Mouse positions are passed with the event rather than read when it is handled,
+ * so a recorded event has the same effect when it is replayed.
+ *
+ * @param type the type of mouse event
+ * @param scene the scene passed to sdl_is_done()
+ * @param held_time if a button event, the time the button has been held in seconds
+ * @param position where the mouse was, in pixels from the top left of the window
+ */
+typedef void (*mouse_handler_t)(mouse_event_type_t type, scene_t *scene, double held_time, vector_t position);
+
+/**
+ * How long each part of a frame took to draw, in seconds.
+ * See sdl_get_render_timings().
+ */
+typedef struct {
+    double clear;
+    /** The background and LAYER_STATIC bodies, see sdl_invalidate_static_layer() */
+    double background;
+    /** The balls and the cue */
+    double sprites;
+    /** The players' names and info */
+    double text;
+    double present;
+    double total;
+} render_timings_t;
 
 
 /**
@@ -52,6 +60,51 @@ typedef void (*mouse_handler_t)(int type, scene_t *scene, double held_time);
  */
 void sdl_init(vector_t min, vector_t max);
 
+/**
+ * Initializes SDL with a software renderer that draws to an offscreen surface,
+ * for machines without a display. No window is opened and no events are received,
+ * so sdl_is_done() should not be called.
+ * Use this instead of sdl_init(), then draw frames as usual.
+ *
+ * @param min the x and y coordinates of the bottom left of the scene
+ * @param max the x and y coordinates of the top right of the scene
+ * @param width the width of each frame in pixels
+ * @param height the height of each frame in pixels
+ */
+void sdl_init_headless(vector_t min, vector_t max, int width, int height);
+
+/**
+ * Saves the last frame drawn after sdl_init_headless().
+ * Paths ending in ".png" are saved as PNG images;
+ * anything else gets the raw pixels, 4 bytes per pixel in RGBA order,
+ * one row after another from the top.
+ *
+ * @param path where to save the frame
+ * @return whether the frame was saved
+ */
+bool sdl_save_frame(const char *path);
+
+/**
+ * Decodes every image the renderer uses and renders the font's glyphs,
+ * and writes them all to an asset pack (see asset_pack.h).
+ * If "./assets/assets.pack" exists when sdl_init() or sdl_init_headless() is called,
+ * textures are made straight from its pixels instead of decoding the PNGs and the font.
+ * The pack must be written again whenever an image or the font changes.
+ * Does not need sdl_init() to have been called.
+ *
+ * @param path where to write the pack
+ * @return whether every asset was packed and the pack was written
+ */
+bool sdl_write_asset_pack(const char *path);
+
+/**
+ * Gets how long each part of the last frame drawn by
+ * sdl_render_scene() or sdl_render_published() took.
+ * With a hardware renderer this is how long it took to send the work
+ * to the GPU, not how long the GPU took to do it.
+ */
+render_timings_t sdl_get_render_timings(void);
+
 /**
  * Processes all SDL events and returns whether the window has been closed.
  * This function must be called in order to handle keypresses.
@@ -74,6 +127,36 @@ void sdl_clear(void);
  */
 void sdl_draw_polygon(list_t *points, rgb_color_t color);
 
+/**
+ * Queues a filled polygon to be drawn by the next sdl_draw_queued_polygons(),
+ * together with every other queued polygon.
+ * The points are mapped to pixels straight away and not kept,
+ * so a body's shape can be passed from body_borrow_shape() without copying it.
+ * Unlike sdl_draw_polygon(), the polygon must be convex
+ * or have every edge visible from the average of its vertices.
+ *
+ * @param points the list of vertices of the polygon
+ * @param color the color used to fill in the polygon
+ */
+void sdl_queue_polygon(list_t *points, rgb_color_t color);
+
+/**
+ * Draws every polygon queued by sdl_queue_polygon() since the last call,
+ * in the order they were queued, with a single draw call.
+ */
+void sdl_draw_queued_polygons(void);
+
+/**
+ * Draws the shape of every body in a scene in the body's color, in one draw call,
+ * e.g. to overlay what the collision code sees on top of the sprites.
+ * Like the sprites, the shapes are placed in window pixels rather than
+ * mapped from scene coordinates, and they are translucent so the sprites show through.
+ * Reads the scene, so it must not be ticked at the same time.
+ *
+ * @param scene the scene whose bodies to draw
+ */
+void sdl_draw_shapes(scene_t *scene);
+
 /**
  * Displays the rendered frame on the SDL window.
  * Must be called after drawing the polygons in order to show them.
@@ -89,6 +172,43 @@ void sdl_show(void);
  */
 void sdl_render_scene(scene_t *scene);
 
+/**
+ * Copies what sdl_render_scene() would draw out of a scene,
+ * for sdl_render_published() to draw later, possibly on another thread.
+ * Call this from the thread that ticks the scene, after each tick,
+ * while nothing else is changing the scene.
+ * The copy is made before taking the lock shared with the render thread,
+ * so this only waits for the render thread while the copy is handed over.
+ *
+ * @param scene the scene to draw
+ */
+void sdl_publish_scene(scene_t *scene);
+
+/**
+ * Draws the most recent snapshot from sdl_publish_scene(), if there is a new one.
+ * Must be called from the thread that called sdl_init().
+ * Does not touch the scene, so the scene can be ticked at the same time.
+ *
+ * @return whether a new snapshot was drawn
+ */
+bool sdl_render_published(void);
+
+/**
+ * Sets the aim preview drawn over the balls while the table is FIRING,
+ * from the next sdl_render_scene() or sdl_publish_scene() on.
+ * Call it from the same thread as those.
+ *
+ * @param preview the preview to draw, which is copied, or NULL to draw none
+ */
+void sdl_set_preview(const aim_preview_t *preview);
+
+/**
+ * Forces the background and LAYER_STATIC bodies to be redrawn on the next frame.
+ * sdl_render_scene() already notices when such a body is added, removed, moved
+ * or given another sprite, so this is only needed if SDL loses the layer some other way.
+ */
+void sdl_invalidate_static_layer(void);
+
 /**
  * Registers a function to be called every time a key is pressed.
  * Overwrites any existing handler.
@@ -127,6 +247,11 @@ void sdl_on_mouse(mouse_handler_t handler);
  */
 double time_since_last_tick(void);
 
+/**
+ * Releases every texture loaded for drawing images and text.
+ * Images are only loaded from disk the first time they are drawn,
+ * so this should be called once, when the window is no longer needed.
+ */
 void sdl_free_images();
 
 #endif // #ifndef __SDL_WRAPPER_H__
@@ -0,0 +1,212 @@
+#ifndef __SHOT_LOG_H__
+#define __SHOT_LOG_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "scene.h"
+#include "table.h"
+#include "vector.h"
+
+/**
+ * A recording of a game as the seed its rack was shuffled with and the shots taken,
+ * each stamped with the number of ticks simulated before it was taken.
+ * A shot is struck from a cue put back where it was (see table_set_cue()),
+ * so a shot's angle, pull back and power are enough to simulate it again exactly.
+ * A whole game takes well under a kilobyte.
+ *
+ * Every few shots, the table is also saved once the balls have stopped,
+ * so a shot_replay_t can seek without simulating the game from the start.
+ */
+typedef struct shot_log shot_log_t;
+
+/**
+ * Plays a shot log back on its own scene, tick by tick.
+ */
+typedef struct shot_replay shot_replay_t;
+
+/**
+ * What a player did.
+ */
+typedef enum {
+    /** Put the cue ball down after a scratch */
+    SHOT_PLACE,
+    /** Took a shot */
+    SHOT_SHOOT
+} shot_event_type_t;
+
+/**
+ * One placement or shot.
+ */
+typedef struct {
+    /** How many ticks had been simulated when it happened */
+    uint32_t tick;
+    shot_event_type_t type;
+    /** For SHOT_PLACE, where the cue ball was put */
+    vector_t position;
+    /** For SHOT_SHOOT, the angle of the cue, see table_aim() */
+    double angle;
+    /** For SHOT_SHOOT, the power of the shot, see table_shoot() */
+    double power;
+    /** For SHOT_SHOOT, how far the cue was pulled back, see table_set_cue() */
+    double pull_back;
+} shot_event_t;
+
+/**
+ * Allocates an empty recording.
+ *
+ * @param seed the value passed to srand() before the table was racked with populate_scene()
+ * @param dt the length of every tick, in seconds
+ * @param snapshot_interval how many shots apart the table is saved, or 0 to never save it
+ * @return the new recording
+ */
+shot_log_t *shot_log_init(unsigned int seed, double dt, size_t snapshot_interval);
+
+/**
+ * Releases the memory allocated for a recording.
+ *
+ * @param log a pointer to a recording returned from shot_log_init() or shot_log_load()
+ */
+void shot_log_free(shot_log_t *log);
+
+/**
+ * Appends a placement or shot to a recording.
+ * Events must be added in the order they happened, so their ticks never decrease.
+ *
+ * @param log a pointer to a recording returned from shot_log_init()
+ * @param event the placement or shot
+ */
+void shot_log_add(shot_log_t *log, shot_event_t event);
+
+/**
+ * Saves the table if it is due to be saved: the balls have stopped,
+ * a multiple of the snapshot interval of shots has been taken,
+ * and the table has not been saved since the last of them.
+ * The balls are saved rounded to a thousandth of a pixel, and the scene is put back
+ * from the saved table, so the game goes on exactly as a replay seeking to it would.
+ * Should be called after every tick, before any events stamped with that tick are added.
+ *
+ * @param log a pointer to a recording
+ * @param scene the scene being recorded
+ * @param tick how many ticks have been simulated
+ */
+void shot_log_observe(shot_log_t *log, scene_t *scene, uint32_t tick);
+
+/**
+ * Sets how many ticks were simulated in total, so a replay stops in the same place.
+ *
+ * @param log a pointer to a recording returned from shot_log_init()
+ * @param ticks the number of ticks, at least the tick of the last event
+ */
+void shot_log_set_ticks(shot_log_t *log, uint32_t ticks);
+
+/**
+ * Gets the number of placements and shots in a recording.
+ */
+size_t shot_log_size(shot_log_t *log);
+
+/**
+ * Gets a placement or shot from a recording, in the order they were added.
+ *
+ * @param log a pointer to a recording
+ * @param index the index of the event, less than shot_log_size()
+ */
+shot_event_t shot_log_get(shot_log_t *log, size_t index);
+
+/**
+ * Gets the number of shots in a recording, not counting placements.
+ */
+size_t shot_log_shots(shot_log_t *log);
+
+/**
+ * Gets the number of times the table was saved.
+ */
+size_t shot_log_snapshots(shot_log_t *log);
+
+/**
+ * Gets the seed passed to shot_log_init().
+ */
+unsigned int shot_log_get_seed(shot_log_t *log);
+
+/**
+ * Gets the tick length passed to shot_log_init().
+ */
+double shot_log_get_dt(shot_log_t *log);
+
+/**
+ * Gets the total number of ticks passed to shot_log_set_ticks(),
+ * or the tick of the last event if it was never called.
+ */
+uint32_t shot_log_get_ticks(shot_log_t *log);
+
+/**
+ * Writes a recording to a file in a compact binary format.
+ * Each event starts with a varint of the ticks since the previous one and its type.
+ * A placement then takes its position, and a shot its angle, power and any pull back,
+ * where positions in whole pixels, powers from key presses and whole pull backs
+ * take 2 or 3 bytes each (see write_compact_double()), and the angle 8.
+ * A shot usually takes about 12 bytes.
+ * Each saved table takes about 110 bytes: the ball positions, 3 bytes each
+ * since they were rounded to thousandths, the players, what was colliding
+ * and the contact state between balls that were touching.
+ *
+ * @param log a pointer to a recording
+ * @param path the file to write
+ * @return whether the whole recording was written
+ */
+bool shot_log_save(shot_log_t *log, const char *path);
+
+/**
+ * Reads a recording written by shot_log_save().
+ *
+ * @param path the file to read
+ * @return the recording, or NULL if the file could not be read or is not a recording
+ */
+shot_log_t *shot_log_load(const char *path);
+
+/**
+ * Racks the table a recording started from.
+ * Calls srand() with the recording's seed.
+ * The replay saves the table into the recording as it goes, the same way the game did,
+ * so seeking back is fast even if the file had no saved tables.
+ *
+ * @param log a pointer to a recording, which must outlive the replay
+ * @return the new replay, before any ticks
+ */
+shot_replay_t *shot_replay_init(shot_log_t *log);
+
+/**
+ * Releases the memory allocated for a replay and its scene.
+ *
+ * @param replay a pointer to a replay returned from shot_replay_init()
+ */
+void shot_replay_free(shot_replay_t *replay);
+
+/**
+ * Gets the scene a replay is played on.
+ */
+scene_t *shot_replay_get_scene(shot_replay_t *replay);
+
+/**
+ * Gets how many ticks a replay has simulated.
+ */
+uint32_t shot_replay_get_tick(shot_replay_t *replay);
+
+/**
+ * Simulates one tick, after taking any placements and shots stamped with the current tick.
+ *
+ * @param replay a pointer to a replay returned from shot_replay_init()
+ */
+void shot_replay_step(shot_replay_t *replay);
+
+/**
+ * Puts a replay's scene where the game was after a number of ticks,
+ * starting from the last saved table before then,
+ * or carrying on from where the replay is if that is closer.
+ *
+ * @param replay a pointer to a replay returned from shot_replay_init()
+ * @param tick the number of ticks to have simulated
+ */
+void shot_replay_seek(shot_replay_t *replay, uint32_t tick);
+
+#endif // #ifndef __SHOT_LOG_H__
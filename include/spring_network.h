@@ -0,0 +1,64 @@
+#ifndef __SPRING_NETWORK_H__
+#define __SPRING_NETWORK_H__
+
+#include "body.h"
+#include "scene.h"
+
+/**
+ * A set of springs between bodies that are integrated together implicitly.
+ * Each spring pulls its bodies together like create_spring(),
+ * but every tick the springs' forces are solved for with a backward Euler
+ * step, a sparse linear system solved with conjugate gradients.
+ * This stays stable for spring constants far too stiff
+ * for create_spring() at the same dt.
+ * Bodies with a mass of DBL_MAX are held fixed, as body_tick() does.
+ */
+typedef struct spring_network spring_network_t;
+
+/**
+ * Allocates memory for a network with no springs.
+ *
+ * @return the new network
+ */
+spring_network_t *spring_network_init(void);
+
+/**
+ * Releases the memory allocated for a network.
+ * Only call this on a network that was not passed to create_spring_network().
+ *
+ * @param network a pointer to a network returned from spring_network_init()
+ */
+void spring_network_free(spring_network_t *network);
+
+/**
+ * Adds a body to a network, so springs can be attached to it.
+ * Add each body once, and keep the index it is given.
+ *
+ * @param network a pointer to a network returned from spring_network_init()
+ * @param body the body to add
+ * @return the body's index in the network, for spring_network_add()
+ */
+size_t spring_network_add_body(spring_network_t *network, body_t *body);
+
+/**
+ * Adds a spring between two bodies in a network.
+ *
+ * @param network a pointer to a network returned from spring_network_init()
+ * @param k the Hooke's constant for the spring
+ * @param body1 the index of the first body, see spring_network_add_body()
+ * @param body2 the index of the second body
+ */
+void spring_network_add(spring_network_t *network, double k, size_t body1, size_t body2);
+
+/**
+ * Adds a force creator to a scene that applies the forces of a whole
+ * spring network each tick.
+ * The scene takes ownership of the network.
+ * If any of its bodies is removed, the force creator is removed too.
+ *
+ * @param scene the scene containing the bodies
+ * @param network a pointer to a network returned from spring_network_init()
+ */
+void create_spring_network(scene_t *scene, spring_network_t *network);
+
+#endif // #ifndef __SPRING_NETWORK_H__
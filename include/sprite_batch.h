@@ -0,0 +1,120 @@
+#ifndef __SPRITE_BATCH_H__
+#define __SPRITE_BATCH_H__
+
+#include <stddef.h>
+#include <SDL2/SDL.h>
+#include "asset_pack.h"
+#include "vector.h"
+
+/**
+ * A set of images packed into one texture, so that
+ * any number of them can be drawn with a single sprite batch.
+ * Sprites are numbered in the order their files were given.
+ */
+typedef struct sprite_atlas sprite_atlas_t;
+
+/**
+ * Sprites queued up to be drawn from one texture in one SDL_RenderGeometry call.
+ * The vertex arrays grow as needed and are kept between frames,
+ * so a batch that is reused every frame stops allocating after the first.
+ */
+typedef struct sprite_batch sprite_batch_t;
+
+/**
+ * Loads images and packs them into a texture, in rows.
+ * Images found in the asset pack are used as they are; the rest are decoded from their files.
+ * Asserts that every image could be loaded.
+ *
+ * @param renderer the renderer the atlas will be drawn with
+ * @param files the paths of the images
+ * @param count the number of images
+ * @param pack an asset pack holding decoded images, or NULL to decode every file
+ * @return the new atlas
+ */
+sprite_atlas_t *sprite_atlas_init(
+    SDL_Renderer *renderer, const char *const *files, size_t count, asset_pack_t *pack
+);
+
+/**
+ * Releases an atlas and its texture.
+ *
+ * @param atlas a pointer to an atlas returned from sprite_atlas_init()
+ */
+void sprite_atlas_free(sprite_atlas_t *atlas);
+
+/**
+ * Gets the texture holding every sprite in an atlas.
+ *
+ * @param atlas a pointer to an atlas returned from sprite_atlas_init()
+ */
+SDL_Texture *sprite_atlas_get_texture(sprite_atlas_t *atlas);
+
+/**
+ * Gets where a sprite is in its atlas's texture, in pixels.
+ *
+ * @param atlas a pointer to an atlas returned from sprite_atlas_init()
+ * @param sprite the number of the sprite
+ */
+SDL_Rect sprite_atlas_get_rect(sprite_atlas_t *atlas, size_t sprite);
+
+/**
+ * Allocates an empty batch that draws from a texture.
+ *
+ * @param texture the texture every sprite in the batch comes from;
+ *   the batch does not take ownership of it
+ * @return the new batch
+ */
+sprite_batch_t *sprite_batch_init(SDL_Texture *texture);
+
+/**
+ * Releases the memory allocated for a batch.
+ *
+ * @param batch a pointer to a batch returned from sprite_batch_init()
+ */
+void sprite_batch_free(sprite_batch_t *batch);
+
+/**
+ * Empties a batch so it can be filled for the next frame.
+ *
+ * @param batch a pointer to a batch returned from sprite_batch_init()
+ */
+void sprite_batch_clear(sprite_batch_t *batch);
+
+/**
+ * Queues part of the batch's texture to be drawn, rotated about its center.
+ * Sprites are drawn in the order they were added.
+ *
+ * @param batch a pointer to a batch returned from sprite_batch_init()
+ * @param src the part of the texture to draw, in pixels
+ * @param center where the center of the sprite goes on screen, in pixels
+ * @param angle how far to turn the sprite clockwise on screen, in radians
+ */
+void sprite_batch_add(sprite_batch_t *batch, SDL_Rect src, vector_t center, double angle);
+
+/**
+ * Queues part of the batch's texture to be copied to a rectangle on screen,
+ * like SDL_RenderCopy() would.
+ *
+ * @param batch a pointer to a batch returned from sprite_batch_init()
+ * @param src the part of the texture to draw, in pixels
+ * @param dst where to draw it on screen, in pixels
+ */
+void sprite_batch_add_rect(sprite_batch_t *batch, SDL_Rect src, SDL_Rect dst);
+
+/**
+ * Gets the number of sprites queued in a batch.
+ *
+ * @param batch a pointer to a batch returned from sprite_batch_init()
+ */
+size_t sprite_batch_size(sprite_batch_t *batch);
+
+/**
+ * Draws every queued sprite with one SDL_RenderGeometry call.
+ * The batch keeps its sprites, so call sprite_batch_clear() before refilling it.
+ *
+ * @param batch a pointer to a batch returned from sprite_batch_init()
+ * @param renderer the renderer to draw with
+ */
+void sprite_batch_draw(sprite_batch_t *batch, SDL_Renderer *renderer);
+
+#endif // #ifndef __SPRITE_BATCH_H__
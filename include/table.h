@@ -0,0 +1,264 @@
+#ifndef __TABLE_H__
+#define __TABLE_H__
+
+#include <stdbool.h>
+#include "color.h"
+#include "list.h"
+#include "scene.h"
+#include "vector.h"
+
+/**
+ * The pool table: cushions, pockets, the rack and the cue,
+ * plus the game state machine that runs between shots.
+ * None of this depends on SDL, so it can be driven headlessly.
+ */
+
+/**
+ * The number of balls on the table, including the cue ball (ball 0).
+ */
+extern const int NUM_BALLS;
+
+/**
+ * How quickly friction slows the balls, see create_group_friction().
+ */
+extern const double FRICTION_CONST;
+
+// Sizes of the arrays in table_state_t.
+// Each ball can collide with the 6 cushions and the 6 pockets,
+// and the cue can collide with the cue ball.
+// Every pair of balls is a contact in the scene's contact solver.
+#define TABLE_BALLS 16
+#define TABLE_PLAYERS 2
+#define TABLE_COLLISIONS (TABLE_BALLS * 12 + 1)
+#define TABLE_CONTACTS (TABLE_BALLS * (TABLE_BALLS - 1) / 2)
+#define TABLE_POCKETS 6
+#define TABLE_CUSHIONS 6
+
+/**
+ * Where a body is and how fast it is moving.
+ */
+typedef struct {
+    vector_t position;
+    vector_t velocity;
+} body_state_t;
+
+/**
+ * Everything that changes on a table during a game,
+ * so a table can be copied or put back exactly as it was.
+ * Saved with table_save() and restored with table_load().
+ */
+typedef struct {
+    int state;
+    int turn;
+    body_state_t balls[TABLE_BALLS];
+    bool has_cue;
+    body_state_t cue;
+    double cue_angle;
+    int turn_states[TABLE_PLAYERS];
+    int fouls[TABLE_PLAYERS];
+    /** The numbers of the balls each player has sunk, in order */
+    int sunk[TABLE_PLAYERS][TABLE_BALLS];
+    int num_sunk[TABLE_PLAYERS];
+    /** See scene_get_collision_flags() */
+    bool collision_flags[TABLE_COLLISIONS];
+    /** See contact_solver_get_impulses() */
+    double contact_impulses[TABLE_CONTACTS];
+} table_state_t;
+
+/**
+ * The bottom left and top right corners of the area
+ * the cue ball can be placed in after a scratch.
+ */
+extern const vector_t KITCHEN[];
+
+/**
+ * Where the cue ball starts at the beginning of a game.
+ */
+extern const vector_t CUE_BALL_START;
+
+/**
+ * Gets the middle of one of the pockets, i.e. where to send a ball to sink it.
+ *
+ * @param pocket the number of the pocket, less than TABLE_POCKETS
+ */
+vector_t table_get_pocket(size_t pocket);
+
+/**
+ * Gets the body the balls fall into at a pocket.
+ *
+ * @param scene a scene set up with populate_scene() or table_scene_init()
+ * @param pocket the number of the pocket, less than TABLE_POCKETS,
+ *   numbered the same as for table_get_pocket()
+ */
+body_t *table_get_pocket_body(scene_t *scene, size_t pocket);
+
+/**
+ * Gets one of the cushions the balls bounce off.
+ *
+ * @param scene a scene set up with populate_scene() or table_scene_init()
+ * @param cushion the number of the cushion, less than TABLE_CUSHIONS
+ */
+body_t *table_get_cushion(scene_t *scene, size_t cushion);
+
+/**
+ * Adds the cushions, pockets, both players and a randomly swapped rack
+ * to an empty scene. The rack is shuffled with rand(),
+ * so seed with srand() beforehand for a reproducible table.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+void populate_scene(scene_t *scene);
+
+/**
+ * Allocates a scene with a table and an unshuffled rack,
+ * for loading a saved table into with table_load().
+ * Does not call rand(), so it is safe to call from any thread.
+ *
+ * @return the new scene
+ */
+scene_t *table_scene_init(void);
+
+/**
+ * Saves the state of a table.
+ * Should be called between ticks, e.g. after update_game_state().
+ *
+ * @param scene a scene set up with populate_scene() or table_scene_init()
+ * @param state where to save the table
+ */
+void table_save(scene_t *scene, table_state_t *state);
+
+/**
+ * Puts a table back into a saved state, adding or removing the cue as needed.
+ * After this, ticking the scene gives the same results
+ * as ticking the scene the state was saved from.
+ *
+ * @param scene a scene set up with populate_scene() or table_scene_init()
+ * @param state the table to restore
+ */
+void table_load(scene_t *scene, const table_state_t *state);
+
+/**
+ * Adds the cue behind the cue ball, pointing along the positive x axis.
+ * The cue is removed when it hits the cue ball.
+ *
+ * @param scene a scene set up with populate_scene()
+ * @param col unused, kept for symmetry with the other scene builders
+ */
+void scene_add_cue(scene_t *scene, rgb_color_t col);
+
+/**
+ * Returns whether any ball on the table is still moving.
+ *
+ * @param balls the scene's list of balls (see scene_get_balls())
+ * @return true if any ball has a nonzero velocity
+ */
+bool balls_moving(list_t *balls);
+
+/**
+ * Advances the game state machine once the balls have come to rest:
+ * adds the cue back while FIRING and decides the next turn while SETTLING.
+ * Should be called once after every scene_tick().
+ *
+ * @param scene a scene set up with populate_scene()
+ */
+void update_game_state(scene_t *scene);
+
+/**
+ * Moves every sunk ball into its owner's rack next to the table.
+ * The player whose turn it is has their rack at the top.
+ * Should be called after update_game_state().
+ *
+ * @param scene a scene set up with populate_scene()
+ */
+void table_park_sunk_balls(scene_t *scene);
+
+/**
+ * Places the cue ball while PLACING and moves the game on to FIRING.
+ * Does nothing if the position is outside the kitchen.
+ *
+ * @param scene a scene set up with populate_scene()
+ * @param position the new centroid of the cue ball
+ * @return whether the cue ball was placed
+ */
+bool table_place_cue_ball(scene_t *scene, vector_t position);
+
+/**
+ * Returns the cue if it is on the table, or NULL if it is not.
+ *
+ * @param scene a scene set up with populate_scene()
+ */
+body_t *table_get_cue(scene_t *scene);
+
+/**
+ * Rotates the cue about the cue ball.
+ *
+ * @param scene a scene with a cue on the table
+ * @param angle the absolute angle of the cue in radians;
+ *   the cue ball is struck in the direction angle + pi
+ */
+void table_aim(scene_t *scene, double angle);
+
+/**
+ * Gets how far the cue has been pulled back from the cue ball, e.g. by winding up a shot,
+ * past where table_aim() puts it.
+ *
+ * @param scene a scene with a cue on the table
+ */
+double table_get_cue_pull_back(scene_t *scene);
+
+/**
+ * Replaces the cue with a new one at rest, aimed with table_aim() and then pulled back.
+ * Where the new cue is only depends on the cue ball, the angle and the distance,
+ * not on the rounding errors of however the old cue was moved,
+ * so a shot recorded as its angle, pull back and power can be struck again exactly.
+ * A cue that was added and then only aimed with table_aim() is already
+ * where this puts it with a pull back of 0.
+ *
+ * @param scene a scene with a cue on the table
+ * @param angle the angle of the cue, see table_aim()
+ * @param pull_back how far the cue is pulled back, see table_get_cue_pull_back()
+ */
+void table_set_cue(scene_t *scene, double angle, double pull_back);
+
+/**
+ * Sends the cue into the cue ball and moves the game on to SETTLING.
+ *
+ * @param scene a scene with a cue on the table
+ * @param power how long the shot was wound up for, in seconds
+ */
+void table_shoot(scene_t *scene, double power);
+
+/**
+ * Gets how fast the cue ball leaves the cue for a shot of a given power.
+ *
+ * @param scene a scene set up with populate_scene()
+ * @param power the power of the shot, see table_shoot()
+ * @return the speed of the cue ball just after the cue hits it
+ */
+double table_get_shot_speed(scene_t *scene, double power);
+
+/**
+ * Takes a shot while FIRING and ticks the scene until the balls stop
+ * and update_game_state() has decided what happens next.
+ * The cue is brought back first if it is not on the table.
+ *
+ * @param scene a scene in the FIRING state with all balls at rest
+ * @param angle the angle of the cue, see table_aim()
+ * @param power the power of the shot, see table_shoot()
+ * @param dt the length of each tick, in seconds
+ * @param max_ticks gives up after this many ticks,
+ *   leaving the scene in the SETTLING state
+ * @return the number of ticks taken
+ */
+int table_play_shot(scene_t *scene, double angle, double power, double dt, int max_ticks);
+
+/**
+ * Adds up the balls' positions, weighted by number so swapped balls are noticed.
+ * Two tables played the same way have the same checksum, bit for bit.
+ *
+ * @param scene a scene set up with populate_scene() or table_scene_init()
+ * @return the checksum
+ */
+double table_ball_checksum(scene_t *scene);
+
+#endif // #ifndef __TABLE_H__
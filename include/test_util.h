@@ -43,7 +43,7 @@ bool within(double epsilon, double d1, double d2);
  * Returns whether two vectors are nearly equal,
  * where the acceptable difference of each component is specified by epsilon.
  */
-bool vec_within(double epsilon, vector_t v1, vector_t v2);
+bool vec_within_epsilon(double epsilon, vector_t v1, vector_t v2);
 
 /**
  * Open the file 'filename', read one word into 'testname', and close the file.
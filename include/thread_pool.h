@@ -0,0 +1,60 @@
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include <stddef.h>
+
+/**
+ * A fixed set of worker threads that run batches of independent tasks.
+ * The threads are started once and reused for every batch,
+ * so handing out work costs a lock rather than a thread creation.
+ */
+typedef struct thread_pool thread_pool_t;
+
+/**
+ * A task run by the thread pool.
+ *
+ * @param aux the auxiliary value passed to thread_pool_run()
+ * @param index which task to run, from 0 up to the number of tasks
+ * @param worker which worker is running the task, from 0 up to the size
+ *   of the pool. A worker only runs one task at a time, so this can be used
+ *   to index per-thread scratch space.
+ */
+typedef void (*task_func_t)(void *aux, size_t index, size_t worker);
+
+/**
+ * Allocates a thread pool and starts its workers.
+ * The thread calling thread_pool_run() counts as one of the workers.
+ * Asserts that the threads were started.
+ *
+ * @param workers the number of workers, at least 1
+ * @return the new thread pool
+ */
+thread_pool_t *thread_pool_init(size_t workers);
+
+/**
+ * Gets the number of workers in a thread pool.
+ *
+ * @param pool a pointer to a thread pool returned from thread_pool_init()
+ * @return the number of workers passed to thread_pool_init()
+ */
+size_t thread_pool_size(thread_pool_t *pool);
+
+/**
+ * Runs count tasks across the workers and waits for all of them to finish.
+ * Tasks are handed out in order of index as workers become free.
+ *
+ * @param pool a pointer to a thread pool returned from thread_pool_init()
+ * @param task the function to call for each task
+ * @param aux an auxiliary value to pass to each task
+ * @param count the number of tasks to run
+ */
+void thread_pool_run(thread_pool_t *pool, task_func_t task, void *aux, size_t count);
+
+/**
+ * Stops the workers and releases the memory allocated for a thread pool.
+ *
+ * @param pool a pointer to a thread pool returned from thread_pool_init()
+ */
+void thread_pool_free(thread_pool_t *pool);
+
+#endif // #ifndef __THREAD_POOL_H__
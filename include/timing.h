@@ -0,0 +1,26 @@
+#ifndef __TIMING_H__
+#define __TIMING_H__
+
+#include <time.h>
+
+/**
+ * Measures how long things take with the monotonic clock,
+ * which never jumps when the system time is changed.
+ */
+
+/**
+ * Reads the monotonic clock, to pass to seconds_since() later.
+ *
+ * @return the time now
+ */
+struct timespec timing_now(void);
+
+/**
+ * Gets how long it has been since a time read with timing_now().
+ *
+ * @param start the time to measure from
+ * @return the seconds since start
+ */
+double seconds_since(struct timespec start);
+
+#endif // #ifndef __TIMING_H__
@@ -0,0 +1,131 @@
+#ifndef __TRANSPORT_H__
+#define __TRANSPORT_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "list.h"
+
+/**
+ * An unreliable way of sending packets to one other player, like UDP:
+ * packets may be lost or arrive late, but are never corrupted.
+ * Any transport can be plugged in by giving its send and receive functions.
+ */
+typedef struct transport transport_t;
+
+/**
+ * Two transports connected to each other in the same process,
+ * which delay and drop packets on purpose, for testing.
+ */
+typedef struct loopback loopback_t;
+
+/**
+ * The largest packet a transport has to carry, in bytes.
+ */
+#define TRANSPORT_MAX_PACKET 2048
+
+/**
+ * Sends a packet, without waiting for it to arrive.
+ *
+ * @param aux the auxiliary value passed to transport_init()
+ * @param data the packet
+ * @param size the size of the packet, at most TRANSPORT_MAX_PACKET
+ */
+typedef void (*transport_send_t)(void *aux, const uint8_t *data, size_t size);
+
+/**
+ * Takes the next packet that has arrived, without waiting for one.
+ *
+ * @param aux the auxiliary value passed to transport_init()
+ * @param buffer where to copy the packet
+ * @param capacity the size of the buffer, at least TRANSPORT_MAX_PACKET
+ * @return the size of the packet, or 0 if none has arrived
+ */
+typedef size_t (*transport_receive_t)(void *aux, uint8_t *buffer, size_t capacity);
+
+/**
+ * Allocates a transport from the functions that send and receive its packets.
+ *
+ * @param sender the function that sends a packet
+ * @param receiver the function that takes an arrived packet
+ * @param aux the value to pass to sender and receiver
+ * @param freer if non-NULL, a function to call on aux in transport_free()
+ * @return the new transport
+ */
+transport_t *transport_init(
+    transport_send_t sender,
+    transport_receive_t receiver,
+    void *aux,
+    free_func_t freer
+);
+
+/**
+ * Releases the memory allocated for a transport, and its aux value if it has a freer.
+ *
+ * @param transport a pointer to a transport returned from transport_init()
+ */
+void transport_free(transport_t *transport);
+
+/**
+ * Sends a packet, see transport_send_t.
+ */
+void transport_send(transport_t *transport, const uint8_t *data, size_t size);
+
+/**
+ * Takes the next packet that has arrived, see transport_receive_t.
+ */
+size_t transport_receive(transport_t *transport, uint8_t *buffer, size_t capacity);
+
+/**
+ * Opens a UDP socket that sends to and receives from one address,
+ * for playing against another process, e.g. on localhost.
+ * Packets from any other address are ignored.
+ *
+ * @param local_port the port to receive on
+ * @param host the IPv4 address of the other player, e.g. "127.0.0.1"
+ * @param remote_port the port the other player receives on
+ * @return the transport, or NULL if the socket could not be opened
+ */
+transport_t *transport_udp_init(uint16_t local_port, const char *host, uint16_t remote_port);
+
+/**
+ * Allocates a pair of transports connected to each other.
+ * Packets only arrive once the loopback has been ticked latency times after they were sent,
+ * so the delay is the same whatever the speed of the machine.
+ *
+ * @param latency how many calls to loopback_tick() a packet takes to arrive
+ * @param loss the probability that a packet is lost, from 0 to 1
+ * @param seed the seed for deciding which packets are lost
+ * @return the new loopback
+ */
+loopback_t *loopback_init(uint32_t latency, double loss, uint64_t seed);
+
+/**
+ * Frees a loopback, its transports and any packets still on the way.
+ *
+ * @param loopback a pointer to a loopback returned from loopback_init()
+ */
+void loopback_free(loopback_t *loopback);
+
+/**
+ * Gets one end of a loopback. Packets sent on one end are received on the other.
+ * The transport belongs to the loopback and must not be freed.
+ *
+ * @param loopback a pointer to a loopback returned from loopback_init()
+ * @param end 0 or 1
+ */
+transport_t *loopback_get_end(loopback_t *loopback, int end);
+
+/**
+ * Moves the loopback's clock on by one, delivering the packets that are due.
+ *
+ * @param loopback a pointer to a loopback returned from loopback_init()
+ */
+void loopback_tick(loopback_t *loopback);
+
+/**
+ * Gets how many packets a loopback has carried and how many it dropped.
+ */
+void loopback_get_counts(loopback_t *loopback, size_t *sent, size_t *lost);
+
+#endif // #ifndef __TRANSPORT_H__
@@ -0,0 +1,353 @@
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ai.h"
+#include "ball.h"
+#include "player.h"
+#include "rng.h"
+#include "table.h"
+#include "timing.h"
+
+const size_t AI_DEFAULT_SHOTS = 4096;
+const double AI_DEFAULT_SECONDS = 2.0;
+// Candidates are screened this many at a time, and the clock is checked in between
+#define ROUND_SHOTS 64
+// How many of the best screened shots are played out in full
+#define FINALISTS 8
+// How many places to try the cue ball from when it can be placed anywhere in the kitchen
+#define PLACEMENTS 4
+// How long the balls are simulated for when screening a shot
+const double SCREEN_SECONDS = 1.5;
+// The longest a shot is simulated for when it is played out in full
+const double FULL_SECONDS = 60;
+// The powers aimed shots are tried at, see table_shoot()
+const double POWERS[] = {0.8, 1.3, 1.9};
+const double MIN_POWER = 0.5;
+const double MAX_POWER = 2.0;
+// Cutting a ball thinner than this rarely sinks it, so such shots are not aimed
+const double MAX_CUT = 75 * M_PI / 180;
+// How far refined shots stray from the shot they refine
+const double ANGLE_SPREAD = 0.03;
+const double POWER_SPREAD = 0.15;
+// How much of each refining round is spent on completely random shots
+const size_t RANDOM_SHOTS_PER_ROUND = ROUND_SHOTS / 4;
+const double WIN_SCORE = 1000;
+const double POT_SCORE = 10;
+const double KEEP_TURN_SCORE = 15;
+const double FOUL_PENALTY = 20;
+const double SCRATCH_PENALTY = 40;
+const uint16_t SOLIDS = 0xfe & ~(1 << 8);
+const uint16_t STRIPES = 0xfe00;
+const int EIGHT_BALL = 8;
+// Every search starts its random numbers from here, so it only depends on the table
+const uint64_t SEARCH_SEED = 0x9e3779b97f4a7c15;
+
+/**
+ * A shot that has been tried, and how good it looked.
+ */
+typedef struct candidate {
+    shot_t shot;
+    double score;
+} candidate_t;
+
+typedef struct ai {
+    batch_t *batch;
+    double dt;
+    size_t max_shots;
+    double seconds;
+    uint64_t rng;
+    ai_stats_t stats;
+    // shots waiting to be screened
+    shot_t *queue;
+    size_t queued;
+    size_t queue_capacity;
+    // the best screened shots, best first
+    candidate_t finalists[FINALISTS];
+    size_t num_finalists;
+    shot_t round[ROUND_SHOTS];
+    shot_outcome_t outcomes[ROUND_SHOTS];
+} ai_t;
+
+ai_t *ai_init(size_t threads, double dt, size_t max_shots, double seconds) {
+    assert(dt > 0 && max_shots > 0 && seconds >= 0);
+    ai_t *ai = malloc(sizeof(ai_t));
+    assert(ai != NULL);
+    ai->batch = batch_init(threads);
+    ai->dt = dt;
+    ai->max_shots = max_shots;
+    ai->seconds = seconds;
+    ai->stats = (ai_stats_t) {0};
+    ai->queue_capacity = ROUND_SHOTS;
+    ai->queue = malloc(sizeof(shot_t) * ai->queue_capacity);
+    assert(ai->queue != NULL);
+    return ai;
+}
+
+void ai_free(ai_t *ai) {
+    batch_free(ai->batch);
+    free(ai->queue);
+    free(ai);
+}
+
+bool ai_has_turn(scene_t *scene) {
+    int state = scene_get_state(scene);
+    if (state != PLACING && state != FIRING) {
+        return false;
+    }
+    player_t *shooter = scene_get_player(scene, scene_get_turn(scene));
+    return player_is_computer(shooter) && !balls_moving(scene_get_balls(scene));
+}
+
+// Keeps a power to one space could be held for: in range and a whole number of
+// milliseconds, which is also what a shot log stores compactly
+double clamp_power(double power) {
+    power = round(power * 1000) / 1000;
+    return power < MIN_POWER ? MIN_POWER : power > MAX_POWER ? MAX_POWER : power;
+}
+
+int count_balls(uint16_t mask) {
+    int count = 0;
+    for (; mask != 0; mask &= mask - 1) {
+        count++;
+    }
+    return count;
+}
+
+double score_outcome(const shot_outcome_t *outcome, const turn_t *turn) {
+    int potted = count_balls(outcome->sunk & turn->own);
+    if (outcome->state == GAME_OVER_1 || outcome->state == GAME_OVER_2) {
+        bool won = (outcome->state == GAME_OVER_1) == (turn->shooter == 0);
+        return won ? WIN_SCORE : -WIN_SCORE;
+    }
+    if (outcome->sunk & (1 << EIGHT_BALL)) {
+        // Sinking the 8 ball wins only once the shooter's other 7 balls are down
+        return turn->own_before + potted == 7 ? WIN_SCORE : -WIN_SCORE;
+    }
+    double score = POT_SCORE * potted;
+    if (outcome->scratch) {
+        score -= SCRATCH_PENALTY;
+    }
+    if (outcome->foul) {
+        score -= FOUL_PENALTY;
+    }
+    bool keeps_turn = outcome->state == SETTLING
+        ? potted > 0 && !outcome->scratch && !outcome->foul
+        : outcome->state == FIRING && outcome->turn == turn->shooter;
+    if (keeps_turn) {
+        score += KEEP_TURN_SCORE;
+    }
+    return score;
+}
+
+void queue_shot(ai_t *ai, shot_t shot) {
+    if (ai->queued == ai->queue_capacity) {
+        ai->queue_capacity *= 2;
+        ai->queue = realloc(ai->queue, sizeof(shot_t) * ai->queue_capacity);
+        assert(ai->queue != NULL);
+    }
+    ai->queue[ai->queued++] = shot;
+}
+
+/**
+ * Keeps a screened shot if it is among the best so far.
+ * Ties go to the shot screened first.
+ */
+void consider(ai_t *ai, shot_t shot, double score) {
+    size_t i = ai->num_finalists;
+    if (i == FINALISTS) {
+        if (score <= ai->finalists[FINALISTS - 1].score) return;
+        i--;
+    }
+    else {
+        ai->num_finalists++;
+    }
+    for (; i > 0 && ai->finalists[i - 1].score < score; i--) {
+        ai->finalists[i] = ai->finalists[i - 1];
+    }
+    ai->finalists[i] = (candidate_t) {shot, score};
+}
+
+/**
+ * Returns whether a ball could be put at a point without touching a ball on the table.
+ */
+bool spot_free(const table_state_t *table, uint16_t on_table, vector_t spot, double radius) {
+    for (int i = 1; i < TABLE_BALLS; i++) {
+        if ((on_table & (1 << i))
+            && vec_magnitude(vec_subtract(table->balls[i].position, spot)) < 2 * radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Queues the shots that send the cue ball at a target ball so it heads for a pocket,
+ * aiming where the cue ball has to be when they touch.
+ */
+void queue_aimed_shots(ai_t *ai, const table_state_t *table, vector_t cue_ball,
+                       uint16_t targets, double radius) {
+    for (int ball = 1; ball < TABLE_BALLS; ball++) {
+        if (!(targets & (1 << ball))) continue;
+        vector_t target = table->balls[ball].position;
+        for (size_t pocket = 0; pocket < TABLE_POCKETS; pocket++) {
+            vector_t to_pocket = vec_normalize(vec_subtract(table_get_pocket(pocket), target));
+            vector_t contact = vec_subtract(target, vec_multiply(2 * radius, to_pocket));
+            vector_t aim = vec_subtract(contact, cue_ball);
+            double aim_distance = vec_magnitude(aim);
+            if (aim_distance == 0 || vec_dot(aim, to_pocket) < aim_distance * cos(MAX_CUT)) {
+                continue;
+            }
+            for (size_t i = 0; i < sizeof(POWERS) / sizeof(POWERS[0]); i++) {
+                // The cue points away from where the cue ball is sent
+                shot_t shot = {atan2(aim.y, aim.x) + M_PI, POWERS[i], cue_ball};
+                queue_shot(ai, shot);
+            }
+        }
+    }
+}
+
+shot_t random_shot(ai_t *ai, vector_t cue_ball) {
+    return (shot_t) {rng_between(&ai->rng, 0, 2 * M_PI), clamp_power(rng_between(&ai->rng, MIN_POWER, MAX_POWER)), cue_ball};
+}
+
+/**
+ * Queues a round of shots near the best ones so far, plus some random ones.
+ */
+void queue_refinements(ai_t *ai, size_t round, const vector_t *placements, size_t num_placements) {
+    // Stray less from the best shots the longer the search goes on
+    double narrowing = 1.0 / (1 + round);
+    for (size_t i = 0; i < ROUND_SHOTS - RANDOM_SHOTS_PER_ROUND && ai->num_finalists > 0; i++) {
+        shot_t shot = ai->finalists[i % ai->num_finalists].shot;
+        shot.angle += rng_between(&ai->rng, -ANGLE_SPREAD, ANGLE_SPREAD) * narrowing;
+        shot.power = clamp_power(shot.power * (1 + rng_between(&ai->rng, -POWER_SPREAD, POWER_SPREAD) * narrowing));
+        queue_shot(ai, shot);
+    }
+    while (ai->queued < ROUND_SHOTS) {
+        size_t placement = (size_t)(rng_unit(&ai->rng) * num_placements);
+        queue_shot(ai, random_shot(ai, placements[placement]));
+    }
+}
+
+shot_t ai_choose_shot(ai_t *ai, scene_t *scene) {
+    assert(ai_has_turn(scene));
+    struct timespec start = timing_now();
+    table_state_t table;
+    table_save(scene, &table);
+    player_t *shooter = scene_get_player(scene, table.turn);
+    turn_t turn = {
+        .shooter = table.turn,
+        .own = strcmp(player_get_info(shooter), "solid") == 0 ? SOLIDS : STRIPES,
+        .own_before = table.num_sunk[table.turn]
+    };
+    uint16_t on_table = 0xffff;
+    for (int p = 0; p < TABLE_PLAYERS; p++) {
+        for (int i = 0; i < table.num_sunk[p]; i++) {
+            on_table &= ~(1 << table.sunk[p][i]);
+        }
+    }
+    // Go for the 8 ball once the shooter's own balls are gone
+    uint16_t targets = turn.own & on_table;
+    if (targets == 0) {
+        targets = 1 << EIGHT_BALL;
+    }
+    double radius = ball_get_radius(list_get(scene_get_balls(scene), 0));
+
+    ai->rng = rng_seed(SEARCH_SEED);
+    // Where the cue ball may be shot from: where it is, or anywhere free in the kitchen
+    vector_t placements[PLACEMENTS];
+    size_t num_placements = 0;
+    if (table.state == FIRING) {
+        placements[num_placements++] = table.balls[0].position;
+    }
+    else {
+        if (spot_free(&table, on_table, CUE_BALL_START, radius)) {
+            placements[num_placements++] = CUE_BALL_START;
+        }
+        vector_t min = vec_add(KITCHEN[0], (vector_t){radius + 1, radius + 1});
+        vector_t max = vec_subtract(KITCHEN[1], (vector_t){1, radius + 1});
+        for (int tries = 0; num_placements < PLACEMENTS && tries < 16 * PLACEMENTS; tries++) {
+            vector_t spot = {rng_between(&ai->rng, min.x, max.x), rng_between(&ai->rng, min.y, max.y)};
+            if (spot_free(&table, on_table, spot, radius)) {
+                placements[num_placements++] = spot;
+            }
+        }
+        if (num_placements == 0) {
+            placements[num_placements++] = CUE_BALL_START;
+        }
+    }
+
+    ai->queued = 0;
+    ai->num_finalists = 0;
+    for (size_t i = 0; i < num_placements; i++) {
+        queue_aimed_shots(ai, &table, placements[i], targets, radius);
+    }
+
+    int screen_ticks = ceil(SCREEN_SECONDS / ai->dt);
+    size_t screened = 0, next = 0, round = 0;
+    while (screened < ai->max_shots && (screened == 0 || ai->seconds == 0
+                                        || seconds_since(start) < ai->seconds)) {
+        if (next == ai->queued) {
+            ai->queued = next = 0;
+            queue_refinements(ai, round, placements, num_placements);
+        }
+        size_t count = ai->queued - next;
+        if (count > ROUND_SHOTS) count = ROUND_SHOTS;
+        if (count > ai->max_shots - screened) count = ai->max_shots - screened;
+        memcpy(ai->round, &ai->queue[next], sizeof(shot_t) * count);
+        batch_run(ai->batch, &table, ai->round, ai->outcomes, count, ai->dt, screen_ticks);
+        for (size_t i = 0; i < count; i++) {
+            consider(ai, ai->round[i], score_outcome(&ai->outcomes[i], &turn));
+        }
+        next += count;
+        screened += count;
+        round++;
+    }
+
+    // Play the best few out to the end, so the chosen shot is judged on exactly what will happen
+    size_t finalists = ai->num_finalists;
+    for (size_t i = 0; i < finalists; i++) {
+        ai->round[i] = ai->finalists[i].shot;
+    }
+    batch_run(ai->batch, &table, ai->round, ai->outcomes, finalists, ai->dt,
+              ceil(FULL_SECONDS / ai->dt));
+    size_t best = 0;
+    double best_score = -INFINITY;
+    for (size_t i = 0; i < finalists; i++) {
+        double score = score_outcome(&ai->outcomes[i], &turn);
+        if (score > best_score) {
+            best = i;
+            best_score = score;
+        }
+    }
+    ai->stats = (ai_stats_t) {
+        .screened = screened,
+        .finalists = finalists,
+        .seconds = seconds_since(start),
+        .score = best_score
+    };
+    return ai->round[best];
+}
+
+void ai_play_shot(scene_t *scene, shot_t shot) {
+    // The same steps as the search took, see play_lane() and table_play_shot()
+    if (scene_get_state(scene) == PLACING) {
+        table_place_cue_ball(scene, shot.cue_ball);
+    }
+    update_game_state(scene);
+    table_aim(scene, shot.angle);
+    table_shoot(scene, shot.power);
+}
+
+bool ai_take_turn(ai_t *ai, scene_t *scene) {
+    if (!ai_has_turn(scene)) {
+        return false;
+    }
+    ai_play_shot(scene, ai_choose_shot(ai, scene));
+    return true;
+}
+
+ai_stats_t ai_get_stats(ai_t *ai) {
+    return ai->stats;
+}
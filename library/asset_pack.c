@@ -0,0 +1,181 @@
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "asset_pack.h"
+#include "list.h"
+
+const char ASSET_PACK_MAGIC[4] = {'P', 'P', 'A', 'K'};
+const uint32_t ASSET_PACK_VERSION = 1;
+// Written as is, so a pack from a machine with the other byte order is rejected
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+// Asset data starts on a multiple of this, so it can be read as any type
+const size_t DATA_ALIGNMENT = 16;
+
+/**
+ * The start of a pack file. The index follows straight after.
+ */
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t count;
+} pack_header_t;
+
+/**
+ * Where one asset is in a pack file.
+ */
+typedef struct {
+    char name[ASSET_NAME_LENGTH];
+    uint32_t kind;
+    int32_t width;
+    int32_t height;
+    uint32_t padding;
+    uint64_t offset;
+    uint64_t size;
+} pack_entry_t;
+
+typedef struct asset_pack {
+    void *map;
+    size_t length;
+    const pack_header_t *header;
+    const pack_entry_t *entries;
+} asset_pack_t;
+
+typedef struct asset_pack_writer {
+    list_t *entries;
+    list_t *data;
+} asset_pack_writer_t;
+
+asset_pack_t *asset_pack_open(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(pack_header_t)) {
+        close(fd);
+        return NULL;
+    }
+    size_t length = info.st_size;
+    void *map = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after the file is closed
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    const pack_header_t *header = map;
+    const pack_entry_t *entries = (const pack_entry_t *)(header + 1);
+    bool valid = memcmp(header->magic, ASSET_PACK_MAGIC, sizeof(ASSET_PACK_MAGIC)) == 0
+        && header->version == ASSET_PACK_VERSION
+        && header->byte_order == BYTE_ORDER_MARK
+        && header->count <= (length - sizeof(pack_header_t)) / sizeof(pack_entry_t);
+    for (uint32_t i = 0; valid && i < header->count; i++) {
+        const pack_entry_t *entry = &entries[i];
+        valid = memchr(entry->name, '\0', ASSET_NAME_LENGTH) != NULL
+            && entry->offset % DATA_ALIGNMENT == 0
+            && entry->offset <= length && entry->size <= length - entry->offset;
+    }
+    if (!valid) {
+        munmap(map, length);
+        return NULL;
+    }
+
+    asset_pack_t *pack = malloc(sizeof(asset_pack_t));
+    assert(pack != NULL);
+    pack->map = map;
+    pack->length = length;
+    pack->header = header;
+    pack->entries = entries;
+    return pack;
+}
+
+void asset_pack_close(asset_pack_t *pack) {
+    munmap(pack->map, pack->length);
+    free(pack);
+}
+
+const void *asset_pack_find(asset_pack_t *pack, const char *name, asset_kind_t kind,
+                            int *width, int *height, size_t *size) {
+    for (uint32_t i = 0; i < pack->header->count; i++) {
+        const pack_entry_t *entry = &pack->entries[i];
+        if (entry->kind == kind && strcmp(entry->name, name) == 0) {
+            if (width != NULL) *width = entry->width;
+            if (height != NULL) *height = entry->height;
+            if (size != NULL) *size = entry->size;
+            return (const char *)pack->map + entry->offset;
+        }
+    }
+    return NULL;
+}
+
+asset_pack_writer_t *asset_pack_writer_init(void) {
+    asset_pack_writer_t *writer = malloc(sizeof(asset_pack_writer_t));
+    assert(writer != NULL);
+    writer->entries = list_init(32, (free_func_t)free);
+    writer->data = list_init(32, (free_func_t)free);
+    return writer;
+}
+
+void asset_pack_writer_free(asset_pack_writer_t *writer) {
+    list_free(writer->entries);
+    list_free(writer->data);
+    free(writer);
+}
+
+void asset_pack_writer_add(asset_pack_writer_t *writer, const char *name, asset_kind_t kind,
+                           int width, int height, const void *data, size_t size) {
+    assert(strlen(name) < ASSET_NAME_LENGTH);
+    pack_entry_t *entry = calloc(1, sizeof(pack_entry_t));
+    void *copy = malloc(size > 0 ? size : 1);
+    assert(entry != NULL && copy != NULL);
+    strcpy(entry->name, name);
+    entry->kind = kind;
+    entry->width = width;
+    entry->height = height;
+    entry->size = size;
+    memcpy(copy, data, size);
+    list_add(writer->entries, entry);
+    list_add(writer->data, copy);
+}
+
+size_t align_up(size_t offset) {
+    return (offset + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+}
+
+bool asset_pack_writer_save(asset_pack_writer_t *writer, const char *path) {
+    size_t count = list_size(writer->entries);
+    pack_header_t header = {.version = ASSET_PACK_VERSION, .byte_order = BYTE_ORDER_MARK, .count = count};
+    memcpy(header.magic, ASSET_PACK_MAGIC, sizeof(ASSET_PACK_MAGIC));
+    // Lay out the data after the index
+    size_t offset = align_up(sizeof(pack_header_t) + count * sizeof(pack_entry_t));
+    for (size_t i = 0; i < count; i++) {
+        pack_entry_t *entry = list_get(writer->entries, i);
+        entry->offset = offset;
+        offset = align_up(offset + entry->size);
+    }
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    fwrite(&header, sizeof(header), 1, file);
+    for (size_t i = 0; i < count; i++) {
+        fwrite(list_get(writer->entries, i), sizeof(pack_entry_t), 1, file);
+    }
+    for (size_t i = 0; i < count; i++) {
+        pack_entry_t *entry = list_get(writer->entries, i);
+        // Pad up to where the entry's data starts
+        while (ftell(file) < (long)entry->offset) {
+            fputc(0, file);
+        }
+        fwrite(list_get(writer->data, i), 1, entry->size, file);
+    }
+    bool written = !ferror(file);
+    return fclose(file) == 0 && written;
+}
@@ -19,19 +19,10 @@ typedef struct ball {
 } ball_t;
 
 ball_t *ball_init(int number, vector_t centroid) {
-    //use other constructer with no info or info_freer
     list_t *shape = make_ball_shape(BALL_RADIUS);
     rgb_color_t color = {0.0, 0.0, 0.0};
-    char *num_str = malloc((int)((ceil((number + 1) / 10.0)) + 1)*sizeof(char));
-    assert(num_str != NULL);
-    sprintf(num_str, "%d", number);
-    // can make the size of info more specific to save space
-    char *info = malloc(50 * sizeof(char));
-    assert(info != NULL);
-    strcpy(info, "./assets/ball");
-    strcat(info, num_str);
-    strcat(info, ".png");
-    body_t *body = body_init_with_info(shape, BALL_MASS, color, info, (free_func_t)free);
+    body_t *body = body_init(shape, BALL_MASS, color);
+    body_set_render(body, (render_component_t){DRAW_SPRITE, LAYER_DYNAMIC, SPRITE_BALL_0 + number});
     body_set_centroid(body, centroid);
     ball_t *ball = malloc(sizeof(ball_t));
     assert(ball != NULL);
@@ -43,7 +34,6 @@ ball_t *ball_init(int number, vector_t centroid) {
     else {
         ball->solid = 0;
     }
-    free(num_str);
     return ball;
 }
 
@@ -0,0 +1,97 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "batch.h"
+#include "ball.h"
+#include "player.h"
+#include "thread_pool.h"
+
+typedef struct batch {
+    thread_pool_t *pool;
+    // one table per worker
+    scene_t **lanes;
+    size_t num_lanes;
+    // the arguments of the batch_run() in progress
+    const table_state_t *table;
+    const shot_t *shots;
+    shot_outcome_t *outcomes;
+    double dt;
+    int max_ticks;
+} batch_t;
+
+batch_t *batch_init(size_t threads) {
+    batch_t *batch = malloc(sizeof(batch_t));
+    assert(batch != NULL);
+    batch->pool = thread_pool_init(threads);
+    batch->lanes = malloc(threads * sizeof(scene_t *));
+    assert(batch->lanes != NULL);
+    batch->num_lanes = threads;
+    for (size_t i = 0; i < threads; i++) {
+        batch->lanes[i] = table_scene_init();
+    }
+    return batch;
+}
+
+// the balls sunk by either player, as a bitmask of ball numbers
+uint16_t sunk_mask(scene_t *scene) {
+    uint16_t mask = 0;
+    for (size_t p = 0; p < TABLE_PLAYERS; p++) {
+        list_t *sunk = player_get_balls_sunk(scene_get_player(scene, p));
+        for (size_t i = 0; i < list_size(sunk); i++) {
+            mask |= 1 << ball_get_num(list_get(sunk, i));
+        }
+    }
+    return mask;
+}
+
+// the balls of the shooter's opponent, as a bitmask of ball numbers
+uint16_t opponent_mask(player_t *shooter) {
+    uint16_t solids = 0xfe & ~(1 << 8);
+    uint16_t stripes = 0xfe00;
+    return strcmp(player_get_info(shooter), "solid") == 0 ? stripes : solids;
+}
+
+void play_lane(void *aux, size_t index, size_t worker) {
+    batch_t *batch = aux;
+    scene_t *scene = batch->lanes[worker];
+    const shot_t *shot = &batch->shots[index];
+    shot_outcome_t *outcome = &batch->outcomes[index];
+
+    table_load(scene, batch->table);
+    player_t *shooter = scene_get_player(scene, scene_get_turn(scene));
+    uint16_t before = sunk_mask(scene);
+    if (scene_get_state(scene) == PLACING) {
+        table_place_cue_ball(scene, shot->cue_ball);
+    }
+    outcome->ticks = table_play_shot(scene, shot->angle, shot->power, batch->dt, batch->max_ticks);
+    outcome->sunk = sunk_mask(scene) & ~before;
+    // The shooter's turn state only says the cue ball was sunk until the balls stop
+    outcome->scratch = scene_get_state(scene) == PLACING || player_get_turn_state(shooter) == 1;
+    outcome->foul = (outcome->sunk & opponent_mask(shooter)) != 0;
+    outcome->state = scene_get_state(scene);
+    outcome->turn = scene_get_turn(scene);
+    list_t *balls = scene_get_balls(scene);
+    for (size_t i = 0; i < TABLE_BALLS; i++) {
+        outcome->positions[i] = body_get_centroid(ball_get_body(list_get(balls, i)));
+    }
+}
+
+void batch_run(batch_t *batch, const table_state_t *table, const shot_t *shots,
+               shot_outcome_t *outcomes, size_t count, double dt, int max_ticks) {
+    assert(table->state == PLACING || table->state == FIRING);
+    batch->table = table;
+    batch->shots = shots;
+    batch->outcomes = outcomes;
+    batch->dt = dt;
+    batch->max_ticks = max_ticks;
+    thread_pool_run(batch->pool, play_lane, batch, count);
+}
+
+void batch_free(batch_t *batch) {
+    thread_pool_free(batch->pool);
+    for (size_t i = 0; i < batch->num_lanes; i++) {
+        scene_free(batch->lanes[i]);
+    }
+    free(batch->lanes);
+    free(batch);
+}
@@ -0,0 +1,86 @@
+#include <math.h>
+#include <string.h>
+#include "binary_io.h"
+
+// Compact doubles are stored as thousandths, if there are a whole number of them
+// and few enough that their zigzag encoding plus one fits in a varint
+const double THOUSANDTHS = 1000;
+const double MAX_THOUSANDTHS = 1e9;
+
+void write_uint(FILE *file, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        fputc((value >> (8 * i)) & 0xff, file);
+    }
+}
+
+bool read_uint(FILE *file, uint64_t *value, int bytes) {
+    *value = 0;
+    for (int i = 0; i < bytes; i++) {
+        int byte = fgetc(file);
+        if (byte == EOF) return false;
+        *value |= (uint64_t)byte << (8 * i);
+    }
+    return true;
+}
+
+void write_double(FILE *file, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    write_uint(file, bits, 8);
+}
+
+bool read_double(FILE *file, double *value) {
+    uint64_t bits;
+    if (!read_uint(file, &bits, 8)) return false;
+    memcpy(value, &bits, sizeof(bits));
+    return true;
+}
+
+// Varints hold 7 bits per byte, with the high bit set on every byte but the last
+void write_varint(FILE *file, uint32_t value) {
+    while (value >= 0x80) {
+        fputc((value & 0x7f) | 0x80, file);
+        value >>= 7;
+    }
+    fputc(value, file);
+}
+
+bool read_varint(FILE *file, uint32_t *value) {
+    *value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        int byte = fgetc(file);
+        if (byte == EOF) return false;
+        *value |= (uint32_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+void write_compact_double(FILE *file, double value) {
+    double thousandths = round(value * THOUSANDTHS);
+    if (fabs(thousandths) <= MAX_THOUSANDTHS) {
+        int64_t whole = thousandths;
+        // Compared bit for bit with what would be read back, so -0.0 is written in full
+        double read_back = whole / THOUSANDTHS;
+        if (memcmp(&read_back, &value, sizeof(value)) == 0) {
+            // Zigzag: 0, -1, 1, -2, ... become 0, 1, 2, 3, ...; 0 marks a full double
+            uint32_t zigzag = whole < 0 ? -2 * whole - 1 : 2 * whole;
+            write_varint(file, zigzag + 1);
+            return;
+        }
+    }
+    write_varint(file, 0);
+    write_double(file, value);
+}
+
+bool read_compact_double(FILE *file, double *value) {
+    uint32_t encoded;
+    if (!read_varint(file, &encoded)) return false;
+    if (encoded == 0) {
+        return read_double(file, value);
+    }
+    uint32_t zigzag = encoded - 1;
+    int64_t whole = zigzag & 1 ? -(int64_t)(zigzag / 2) - 1 : (int64_t)(zigzag / 2);
+    *value = whole / THOUSANDTHS;
+    return true;
+}
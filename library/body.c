@@ -9,17 +9,26 @@
 
 typedef struct body {
     list_t *shape;
+    /**
+     * Each vertex of the shape less the centroid. The shape is placed from these
+     * whenever the body moves, so where its vertices are depends only on where
+     * the body is and not on how it got there, and a saved body put back is exact.
+     */
+    vector_t *offsets;
     double mass;
     rgb_color_t color;
     vector_t velocity;
     vector_t acceleration;
     vector_t centroid;
+    double radius;
     double angle;
     vector_t force;
     vector_t impulse;
     void *info;
     void *info_freer;
     int removed;
+    integrator_t integrator;
+    render_component_t render;
 } body_t;
 
 body_t *body_init(list_t *shape, double mass, rgb_color_t color) {
@@ -37,17 +46,31 @@ body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color, void
     body->velocity = (vector_t){0, 0};
     body->acceleration = (vector_t){0, 0};
     body->centroid = polygon_centroid(shape);
+    body->offsets = malloc(sizeof(vector_t) * list_size(shape));
+    assert(body->offsets != NULL);
+    body->radius = 0;
+    for (size_t i = 0; i < list_size(shape); i++) {
+        vector_t *vertex = list_get(shape, i);
+        body->offsets[i] = vec_subtract(*vertex, body->centroid);
+        double dist = vec_magnitude(body->offsets[i]);
+        if (dist > body->radius) {
+            body->radius = dist;
+        }
+    }
     body->angle = 0;
     body->force = (vector_t){0, 0};
     body->impulse = (vector_t){0, 0};
     body->info = info;
     body->info_freer = info_freer;
     body->removed = 0;
+    body->integrator = INTEGRATOR_SCENE;
+    body->render = (render_component_t){DRAW_NONE, LAYER_DYNAMIC, 0};
     return body;
 }
 
 void body_free(body_t *body) {
     list_free(body->shape);
+    free(body->offsets);
     if (body->info_freer != NULL) {
         ((free_func_t)(body->info_freer))(body->info);
     }
@@ -66,10 +89,18 @@ list_t *body_get_shape(body_t *body) {
     return copy;
 }
 
+list_t *body_borrow_shape(body_t *body) {
+    return body->shape;
+}
+
 vector_t body_get_centroid(body_t *body) {
     return body->centroid;
 }
 
+double body_get_radius(body_t *body) {
+    return body->radius;
+}
+
 vector_t body_get_velocity(body_t *body) {
     return body->velocity;
 }
@@ -94,15 +125,37 @@ void *body_get_info(body_t *body) {
     return body->info;
 }
 
+render_component_t body_get_render(body_t *body) {
+    return body->render;
+}
+
+void body_set_render(body_t *body, render_component_t render) {
+    body->render = render;
+}
+
+// Puts each vertex at its offset from the centroid
+void place_shape(body_t *body) {
+    for (size_t i = 0; i < list_size(body->shape); i++) {
+        vector_t *vertex = list_get(body->shape, i);
+        *vertex = vec_add(body->centroid, body->offsets[i]);
+    }
+}
+
+// Takes the offsets from where the vertices are now
+void take_offsets(body_t *body) {
+    for (size_t i = 0; i < list_size(body->shape); i++) {
+        body->offsets[i] = vec_subtract(*(vector_t *)list_get(body->shape, i), body->centroid);
+    }
+}
+
 void body_set_centroid(body_t *body, vector_t x) {
-    vector_t old_centroid = body_get_centroid(body);
-    polygon_translate(body->shape, vec_subtract(x, old_centroid));
     body->centroid = x;
+    place_shape(body);
 }
 
 void body_translate(body_t *body, vector_t x) {
-    polygon_translate(body->shape, x);
     body->centroid = vec_add(body->centroid, x);
+    place_shape(body);
 }
 
 void body_set_velocity(body_t *body, vector_t v) {
@@ -112,6 +165,7 @@ void body_set_velocity(body_t *body, vector_t v) {
 void body_set_rotation(body_t *body, double angle) {
     double new_angle = angle - body->angle;
     polygon_rotate(body->shape, new_angle, body_get_centroid(body));
+    take_offsets(body);
     body->angle = angle;
 }
 
@@ -119,6 +173,7 @@ void body_set_rotation_about_point(body_t *body, double angle, vector_t point) {
     double new_angle = angle - body->angle;
     polygon_rotate(body->shape, new_angle, point);
     body->centroid = polygon_centroid(body->shape);
+    take_offsets(body);
     body->angle = angle;
 }
 
@@ -163,6 +218,43 @@ void body_tick(body_t *body, double dt) {
     body->impulse = (vector_t){0, 0};
 }
 
+void body_step(body_t *body, double dt, integrator_t integrator) {
+    if (integrator == INTEGRATOR_TRAPEZOID) {
+        body_tick(body, dt);
+        return;
+    }
+    assert(integrator == INTEGRATOR_SEMI_IMPLICIT_EULER);
+    if (body->mass != DBL_MAX) {
+        body->acceleration = vec_multiply(1 / body->mass, body->force);
+        body->velocity = vec_add(body->velocity, vec_multiply(1 / body->mass, body->impulse));
+        body->velocity = vec_add(body->velocity, vec_multiply(dt, body->acceleration));
+    }
+    body_translate(body, vec_multiply(dt, body->velocity));
+    body->force = (vector_t){0, 0};
+    body->impulse = (vector_t){0, 0};
+}
+
+integrator_t body_get_integrator(body_t *body) {
+    return body->integrator;
+}
+
+void body_set_integrator(body_t *body, integrator_t integrator) {
+    body->integrator = integrator;
+}
+
+vector_t body_get_force(body_t *body) {
+    return body->force;
+}
+
+vector_t body_get_impulse(body_t *body) {
+    return body->impulse;
+}
+
+void body_clear_forces(body_t *body) {
+    body->force = (vector_t){0, 0};
+    body->impulse = (vector_t){0, 0};
+}
+
 void body_remove(body_t *body) {
     //mark body for removal
     body->removed = 1;
@@ -5,7 +5,7 @@
 #include "ball.h"
 #include <assert.h>
 
-vector_t project_shape(list_t *shape, vector_t axis_before_normalized, list_t *axes) {
+vector_t project_shape(list_t *shape, vector_t axis_before_normalized) {
   vector_t axis = vec_normalize(axis_before_normalized);
   double min = vec_dot(axis, ((vector_t*)list_get(shape, 0))[0]);
   double max = min;
@@ -31,62 +31,68 @@ double get_overlap(vector_t p1, vector_t p2) {
     }
 }
 
-double check_overlap(collision_info_t *collision, list_t *shape1, list_t *shape2, list_t *axes, double prev_overlap) {
+// the normal of the edge from vertex i to the next vertex, not normalized
+vector_t get_axis(list_t *shape, size_t i) {
+    vector_t p1 = ((vector_t *)list_get(shape, i))[0];
+    vector_t p2 = ((vector_t *)list_get(shape, i + 1 == list_size(shape) ? 0 : i + 1))[0];
+    return vec_get_normal(vec_subtract(p2, p1));
+}
+
+// checks the shapes for overlap along each edge normal of axes_shape,
+// computing the normals on the fly so no memory is allocated.
+// With take_ties, an overlap equal to prev_overlap replaces collision->axis,
+// so these axes win ties against the pass that found prev_overlap.
+// Only a newly found axis is normalized, so an axis carried over is not rounded twice.
+double check_overlap(collision_info_t *collision, list_t *shape1, list_t *shape2, list_t *axes_shape,
+                     double prev_overlap, bool take_ties) {
     bool collided = true;
     double overlap = prev_overlap;
     vector_t smallest_axis = collision->axis;
-    for (size_t i = 0; i < list_size(axes); i++) {
-      vector_t axis = ((vector_t*)list_get(axes, i))[0];
-      vector_t p1 = project_shape(shape1, axis, axes);
-      vector_t p2 = project_shape(shape2, axis, axes);
+    bool found = false;
+    for (size_t i = 0; i < list_size(axes_shape); i++) {
+      vector_t axis = get_axis(axes_shape, i);
+      vector_t p1 = project_shape(shape1, axis);
+      vector_t p2 = project_shape(shape2, axis);
       if (!((p1.x < p2.y && p1.x > p2.x) || (p2.x < p1.y && p2.x > p1.x))) {
         collided = false;
         break;
       }
       else {
           double o = get_overlap(p1, p2);
-          if (o < overlap) {
+          if (o < overlap || (take_ties && o == overlap)) {
               overlap = o;
               smallest_axis = axis;
+              take_ties = false;
+              found = true;
           }
       }
     }
     collision->collided = collided;
-    if (collision->collided) {
+    if (collision->collided && found) {
       collision->axis = vec_normalize(smallest_axis);
     }
     return overlap;
 }
 
-list_t *get_axes(list_t *shape) {
-    list_t *axes = list_init(list_size(shape), (free_func_t)free);
-    for (size_t i = 0; i < list_size(shape); i++) {
-      vector_t p1 = ((vector_t *)list_get(shape, i))[0];
-      vector_t p2 = ((vector_t *)list_get(shape, i + 1 == list_size(shape) ? 0 : i + 1))[0];
-      vector_t edge = vec_subtract(p2, p1);
-      vector_t normal = vec_get_normal(edge);
-      vector_t *norm = malloc(sizeof(vector_t));
-      assert(norm != NULL);
-      norm[0] = normal;
-      list_add(axes, norm);
-    }
-    return axes;
-}
-
 collision_info_t find_collision(list_t *shape1, list_t *shape2) {
-  collision_info_t *collision = malloc(sizeof(collision_info_t));
-  collision->collided = true;
-  list_t *axes1 = get_axes(shape1);
-  list_t *axes2 = get_axes(shape2);
-  double overlap = check_overlap(collision, shape1, shape2, axes1, DBL_MAX);
-  check_overlap(collision, shape1, shape2, axes2, overlap);
-  list_free(axes1);
-  list_free(axes2);
-  return *collision;
+  collision_info_t collision;
+  collision.collided = true;
+  collision.axis = VEC_ZERO;
+  // the shapes only collide if no edge normal of either shape separates them.
+  // shape2 is usually the smaller one (a wall or pocket), so try its axes
+  // first to skip projecting onto every axis of shape1 when far apart.
+  // The smallest overlap so far carries into shape1's axes, which win ties
+  // as they did when shape1's axes were checked first.
+  double overlap = check_overlap(&collision, shape1, shape2, shape2, DBL_MAX, false);
+  if (!collision.collided) {
+    return collision;
+  }
+  check_overlap(&collision, shape1, shape2, shape1, overlap, true);
+  return collision;
 }
 
 collision_info_t find_collision_balls(body_t *ball1, body_t *ball2) {
-  collision_info_t *collision = malloc(sizeof(collision_info_t));
+  collision_info_t collision;
   vector_t b1 = body_get_centroid(ball1);
   //printf("Centroid of ball1: (%f, %f)\n", b1.x, b1.y);
   vector_t b2 = body_get_centroid(ball2);
@@ -96,12 +102,12 @@ collision_info_t find_collision_balls(body_t *ball1, body_t *ball2) {
   //printf("Distance between balls: %f\n", dist);
   if (dist > (ball_body_get_radius(ball1) + ball_body_get_radius(ball2)))
   {
-    collision->collided = false;
+    collision.collided = false;
   }
   else {
     //printf("Ball collision!\n");
-    collision->collided = true;
-    collision->axis = vec_normalize(axis);
+    collision.collided = true;
+    collision.axis = vec_normalize(axis);
   }
-  return *collision;
+  return collision;
 }
@@ -0,0 +1,254 @@
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "contact_solver.h"
+
+#define INITIAL_CAPACITY 16
+// Pairs approaching slower than this do not bounce,
+// so balls resting against each other stay at rest.
+const double RESTITUTION_THRESHOLD = 1.0;
+
+typedef struct contact_pair {
+    size_t body1;
+    size_t body2;
+    double elasticity;
+    // the impulse applied along the normal, from body1 to body2
+    double impulse;
+    // this tick's contact, if any
+    bool touching;
+    vector_t normal;
+    double mass;
+    double target;
+} contact_pair_t;
+
+typedef struct contact_solver {
+    size_t iterations;
+    double baumgarte;
+    double slop;
+    list_t *bodies;
+    contact_pair_t *pairs;
+    size_t num_pairs;
+    size_t pair_cap;
+    // per body, rebuilt every tick
+    double *inverse_mass;
+    vector_t *velocity;
+    vector_t *start_velocity;
+    size_t body_cap;
+} contact_solver_t;
+
+contact_solver_t *contact_solver_init(size_t iterations, double baumgarte, double slop) {
+    assert(iterations > 0);
+    assert(baumgarte >= 0 && baumgarte <= 1);
+    contact_solver_t *solver = malloc(sizeof(contact_solver_t));
+    assert(solver != NULL);
+    solver->iterations = iterations;
+    solver->baumgarte = baumgarte;
+    solver->slop = slop;
+    solver->bodies = list_init(INITIAL_CAPACITY, NULL);
+    solver->pairs = malloc(INITIAL_CAPACITY * sizeof(contact_pair_t));
+    assert(solver->pairs != NULL);
+    solver->num_pairs = 0;
+    solver->pair_cap = INITIAL_CAPACITY;
+    solver->inverse_mass = NULL;
+    solver->velocity = NULL;
+    solver->start_velocity = NULL;
+    solver->body_cap = 0;
+    return solver;
+}
+
+void contact_solver_free(contact_solver_t *solver) {
+    list_free(solver->bodies);
+    free(solver->pairs);
+    free(solver->inverse_mass);
+    free(solver->velocity);
+    free(solver->start_velocity);
+    free(solver);
+}
+
+size_t solver_body_index(contact_solver_t *solver, body_t *body) {
+    for (size_t i = 0; i < list_size(solver->bodies); i++) {
+        if (list_get(solver->bodies, i) == body) {
+            return i;
+        }
+    }
+    list_add(solver->bodies, body);
+    return list_size(solver->bodies) - 1;
+}
+
+void contact_solver_add_pair(contact_solver_t *solver, double elasticity, body_t *body1, body_t *body2) {
+    if (solver->num_pairs >= solver->pair_cap) {
+        solver->pair_cap *= 2;
+        solver->pairs = realloc(solver->pairs, solver->pair_cap * sizeof(contact_pair_t));
+        assert(solver->pairs != NULL);
+    }
+    contact_pair_t *pair = &solver->pairs[solver->num_pairs++];
+    pair->body1 = solver_body_index(solver, body1);
+    pair->body2 = solver_body_index(solver, body2);
+    pair->elasticity = elasticity;
+    pair->impulse = 0;
+    pair->touching = false;
+}
+
+size_t contact_solver_pairs(contact_solver_t *solver) {
+    return solver->num_pairs;
+}
+
+double get_inverse_mass(body_t *body) {
+    double mass = body_get_mass(body);
+    return isinf(mass) || mass == DBL_MAX ? 0 : 1 / mass;
+}
+
+void reserve_bodies(contact_solver_t *solver, size_t n) {
+    if (n <= solver->body_cap) {
+        return;
+    }
+    solver->inverse_mass = realloc(solver->inverse_mass, n * sizeof(double));
+    solver->velocity = realloc(solver->velocity, n * sizeof(vector_t));
+    solver->start_velocity = realloc(solver->start_velocity, n * sizeof(vector_t));
+    assert(solver->inverse_mass != NULL && solver->velocity != NULL);
+    assert(solver->start_velocity != NULL);
+    solver->body_cap = n;
+}
+
+// changes the velocities of a pair's bodies by an impulse along its normal
+void apply_pair_impulse(contact_solver_t *solver, contact_pair_t *pair, double impulse) {
+    vector_t *v1 = &solver->velocity[pair->body1];
+    vector_t *v2 = &solver->velocity[pair->body2];
+    double im1 = solver->inverse_mass[pair->body1] * impulse;
+    double im2 = solver->inverse_mass[pair->body2] * impulse;
+    v1->x -= im1 * pair->normal.x;
+    v1->y -= im1 * pair->normal.y;
+    v2->x += im2 * pair->normal.x;
+    v2->y += im2 * pair->normal.y;
+}
+
+double normal_velocity(contact_solver_t *solver, contact_pair_t *pair) {
+    vector_t v1 = solver->velocity[pair->body1];
+    vector_t v2 = solver->velocity[pair->body2];
+    return (v2.x - v1.x) * pair->normal.x + (v2.y - v1.y) * pair->normal.y;
+}
+
+// finds this tick's contacts and what each one's normal velocity should become
+void find_contacts(contact_solver_t *solver, double dt) {
+    for (size_t p = 0; p < solver->num_pairs; p++) {
+        contact_pair_t *pair = &solver->pairs[p];
+        body_t *body1 = list_get(solver->bodies, pair->body1);
+        body_t *body2 = list_get(solver->bodies, pair->body2);
+        vector_t offset = vec_subtract(body_get_centroid(body2), body_get_centroid(body1));
+        double dist = vec_magnitude(offset);
+        double overlap = body_get_radius(body1) + body_get_radius(body2) - dist;
+        double inverse_mass = solver->inverse_mass[pair->body1] + solver->inverse_mass[pair->body2];
+        pair->touching = overlap >= 0 && dist > 0 && inverse_mass > 0;
+        if (!pair->touching) {
+            pair->impulse = 0;
+            continue;
+        }
+        pair->normal = vec_multiply(1 / dist, offset);
+        pair->mass = 1 / inverse_mass;
+        double approach = normal_velocity(solver, pair);
+        double bounce = approach < -RESTITUTION_THRESHOLD ? -pair->elasticity * approach : 0;
+        double push = overlap > solver->slop ? solver->baumgarte * (overlap - solver->slop) / dt : 0;
+        pair->target = bounce > push ? bounce : push;
+    }
+}
+
+void contact_solver_solve(contact_solver_t *solver, double dt) {
+    size_t n = list_size(solver->bodies);
+    if (n == 0 || dt <= 0) {
+        return;
+    }
+    reserve_bodies(solver, n);
+    // the velocity each body would end the tick with, without the solver
+    for (size_t i = 0; i < n; i++) {
+        body_t *body = list_get(solver->bodies, i);
+        double inverse_mass = get_inverse_mass(body);
+        vector_t dv = vec_multiply(inverse_mass, vec_add(vec_multiply(dt, body_get_force(body)),
+                                                         body_get_impulse(body)));
+        solver->inverse_mass[i] = inverse_mass;
+        solver->velocity[i] = vec_add(body_get_velocity(body), dv);
+        solver->start_velocity[i] = solver->velocity[i];
+    }
+    find_contacts(solver, dt);
+
+    for (size_t p = 0; p < solver->num_pairs; p++) {
+        contact_pair_t *pair = &solver->pairs[p];
+        if (pair->touching && pair->impulse > 0) {
+            apply_pair_impulse(solver, pair, pair->impulse);
+        }
+    }
+    for (size_t iter = 0; iter < solver->iterations; iter++) {
+        for (size_t p = 0; p < solver->num_pairs; p++) {
+            contact_pair_t *pair = &solver->pairs[p];
+            if (!pair->touching) {
+                continue;
+            }
+            double change = pair->mass * (pair->target - normal_velocity(solver, pair));
+            // contacts can only push, so the total impulse stays positive
+            double total = pair->impulse + change > 0 ? pair->impulse + change : 0;
+            apply_pair_impulse(solver, pair, total - pair->impulse);
+            pair->impulse = total;
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (solver->inverse_mass[i] == 0) {
+            continue;
+        }
+        vector_t dv = vec_subtract(solver->velocity[i], solver->start_velocity[i]);
+        if (dv.x != 0 || dv.y != 0) {
+            body_add_impulse(list_get(solver->bodies, i), vec_multiply(1 / solver->inverse_mass[i], dv));
+        }
+    }
+}
+
+void contact_solver_remove_marked(contact_solver_t *solver) {
+    size_t n = list_size(solver->bodies);
+    bool any_removed = false;
+    for (size_t i = 0; i < n && !any_removed; i++) {
+        any_removed = body_is_removed(list_get(solver->bodies, i));
+    }
+    if (!any_removed) {
+        return;
+    }
+    // renumber the bodies that are left, then drop pairs with removed bodies
+    size_t *new_index = malloc(n * sizeof(size_t));
+    assert(new_index != NULL);
+    list_t *kept_bodies = list_init(n, NULL);
+    for (size_t i = 0; i < n; i++) {
+        body_t *body = list_get(solver->bodies, i);
+        new_index[i] = SIZE_MAX;
+        if (!body_is_removed(body)) {
+            new_index[i] = list_size(kept_bodies);
+            list_add(kept_bodies, body);
+        }
+    }
+    size_t kept = 0;
+    for (size_t p = 0; p < solver->num_pairs; p++) {
+        contact_pair_t pair = solver->pairs[p];
+        if (new_index[pair.body1] != SIZE_MAX && new_index[pair.body2] != SIZE_MAX) {
+            pair.body1 = new_index[pair.body1];
+            pair.body2 = new_index[pair.body2];
+            solver->pairs[kept++] = pair;
+        }
+    }
+    solver->num_pairs = kept;
+    list_free(solver->bodies);
+    solver->bodies = kept_bodies;
+    free(new_index);
+}
+
+size_t contact_solver_get_impulses(contact_solver_t *solver, double *impulses, size_t max) {
+    for (size_t p = 0; p < solver->num_pairs && p < max; p++) {
+        impulses[p] = solver->pairs[p].impulse;
+    }
+    return solver->num_pairs;
+}
+
+void contact_solver_set_impulses(contact_solver_t *solver, const double *impulses, size_t count) {
+    for (size_t p = 0; p < solver->num_pairs && p < count; p++) {
+        solver->pairs[p].impulse = impulses[p];
+    }
+}
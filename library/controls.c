@@ -0,0 +1,64 @@
+#include <math.h>
+#include "controls.h"
+#include "mouse.h"
+#include "table.h"
+
+const vector_t MENU_BUTTON_1[] = {{267, 270}, {613, 328}};
+const vector_t MENU_BUTTON_2[] = {{629, 270}, {975, 328}};
+// How far the cue is pulled back each time the held space key repeats
+const double DISTANCE = 4;
+// The cue stops being pulled back after space has been held this long
+const double MAX_WIND_UP = 2.0;
+
+/**
+ * Returns whether the computer is taking the current shot,
+ * in which case the mouse and keyboard must leave the table alone.
+ */
+bool computer_turn(scene_t *scene) {
+    return player_is_computer(scene_get_player(scene, scene_get_turn(scene)));
+}
+
+void controls_on_mouse(mouse_event_type_t type, scene_t *scene, double held_time, vector_t position) {
+    int game_state = scene_get_state(scene);
+    if (game_state != MENU && computer_turn(scene)) {
+        return;
+    }
+    if (game_state == MENU) {
+        mouse_handle_menu(type, position, scene, MENU_BUTTON_1, MENU_BUTTON_2);
+    }
+    else if (game_state == PLACING) {
+        mouse_handle_placing(type, position, (ball_t *)list_get(scene_get_balls(scene), 0), scene, KITCHEN);
+    }
+    else if (game_state == FIRING) {
+        body_t *cue = table_get_cue(scene);
+        if (cue != NULL) {
+            mouse_handle_firing(type, position, cue, (ball_t *)list_get(scene_get_balls(scene), 0), scene, held_time);
+        }
+    }
+}
+
+double controls_get_pull_back(scene_t *scene) {
+    // The cue is only ever pulled back a step at a time,
+    // so rounding to whole steps just drops the rounding errors of aiming
+    return round(table_get_cue_pull_back(scene) / DISTANCE) * DISTANCE;
+}
+
+void controls_on_key(char key, key_event_type_t type, double held_time, scene_t *scene) {
+    body_t *cue = table_get_cue(scene);
+    if (scene_get_state(scene) == FIRING && cue != NULL && !computer_turn(scene)) {
+        if (type == KEY_PRESSED && key == SPACE) {
+            double angle = body_get_angle(cue);
+            double dx = DISTANCE * (cos(angle));
+            double dy = DISTANCE * (sin(angle));
+            if (held_time <= MAX_WIND_UP) {
+                body_translate(cue, (vector_t){dx, dy});
+            }
+        }
+        else if (type == KEY_RELEASED && key == SPACE) {
+            // Strike with a cue rebuilt where this one is, so a recorded shot
+            // can put the cue back exactly, see table_set_cue()
+            table_set_cue(scene, body_get_angle(cue), controls_get_pull_back(scene));
+            table_shoot(scene, held_time);
+        }
+    }
+}
@@ -6,6 +6,7 @@
 #include "body.h"
 #include "ball.h"
 #include "player.h"
+#include "quadtree.h"
 #include "collision.h"
 #include "forces.h"
 #include "scene.h"
@@ -22,6 +23,33 @@ typedef struct force_bodies
     int collided;
 } force_bodies_t;
 
+// auxiliary state for gravity between many bodies at once
+typedef struct nbody_gravity
+{
+    double G;
+    double theta;
+    list_t *bodies;
+    quadtree_t *tree;
+    // gathered from the bodies every tick
+    vector_t *positions;
+    double *masses;
+    size_t capacity;
+} nbody_gravity_t;
+
+// auxiliary state for exact gravity between many bodies at once,
+// with the bodies gathered into separate arrays every tick
+typedef struct group_gravity
+{
+    double G;
+    list_t *bodies;
+    double *x;
+    double *y;
+    double *mass;
+    double *fx;
+    double *fy;
+    size_t capacity;
+} group_gravity_t;
+
 typedef struct collision_values
 {
     double elasticity;
@@ -32,6 +60,7 @@ typedef struct collision_values
 } collision_values_t;
 
 const double MIN_DIST = 5;
+const double MIN_FRICTION_SPEED = 5;
 
 double get_length(vector_t v);
 
@@ -92,7 +121,157 @@ void create_newtonian_gravity(scene_t *scene, double G, body_t *body1, body_t *b
     aux->ball_collision = false;
     aux->freer = NULL;
     aux->collided = 0;
-    scene_add_bodies_force_creator(scene, (force_creator_t)gravity, aux, bodies, (free_func_t)force_bodies_free);
+    scene_add_kind_force_creator(scene, FORCE_GRAVITY, (force_creator_t)gravity, aux, bodies, (free_func_t)force_bodies_free);
+}
+
+void nbody_gravity_free(nbody_gravity_t *ng)
+{
+    quadtree_free(ng->tree);
+    free(ng->positions);
+    free(ng->masses);
+    free(ng);
+}
+
+void nbody_gravity(void *aux)
+{
+    nbody_gravity_t *ng = aux;
+    size_t n = list_size(ng->bodies);
+    if (n > ng->capacity)
+    {
+        ng->positions = realloc(ng->positions, n * sizeof(vector_t));
+        ng->masses = realloc(ng->masses, n * sizeof(double));
+        assert(ng->positions != NULL && ng->masses != NULL);
+        ng->capacity = n;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        body_t *body = list_get(ng->bodies, i);
+        ng->positions[i] = body_get_centroid(body);
+        ng->masses[i] = body_get_mass(body);
+    }
+    quadtree_build(ng->tree, ng->positions, ng->masses, n);
+    for (size_t i = 0; i < n; i++)
+    {
+        vector_t force = quadtree_force(ng->tree, i, ng->G, ng->theta, MIN_DIST);
+        body_add_force(list_get(ng->bodies, i), force);
+    }
+}
+
+void create_nbody_gravity(scene_t *scene, double G, list_t *bodies, double theta)
+{
+    assert(theta >= 0);
+    nbody_gravity_t *aux = malloc(sizeof(nbody_gravity_t));
+    assert(aux != NULL);
+    aux->G = G;
+    aux->theta = theta;
+    aux->bodies = bodies;
+    aux->tree = quadtree_init();
+    aux->positions = NULL;
+    aux->masses = NULL;
+    aux->capacity = 0;
+    scene_add_kind_force_creator(scene, FORCE_GRAVITY, (force_creator_t)nbody_gravity, aux, bodies, (free_func_t)nbody_gravity_free);
+}
+
+// The number of bodies pulling on each body per pass of all_pairs_gravity();
+// their x, y and mass take 12KB, so they stay in L1 while every body is visited.
+#define GRAVITY_TILE 512
+
+void group_gravity_free(group_gravity_t *gg)
+{
+    free(gg->x);
+    free(gg->y);
+    free(gg->mass);
+    free(gg->fx);
+    free(gg->fy);
+    free(gg);
+}
+
+// Sums the pull of every body on every other into fx and fy, without the
+// factor of G * mass[i]. The inner loop has no calls or branches,
+// so the compiler can vectorize it when optimizing.
+void all_pairs_gravity(group_gravity_t *gg, size_t n)
+{
+    const double *x = gg->x;
+    const double *y = gg->y;
+    const double *mass = gg->mass;
+    double min_dist_squared = MIN_DIST * MIN_DIST;
+    for (size_t i = 0; i < n; i++)
+    {
+        gg->fx[i] = 0;
+        gg->fy[i] = 0;
+    }
+    for (size_t start = 0; start < n; start += GRAVITY_TILE)
+    {
+        size_t end = start + GRAVITY_TILE < n ? start + GRAVITY_TILE : n;
+        for (size_t i = 0; i < n; i++)
+        {
+            double xi = x[i];
+            double yi = y[i];
+            double fx = 0;
+            double fy = 0;
+            for (size_t j = start; j < end; j++)
+            {
+                double dx = x[j] - xi;
+                double dy = y[j] - yi;
+                double dist_squared = dx * dx + dy * dy;
+                // also skips the body itself, as gravity() does for close pairs
+                double scale = dist_squared > min_dist_squared
+                    ? mass[j] / (dist_squared * sqrt(dist_squared))
+                    : 0;
+                fx += scale * dx;
+                fy += scale * dy;
+            }
+            gg->fx[i] += fx;
+            gg->fy[i] += fy;
+        }
+    }
+}
+
+void group_gravity(void *aux)
+{
+    group_gravity_t *gg = aux;
+    size_t n = list_size(gg->bodies);
+    if (n > gg->capacity)
+    {
+        gg->x = realloc(gg->x, n * sizeof(double));
+        gg->y = realloc(gg->y, n * sizeof(double));
+        gg->mass = realloc(gg->mass, n * sizeof(double));
+        gg->fx = realloc(gg->fx, n * sizeof(double));
+        gg->fy = realloc(gg->fy, n * sizeof(double));
+        assert(gg->x != NULL && gg->y != NULL && gg->mass != NULL);
+        assert(gg->fx != NULL && gg->fy != NULL);
+        gg->capacity = n;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        body_t *body = list_get(gg->bodies, i);
+        vector_t centroid = body_get_centroid(body);
+        gg->x[i] = centroid.x;
+        gg->y[i] = centroid.y;
+        gg->mass[i] = body_get_mass(body);
+    }
+    all_pairs_gravity(gg, n);
+    for (size_t i = 0; i < n; i++)
+    {
+        double scale = gg->G * gg->mass[i];
+        vector_t force = {scale * gg->fx[i], scale * gg->fy[i]};
+        body_add_force(list_get(gg->bodies, i), force);
+    }
+}
+
+void create_group_gravity(scene_t *scene, double G, list_t *bodies)
+{
+    group_gravity_t *aux = malloc(sizeof(group_gravity_t));
+    assert(aux != NULL);
+    aux->G = G;
+    aux->bodies = bodies;
+    aux->x = NULL;
+    aux->y = NULL;
+    aux->mass = NULL;
+    aux->fx = NULL;
+    aux->fy = NULL;
+    aux->capacity = 0;
+    scene_add_kind_force_creator(scene, FORCE_GRAVITY, (force_creator_t)group_gravity, aux, bodies, (free_func_t)group_gravity_free);
 }
 
 void spring(void *aux)
@@ -126,34 +305,58 @@ void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2)
     fb->aux = NULL;
     fb->freer = NULL;
     fb->collided = 0;
-    scene_add_bodies_force_creator(scene, (force_creator_t)spring, fb, bodies, (free_func_t)force_bodies_free);
+    scene_add_kind_force_creator(scene, FORCE_SPRING, (force_creator_t)spring, fb, bodies, (free_func_t)force_bodies_free);
 }
 
-void drag(void *aux)
+void apply_drag(body_t *body, double gamma)
 {
-    force_bodies_t *fb = aux;
-    double gamma = fb->force_const;
-    body_t *body = list_get(fb->bodies, 0);
     // applies basic drag by scaling velocity by gamma and applies to body
     vector_t force = vec_multiply(gamma, body_get_velocity(body));
     body_add_force(body, vec_negate(force));
 }
 
-void create_drag(scene_t *scene, double gamma, body_t *body)
+void drag(void *aux)
+{
+    force_bodies_t *fb = aux;
+    apply_drag(list_get(fb->bodies, 0), fb->force_const);
+}
+
+void group_drag(void *aux)
+{
+    force_bodies_t *fb = aux;
+    double gamma = fb->force_const;
+    size_t n = list_size(fb->bodies);
+    for (size_t i = 0; i < n; i++)
+    {
+        apply_drag(list_get(fb->bodies, i), gamma);
+    }
+}
+
+// adds a force creator whose only state is a constant and its bodies
+void add_constant_force(scene_t *scene, force_kind_t kind, force_creator_t forcer, double force_const, list_t *bodies)
 {
-    // creates auxiliary state struct and passes to scene force creator
     force_bodies_t *fb = malloc(sizeof(force_bodies_t));
     assert(fb != NULL);
-    fb->force_const = gamma;
-    list_t *bodies = list_init(1, NULL);
-    list_add(bodies, body);
+    fb->force_const = force_const;
     fb->bodies = bodies;
     fb->handler = NULL;
     fb->ball_collision = false;
     fb->aux = NULL;
     fb->freer = NULL;
     fb->collided = 0;
-    scene_add_bodies_force_creator(scene, (force_creator_t)drag, fb, bodies, (free_func_t)force_bodies_free);
+    scene_add_kind_force_creator(scene, kind, forcer, fb, bodies, (free_func_t)force_bodies_free);
+}
+
+void create_drag(scene_t *scene, double gamma, body_t *body)
+{
+    list_t *bodies = list_init(1, NULL);
+    list_add(bodies, body);
+    add_constant_force(scene, FORCE_DRAG, (force_creator_t)drag, gamma, bodies);
+}
+
+void create_group_drag(scene_t *scene, double gamma, list_t *bodies)
+{
+    add_constant_force(scene, FORCE_DRAG, (force_creator_t)group_drag, gamma, bodies);
 }
 
 double get_length(vector_t v)
@@ -169,15 +372,18 @@ void collision(void *aux)
     double v1 = vec_magnitude(body_get_velocity(b1));
     body_t *b2 = list_get(fb->bodies, 1);
     double v2 = vec_magnitude(body_get_velocity(b2));
-    list_t *s1 = body_get_shape(b1);
-    list_t *s2 = body_get_shape(b2);
     //if the two bodies collide, call the collision handler
     collision_info_t col;
     if (fb->ball_collision) {
         col = find_collision_balls(b1, b2);
     }
+    else if (get_length(vec_subtract(body_get_centroid(b1), body_get_centroid(b2))) <=
+             body_get_radius(b1) + body_get_radius(b2) + MIN_DIST) {
+        col = find_collision(body_borrow_shape(b1), body_borrow_shape(b2));
+    }
     else {
-        col = find_collision(s1, s2);
+        // the bounding circles don't touch, so neither can the shapes
+        col.collided = false;
     }
     if (col.collided && !(fb->collided))
     {
@@ -190,10 +396,10 @@ void collision(void *aux)
     {
         fb->collided = 0;
     }
-    list_free(s1);
-    list_free(s2);
 }
 
+void physics_collision(body_t *body1, body_t *body2, vector_t axis, void *aux);
+
 void create_collision(scene_t *scene, body_t *body1, body_t *body2, collision_handler_t handler, void *aux, free_func_t freer, bool ball_collision)
 {
     force_bodies_t *fb = malloc(sizeof(force_bodies_t));
@@ -208,7 +414,9 @@ void create_collision(scene_t *scene, body_t *body1, body_t *body2, collision_ha
     fb->aux = aux;
     fb->freer = freer;
     fb->collided = 0;
-    scene_add_bodies_force_creator(scene, (force_creator_t)collision, fb, bodies, (free_func_t)force_bodies_free);
+    force_kind_t kind = handler == (collision_handler_t)physics_collision
+        ? FORCE_PHYSICS_COLLISION : FORCE_COLLISION;
+    scene_add_kind_force_creator(scene, kind, (force_creator_t)collision, fb, bodies, (free_func_t)force_bodies_free);
 }
 
 void destructive_collision(body_t *body1, body_t *body2, vector_t axis, void *aux)
@@ -319,13 +527,10 @@ void create_physics_collision_with_translation(scene_t *scene, double elasticity
     create_collision(scene, body1, body2, (collision_handler_t)physics_collision, cv, (free_func_t)collision_values_free, false);
 }
 
-void ideal_friction(void *aux)
+void apply_friction(body_t *body, double mug)
 {
-    force_bodies_t *fb = aux;
-    double mug = fb->force_const;
-    body_t *body = list_get(fb->bodies, 0);
     double mass = body_get_mass(body);
-    if (vec_magnitude(body_get_velocity(body)) > 5) {
+    if (vec_magnitude(body_get_velocity(body)) > MIN_FRICTION_SPEED) {
         vector_t friction = vec_multiply(mass * mug, body_get_velocity(body));
         body_add_force(body, vec_negate(friction)); //friction acts opposite to the direction of motion
     }
@@ -334,18 +539,65 @@ void ideal_friction(void *aux)
     }
 }
 
+void ideal_friction(void *aux)
+{
+    force_bodies_t *fb = aux;
+    apply_friction(list_get(fb->bodies, 0), fb->force_const);
+}
+
+void group_friction(void *aux)
+{
+    force_bodies_t *fb = aux;
+    double mug = fb->force_const;
+    size_t n = list_size(fb->bodies);
+    for (size_t i = 0; i < n; i++)
+    {
+        apply_friction(list_get(fb->bodies, i), mug);
+    }
+}
+
 void create_ideal_friction(scene_t *scene, double mug, body_t *body)
 {
-    force_bodies_t *fb = malloc(sizeof(force_bodies_t));
-    assert(fb != NULL); // malloc worked!
-    fb->force_const = mug;
     list_t *bodies = list_init(1, NULL);
     list_add(bodies, body);
-    fb->bodies = bodies;
-    fb->handler = NULL;
-    fb->ball_collision = false;
-    fb->aux = NULL;
-    fb->freer = NULL;
-    fb->collided = 0;
-    scene_add_bodies_force_creator(scene, (force_creator_t)ideal_friction, fb, bodies, (free_func_t)force_bodies_free);
+    add_constant_force(scene, FORCE_IDEAL_FRICTION, (force_creator_t)ideal_friction, mug, bodies);
+}
+
+void create_group_friction(scene_t *scene, double mug, list_t *bodies)
+{
+    add_constant_force(scene, FORCE_IDEAL_FRICTION, (force_creator_t)group_friction, mug, bodies);
+}
+
+size_t scene_get_collision_flags(scene_t *scene, bool *flags, size_t max)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < scene_force_creators(scene); i++)
+    {
+        if (scene_get_forcer(scene, i) != (force_creator_t)collision)
+        {
+            continue;
+        }
+        force_bodies_t *fb = scene_get_force_aux(scene, i);
+        if (count < max)
+        {
+            flags[count] = fb->collided;
+        }
+        count++;
+    }
+    return count;
+}
+
+void scene_set_collision_flags(scene_t *scene, const bool *flags, size_t count)
+{
+    size_t restored = 0;
+    for (size_t i = 0; i < scene_force_creators(scene) && restored < count; i++)
+    {
+        if (scene_get_forcer(scene, i) != (force_creator_t)collision)
+        {
+            continue;
+        }
+        force_bodies_t *fb = scene_get_force_aux(scene, i);
+        fb->collided = flags[restored];
+        restored++;
+    }
 }
@@ -0,0 +1,169 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "binary_io.h"
+#include "input_log.h"
+
+const char INPUT_LOG_MAGIC[] = "PINP";
+const int INPUT_LOG_VERSION = 1;
+const size_t INITIAL_EVENTS = 256;
+// The low bit of an event's header byte is the device, the rest is the type
+const int DEVICE_BITS = 1;
+
+typedef struct input_log {
+    unsigned int seed;
+    double dt;
+    uint32_t ticks;
+    size_t size;
+    size_t capacity;
+    input_event_t *events;
+} input_log_t;
+
+input_log_t *input_log_init(unsigned int seed, double dt) {
+    input_log_t *log = malloc(sizeof(input_log_t));
+    assert(log != NULL);
+    log->seed = seed;
+    log->dt = dt;
+    log->ticks = 0;
+    log->size = 0;
+    log->capacity = INITIAL_EVENTS;
+    log->events = malloc(sizeof(input_event_t) * log->capacity);
+    assert(log->events != NULL);
+    return log;
+}
+
+void input_log_free(input_log_t *log) {
+    free(log->events);
+    free(log);
+}
+
+void input_log_add(input_log_t *log, input_event_t event) {
+    assert(log->size == 0 || event.tick >= log->events[log->size - 1].tick);
+    if (log->size == log->capacity) {
+        log->capacity *= 2;
+        log->events = realloc(log->events, sizeof(input_event_t) * log->capacity);
+        assert(log->events != NULL);
+    }
+    event.position = (vector_t){round(event.position.x), round(event.position.y)};
+    log->events[log->size++] = event;
+    if (event.tick > log->ticks) {
+        log->ticks = event.tick;
+    }
+}
+
+void input_log_set_ticks(input_log_t *log, uint32_t ticks) {
+    assert(log->size == 0 || ticks >= log->events[log->size - 1].tick);
+    log->ticks = ticks;
+}
+
+size_t input_log_size(input_log_t *log) {
+    return log->size;
+}
+
+input_event_t input_log_get(input_log_t *log, size_t index) {
+    assert(index < log->size);
+    return log->events[index];
+}
+
+unsigned int input_log_get_seed(input_log_t *log) {
+    return log->seed;
+}
+
+double input_log_get_dt(input_log_t *log) {
+    return log->dt;
+}
+
+uint32_t input_log_get_ticks(input_log_t *log) {
+    return log->ticks;
+}
+
+/**
+ * Returns whether an event has a held time worth saving.
+ * Mouse movements never do.
+ */
+bool has_held_time(input_event_t *event) {
+    return event->device == INPUT_KEY || event->type != MOUSE_MOVED;
+}
+
+bool input_log_save(input_log_t *log, const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    fwrite(INPUT_LOG_MAGIC, 1, strlen(INPUT_LOG_MAGIC), file);
+    write_uint(file, INPUT_LOG_VERSION, 1);
+    write_uint(file, log->seed, 4);
+    write_double(file, log->dt);
+    write_uint(file, log->ticks, 4);
+    write_uint(file, log->size, 4);
+    uint32_t last_tick = 0;
+    for (size_t i = 0; i < log->size; i++) {
+        input_event_t *event = &log->events[i];
+        write_varint(file, event->tick - last_tick);
+        last_tick = event->tick;
+        write_uint(file, event->device | (event->type << DEVICE_BITS), 1);
+        if (event->device == INPUT_KEY) {
+            write_uint(file, (unsigned char)event->key, 1);
+        }
+        else {
+            write_uint(file, (uint16_t)(int16_t)event->position.x, 2);
+            write_uint(file, (uint16_t)(int16_t)event->position.y, 2);
+        }
+        if (has_held_time(event)) {
+            write_double(file, event->held_time);
+        }
+    }
+    bool written = !ferror(file);
+    return fclose(file) == 0 && written;
+}
+
+input_log_t *input_log_load(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+    char magic[sizeof(INPUT_LOG_MAGIC)] = {0};
+    uint64_t version, seed, ticks, size;
+    double dt;
+    if (fread(magic, 1, strlen(INPUT_LOG_MAGIC), file) != strlen(INPUT_LOG_MAGIC)
+        || strcmp(magic, INPUT_LOG_MAGIC) != 0
+        || !read_uint(file, &version, 1) || version != INPUT_LOG_VERSION
+        || !read_uint(file, &seed, 4) || !read_double(file, &dt)
+        || !read_uint(file, &ticks, 4) || !read_uint(file, &size, 4)) {
+        fclose(file);
+        return NULL;
+    }
+
+    input_log_t *log = input_log_init(seed, dt);
+    uint32_t tick = 0;
+    for (uint64_t i = 0; i < size; i++) {
+        uint32_t delta;
+        uint64_t header, value;
+        input_event_t event = {0};
+        if (!read_varint(file, &delta) || !read_uint(file, &header, 1)) break;
+        tick += delta;
+        event.tick = tick;
+        event.device = header & ((1 << DEVICE_BITS) - 1);
+        event.type = header >> DEVICE_BITS;
+        if (event.device == INPUT_KEY) {
+            if (!read_uint(file, &value, 1)) break;
+            event.key = value;
+        }
+        else {
+            uint64_t x, y;
+            if (!read_uint(file, &x, 2) || !read_uint(file, &y, 2)) break;
+            event.position = (vector_t){(int16_t)x, (int16_t)y};
+        }
+        if (has_held_time(&event) && !read_double(file, &event.held_time)) break;
+        input_log_add(log, event);
+    }
+    fclose(file);
+    if (log->size != size || tick > ticks) {
+        input_log_free(log);
+        return NULL;
+    }
+    log->ticks = ticks;
+    return log;
+}
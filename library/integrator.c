@@ -0,0 +1,18 @@
+#include <assert.h>
+#include <stdbool.h>
+#include "integrator.h"
+
+size_t integrator_stages(integrator_t integrator) {
+    switch (integrator) {
+        case INTEGRATOR_TRAPEZOID:
+        case INTEGRATOR_SEMI_IMPLICIT_EULER:
+            return 1;
+        case INTEGRATOR_VELOCITY_VERLET:
+            return 2;
+        case INTEGRATOR_RK4:
+            return 4;
+        default:
+            assert(false && "not a concrete integrator");
+            return 1;
+    }
+}
@@ -1,26 +1,21 @@
 #include <math.h>
 #include <stdbool.h>
-#include <SDL2/SDL.h>
-#include <SDL2/SDL2_gfxPrimitives.h>
-#include <SDL2/SDL_image.h>
-#include <SDL2/SDL_ttf.h>
+#include <stdio.h>
 #include "mouse.h"
 #include "ball.h"
 
 
 
-void mouse_handle_firing(int type, body_t *cue, ball_t *cueball, scene_t *scene, double held_time) {
+void mouse_handle_firing(mouse_event_type_t type, vector_t mouse, body_t *cue, ball_t *cueball, scene_t *scene, double held_time) {
     // if mouse moving, rotate cue appropriately
-    if (type == SDL_MOUSEMOTION) {
-        //Get mouse position
-        int x, y;
-        SDL_GetMouseState(&x, &y);
+    if (type == MOUSE_MOVED) {
+        double x = mouse.x, y = mouse.y;
 
-        double opposite = body_get_centroid(ball_get_body(cueball)).y - (double)y;
-        double hypotenuse = sqrt((body_get_centroid(ball_get_body(cueball)).x - (double)x) *
-                                (body_get_centroid(ball_get_body(cueball)).x - (double)x) +
-                                (body_get_centroid(ball_get_body(cueball)).y - (double)y) *
-                                (body_get_centroid(ball_get_body(cueball)).y - (double)y));
+        double opposite = body_get_centroid(ball_get_body(cueball)).y - y;
+        double hypotenuse = sqrt((body_get_centroid(ball_get_body(cueball)).x - x) *
+                                (body_get_centroid(ball_get_body(cueball)).x - x) +
+                                (body_get_centroid(ball_get_body(cueball)).y - y) *
+                                (body_get_centroid(ball_get_body(cueball)).y - y));
         double angle = (asin(opposite / hypotenuse));
 
         if (x > body_get_centroid(ball_get_body(cueball)).x) { //&& y < body_get_centroid(ball_get_body(cueball)).y) {
@@ -33,51 +28,45 @@ void mouse_handle_firing(int type, body_t *cue, ball_t *cueball, scene_t *scene,
     }
 }
  
-bool mouse_within(vector_t min, vector_t max) {
-    int x, y;
-    SDL_GetMouseState(&x, &y);
-    if (x > min.x && x < max.x && y > min.y && y < max.y) {
+bool mouse_within(vector_t mouse, vector_t min, vector_t max) {
+    if (mouse.x > min.x && mouse.x < max.x && mouse.y > min.y && mouse.y < max.y) {
         return true;
     }
     return false;
 }
 
-void mouse_handle_placing (int type, ball_t *cueball, scene_t *scene, const vector_t *area) {
+void mouse_handle_placing (mouse_event_type_t type, vector_t mouse, ball_t *cueball, scene_t *scene, const vector_t *area) {
 
-    if (type == SDL_MOUSEMOTION) {
-        //Get mouse position
-        int x, y;
-        SDL_GetMouseState(&x, &y);
-        body_set_centroid(ball_get_body(cueball), (vector_t){(double)x, (double)y});
+    if (type == MOUSE_MOVED) {
+        body_set_centroid(ball_get_body(cueball), mouse);
     }
-    else if (type == SDL_MOUSEBUTTONUP) {
+    else if (type == MOUSE_RELEASED) {
         double radius = ball_get_radius(cueball);
         vector_t min = vec_add(area[0], (vector_t){radius, radius});
         vector_t max = vec_subtract(area[1], (vector_t){0, radius});
         vector_t centroid = body_get_centroid(ball_get_body(cueball));
-        if (mouse_within(min, max) && vec_within(centroid, min, max)) {
+        if (mouse_within(mouse, min, max) && vec_within(centroid, min, max)) {
             //printf("set state\n");
             scene_set_state(scene, 2);
         }
     }
 }
 
-bool mouse_handle_button(int type, const vector_t *box) {
-    if(type == SDL_MOUSEBUTTONDOWN) {
-        //Get mouse position
-        return mouse_within(box[0], box[1]);
+bool mouse_handle_button(mouse_event_type_t type, vector_t mouse, const vector_t *box) {
+    if(type == MOUSE_PRESSED) {
+        return mouse_within(mouse, box[0], box[1]);
     }
     return false;
 }
 
-void mouse_handle_menu (int type, scene_t *scene, const vector_t *box1, const vector_t *box2) {
-    // right now both buttons go to multiplayer
-    if (mouse_handle_button(type, box1)) {
-        //go to game type singleplayer
+void mouse_handle_menu (mouse_event_type_t type, vector_t mouse, scene_t *scene, const vector_t *box1, const vector_t *box2) {
+    if (mouse_handle_button(type, mouse, box1)) {
+        //go to game type singleplayer, with the computer as the second player
+        player_set_computer(scene_get_player(scene, 1), true);
         scene_set_state(scene, 1);
         printf("Button 1 clicked!\n");
     }
-    else if (mouse_handle_button(type, box2)) {
+    else if (mouse_handle_button(type, mouse, box2)) {
         //go to game type multiplayer
         scene_set_state(scene, 1);
         printf("Button 2 clicked!\n");
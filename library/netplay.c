@@ -0,0 +1,331 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "netplay.h"
+#include "table.h"
+#include "timing.h"
+
+// The first byte of every packet, so stray packets are ignored
+const uint8_t NETPLAY_PACKET_TAG = 'N';
+// Each input takes at most 41 bytes, so this many fit in a packet with its header
+#define MAX_PACKET_INPUTS 48
+// Marks an empty slot in the ring of the other player's input
+const uint32_t NO_TICK = UINT32_MAX;
+
+typedef struct netplay {
+    scene_t *scene;
+    int local_player;
+    transport_t *transport;
+    double dt;
+    size_t max_rollback;
+    /** How many ticks have been simulated */
+    uint32_t tick;
+    /** The local input for tick t is at t % NETPLAY_WINDOW, from local_acked up to tick */
+    net_input_t local_inputs[NETPLAY_WINDOW];
+    /** How many ticks of local input the other player has said they have */
+    uint32_t local_acked;
+    /** The other player's input for tick t is at t % NETPLAY_WINDOW if remote_ticks there is t */
+    net_input_t remote_inputs[NETPLAY_WINDOW];
+    uint32_t remote_ticks[NETPLAY_WINDOW];
+    /** How many ticks of the other player's input have all arrived */
+    uint32_t remote_confirmed;
+    /** Where the other player aimed last, which they are predicted to keep doing */
+    bool has_remote_aim;
+    uint32_t remote_aim_tick;
+    double remote_aim;
+    /** The table before tick t is at t % NETPLAY_WINDOW */
+    table_state_t snapshots[NETPLAY_WINDOW];
+    /** The first tick that has to be simulated again, or NO_TICK */
+    uint32_t rollback_from;
+    netplay_stats_t stats;
+} netplay_t;
+
+netplay_t *netplay_init(
+    scene_t *scene,
+    int local_player,
+    transport_t *transport,
+    double dt,
+    size_t max_rollback
+) {
+    assert(local_player == 0 || local_player == 1);
+    assert(max_rollback > 0 && max_rollback < NETPLAY_WINDOW);
+    netplay_t *netplay = malloc(sizeof(netplay_t));
+    assert(netplay != NULL);
+    netplay->scene = scene;
+    netplay->local_player = local_player;
+    netplay->transport = transport;
+    netplay->dt = dt;
+    netplay->max_rollback = max_rollback;
+    netplay->tick = 0;
+    netplay->local_acked = 0;
+    for (size_t i = 0; i < NETPLAY_WINDOW; i++) {
+        netplay->remote_ticks[i] = NO_TICK;
+    }
+    netplay->remote_confirmed = 0;
+    netplay->has_remote_aim = false;
+    netplay->remote_aim_tick = 0;
+    netplay->remote_aim = 0;
+    netplay->rollback_from = NO_TICK;
+    memset(&netplay->stats, 0, sizeof(netplay->stats));
+    return netplay;
+}
+
+void netplay_free(netplay_t *netplay) {
+    free(netplay);
+}
+
+uint32_t netplay_get_tick(netplay_t *netplay) {
+    return netplay->tick;
+}
+
+uint32_t netplay_get_confirmed_tick(netplay_t *netplay) {
+    return netplay->remote_confirmed < netplay->tick ? netplay->remote_confirmed : netplay->tick;
+}
+
+netplay_stats_t netplay_get_stats(netplay_t *netplay) {
+    return netplay->stats;
+}
+
+// Packets are written little-endian, whatever the machine
+void put_uint(uint8_t **cursor, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        *(*cursor)++ = (value >> (8 * i)) & 0xff;
+    }
+}
+
+bool get_uint(const uint8_t **cursor, const uint8_t *end, uint64_t *value, int bytes) {
+    if (end - *cursor < bytes) {
+        return false;
+    }
+    *value = 0;
+    for (int i = 0; i < bytes; i++) {
+        *value |= (uint64_t)*(*cursor)++ << (8 * i);
+    }
+    return true;
+}
+
+void put_double(uint8_t **cursor, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put_uint(cursor, bits, 8);
+}
+
+bool get_double(const uint8_t **cursor, const uint8_t *end, double *value) {
+    uint64_t bits;
+    if (!get_uint(cursor, end, &bits, 8)) return false;
+    memcpy(value, &bits, sizeof(bits));
+    return true;
+}
+
+/**
+ * Writes an input, leaving out the values its actions do not use.
+ */
+void put_input(uint8_t **cursor, const net_input_t *input) {
+    put_uint(cursor, input->actions, 1);
+    if (input->actions & (NET_AIM | NET_SHOOT)) {
+        put_double(cursor, input->angle);
+    }
+    if (input->actions & NET_PLACE) {
+        put_double(cursor, input->position.x);
+        put_double(cursor, input->position.y);
+    }
+    if (input->actions & NET_SHOOT) {
+        put_double(cursor, input->power);
+        put_double(cursor, input->pull_back);
+    }
+}
+
+bool get_input(const uint8_t **cursor, const uint8_t *end, net_input_t *input) {
+    uint64_t actions;
+    memset(input, 0, sizeof(*input));
+    if (!get_uint(cursor, end, &actions, 1)) return false;
+    input->actions = actions;
+    return (!(actions & (NET_AIM | NET_SHOOT)) || get_double(cursor, end, &input->angle))
+        && (!(actions & NET_PLACE) || (get_double(cursor, end, &input->position.x)
+                                       && get_double(cursor, end, &input->position.y)))
+        && (!(actions & NET_SHOOT) || (get_double(cursor, end, &input->power)
+                                       && get_double(cursor, end, &input->pull_back)));
+}
+
+/**
+ * Sends the local input the other player has not acknowledged, oldest first,
+ * along with how much of their input has arrived.
+ */
+void send_inputs(netplay_t *netplay) {
+    uint8_t packet[TRANSPORT_MAX_PACKET];
+    uint8_t *cursor = packet;
+    uint32_t count = netplay->tick - netplay->local_acked;
+    if (count > MAX_PACKET_INPUTS) {
+        count = MAX_PACKET_INPUTS;
+    }
+    put_uint(&cursor, NETPLAY_PACKET_TAG, 1);
+    put_uint(&cursor, netplay->remote_confirmed, 4);
+    put_uint(&cursor, netplay->local_acked, 4);
+    put_uint(&cursor, count, 1);
+    for (uint32_t i = 0; i < count; i++) {
+        put_input(&cursor, &netplay->local_inputs[(netplay->local_acked + i) % NETPLAY_WINDOW]);
+    }
+    transport_send(netplay->transport, packet, cursor - packet);
+}
+
+/**
+ * Stores the other player's input for a tick, noting a rollback if it changes the past.
+ */
+void store_remote_input(netplay_t *netplay, uint32_t tick, const net_input_t *input) {
+    // Only the ticks a rollback can reach and the ones after fit in the ring
+    uint32_t oldest = netplay->tick > netplay->max_rollback ? netplay->tick - netplay->max_rollback : 0;
+    size_t slot = tick % NETPLAY_WINDOW;
+    if (tick < netplay->remote_confirmed || tick >= oldest + NETPLAY_WINDOW
+        || netplay->remote_ticks[slot] == tick) {
+        return;
+    }
+    netplay->remote_inputs[slot] = *input;
+    netplay->remote_ticks[slot] = tick;
+    if ((input->actions & NET_AIM) && (!netplay->has_remote_aim || tick >= netplay->remote_aim_tick)) {
+        netplay->has_remote_aim = true;
+        netplay->remote_aim_tick = tick;
+        netplay->remote_aim = input->angle;
+    }
+    // Ticks already simulated predicted nothing but aiming,
+    // and aiming does not change how the balls move, since shots put the cue back, see table_set_cue()
+    if (tick < netplay->tick && (input->actions & (NET_PLACE | NET_SHOOT))
+        && tick < netplay->rollback_from) {
+        netplay->rollback_from = tick;
+    }
+}
+
+void receive_inputs(netplay_t *netplay) {
+    uint8_t packet[TRANSPORT_MAX_PACKET];
+    size_t size;
+    while ((size = transport_receive(netplay->transport, packet, sizeof(packet))) > 0) {
+        const uint8_t *cursor = packet, *end = packet + size;
+        uint64_t tag, ack, first, count;
+        if (!get_uint(&cursor, end, &tag, 1) || tag != NETPLAY_PACKET_TAG
+            || !get_uint(&cursor, end, &ack, 4) || !get_uint(&cursor, end, &first, 4)
+            || !get_uint(&cursor, end, &count, 1)) {
+            continue;
+        }
+        if (ack > netplay->local_acked && ack <= netplay->tick) {
+            netplay->local_acked = ack;
+        }
+        for (uint64_t i = 0; i < count; i++) {
+            net_input_t input;
+            if (!get_input(&cursor, end, &input)) break;
+            store_remote_input(netplay, first + i, &input);
+        }
+    }
+    while (netplay->remote_ticks[netplay->remote_confirmed % NETPLAY_WINDOW] == netplay->remote_confirmed) {
+        netplay->remote_confirmed++;
+    }
+}
+
+/**
+ * Applies a player's input to the table, if it is their turn and the table allows it.
+ */
+void apply_input(scene_t *scene, int player, const net_input_t *input) {
+    if (scene_get_turn(scene) != player) {
+        return;
+    }
+    if ((input->actions & NET_PLACE) && scene_get_state(scene) == PLACING) {
+        table_place_cue_ball(scene, input->position);
+    }
+    if ((input->actions & NET_SHOOT) && scene_get_state(scene) == FIRING) {
+        update_game_state(scene);
+        if (table_get_cue(scene) != NULL) {
+            // The cue is rebuilt, so how each side moved it while aiming does not matter
+            table_set_cue(scene, input->angle, input->pull_back);
+            table_shoot(scene, input->power);
+        }
+    }
+    else if ((input->actions & NET_AIM) && scene_get_state(scene) == FIRING
+             && table_get_cue(scene) != NULL) {
+        table_aim(scene, input->angle);
+    }
+}
+
+/**
+ * Saves the table, applies both players' input for the current tick and simulates it.
+ */
+void simulate_tick(netplay_t *netplay) {
+    uint32_t tick = netplay->tick;
+    size_t slot = tick % NETPLAY_WINDOW;
+    table_save(netplay->scene, &netplay->snapshots[slot]);
+
+    net_input_t remote = {0};
+    if (netplay->remote_ticks[slot] == tick) {
+        remote = netplay->remote_inputs[slot];
+    }
+    else if (netplay->has_remote_aim) {
+        remote = (net_input_t) {.actions = NET_AIM, .angle = netplay->remote_aim};
+    }
+    // Only one player's input is used per tick, so the order does not matter
+    apply_input(netplay->scene, netplay->local_player, &netplay->local_inputs[slot]);
+    apply_input(netplay->scene, 1 - netplay->local_player, &remote);
+
+    scene_tick(netplay->scene, netplay->dt);
+    update_game_state(netplay->scene);
+    table_park_sunk_balls(netplay->scene);
+    netplay->tick++;
+}
+
+/**
+ * Puts the table back as it was before the first tick that changed,
+ * and simulates from there to the present again.
+ */
+void roll_back(netplay_t *netplay) {
+    struct timespec start = timing_now();
+    uint32_t present = netplay->tick;
+    size_t ticks = present - netplay->rollback_from;
+    table_load(netplay->scene, &netplay->snapshots[netplay->rollback_from % NETPLAY_WINDOW]);
+    netplay->tick = netplay->rollback_from;
+    while (netplay->tick < present) {
+        simulate_tick(netplay);
+    }
+
+    netplay_stats_t *stats = &netplay->stats;
+    double seconds = seconds_since(start);
+    stats->rollbacks++;
+    stats->resimulated_ticks += ticks;
+    stats->rollback_seconds += seconds;
+    if (ticks > stats->max_resimulated_ticks) {
+        stats->max_resimulated_ticks = ticks;
+    }
+    if (seconds > stats->max_rollback_seconds) {
+        stats->max_rollback_seconds = seconds;
+    }
+}
+
+/**
+ * Takes the other player's input that has arrived, rolling back if it changes the past.
+ */
+void catch_up(netplay_t *netplay) {
+    receive_inputs(netplay);
+    if (netplay->rollback_from < netplay->tick) {
+        roll_back(netplay);
+    }
+    netplay->rollback_from = NO_TICK;
+}
+
+void netplay_poll(netplay_t *netplay) {
+    catch_up(netplay);
+    send_inputs(netplay);
+}
+
+bool netplay_advance(netplay_t *netplay, net_input_t input) {
+    catch_up(netplay);
+
+    // Wait if the other player's input is too far behind to roll back to,
+    // or the local input they have not acknowledged would not fit in the ring
+    uint32_t behind = netplay->tick - netplay_get_confirmed_tick(netplay);
+    bool advance = behind < netplay->max_rollback
+                   && netplay->tick - netplay->local_acked < NETPLAY_WINDOW;
+    if (advance) {
+        netplay->local_inputs[netplay->tick % NETPLAY_WINDOW] = input;
+        simulate_tick(netplay);
+    }
+    else {
+        netplay->stats.stalls++;
+    }
+    send_inputs(netplay);
+    return advance;
+}
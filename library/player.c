@@ -18,6 +18,8 @@ typedef struct player {
     int foul;
     vector_t coords;
     char *name;
+    //true if the computer takes this player's shots
+    bool computer;
     //int color; maybe for colors game mode
 } player_t;
 
@@ -25,11 +27,13 @@ player_t *player_init (char *info, vector_t coords, char*name) {
     player_t *pl = malloc(sizeof(player_t));
     assert(pl != NULL);
     pl->info = info;
-    pl->balls = list_init(16, (free_func_t)ball_free);
+    // the balls belong to the scene, so the list must not free them
+    pl->balls = list_init(16, NULL);
     pl->turn_state = 0;
     pl->foul = 0;
     pl->coords = coords;
     pl->name = name;
+    pl->computer = false;
     return pl;
 }
 
@@ -91,7 +95,15 @@ int player_foul(player_t *player) {
     return player->foul;
 }
 
+bool player_is_computer(player_t *player) {
+    return player->computer;
+}
+
+void player_set_computer(player_t *player, bool computer) {
+    player->computer = computer;
+}
+
 void player_free (player_t *player) {
-    free(player->balls);
+    list_free(player->balls);
     free(player);
 }
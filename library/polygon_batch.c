@@ -0,0 +1,143 @@
+#include <assert.h>
+#include <stdlib.h>
+#include "polygon_batch.h"
+
+const size_t INITIAL_VERTICES = 256;
+
+typedef struct polygon_batch {
+    vector_t scene_center;
+    double scale;
+    vector_t window_center;
+    // -1 to flip the y axis, 1 to keep it
+    double y_direction;
+    Uint8 alpha;
+    size_t size;
+    size_t num_vertices;
+    size_t vertex_capacity;
+    size_t num_indices;
+    size_t index_capacity;
+    SDL_Vertex *vertices;
+    int *indices;
+} polygon_batch_t;
+
+polygon_batch_t *polygon_batch_init(void) {
+    polygon_batch_t *batch = malloc(sizeof(polygon_batch_t));
+    assert(batch != NULL);
+    polygon_batch_set_pixel_transform(batch);
+    batch->alpha = 255;
+    batch->size = 0;
+    batch->num_vertices = 0;
+    batch->vertex_capacity = INITIAL_VERTICES;
+    batch->num_indices = 0;
+    batch->index_capacity = 3 * INITIAL_VERTICES;
+    batch->vertices = malloc(sizeof(SDL_Vertex) * batch->vertex_capacity);
+    batch->indices = malloc(sizeof(int) * batch->index_capacity);
+    assert(batch->vertices != NULL && batch->indices != NULL);
+    return batch;
+}
+
+void polygon_batch_free(polygon_batch_t *batch) {
+    free(batch->vertices);
+    free(batch->indices);
+    free(batch);
+}
+
+void polygon_batch_clear(polygon_batch_t *batch) {
+    batch->size = 0;
+    batch->num_vertices = 0;
+    batch->num_indices = 0;
+}
+
+void polygon_batch_set_transform(
+    polygon_batch_t *batch, vector_t scene_center, double scale, vector_t window_center
+) {
+    batch->scene_center = scene_center;
+    batch->scale = scale;
+    batch->window_center = window_center;
+    batch->y_direction = -1;
+}
+
+void polygon_batch_set_pixel_transform(polygon_batch_t *batch) {
+    batch->scene_center = VEC_ZERO;
+    batch->scale = 1;
+    batch->window_center = VEC_ZERO;
+    batch->y_direction = 1;
+}
+
+void polygon_batch_set_alpha(polygon_batch_t *batch, Uint8 alpha) {
+    batch->alpha = alpha;
+}
+
+/**
+ * Makes room for a polygon with n vertices, doubling the arrays as needed.
+ */
+void reserve(polygon_batch_t *batch, size_t n) {
+    // A fan around the center adds one vertex and one triangle per side
+    while (batch->num_vertices + n + 1 > batch->vertex_capacity) {
+        batch->vertex_capacity *= 2;
+        batch->vertices = realloc(batch->vertices, sizeof(SDL_Vertex) * batch->vertex_capacity);
+        assert(batch->vertices != NULL);
+    }
+    while (batch->num_indices + 3 * n > batch->index_capacity) {
+        batch->index_capacity *= 2;
+        batch->indices = realloc(batch->indices, sizeof(int) * batch->index_capacity);
+        assert(batch->indices != NULL);
+    }
+}
+
+void polygon_batch_add(polygon_batch_t *batch, list_t *points, rgb_color_t color) {
+    size_t n = list_size(points);
+    assert(n >= 3);
+    assert(0 <= color.r && color.r <= 1);
+    assert(0 <= color.g && color.g <= 1);
+    assert(0 <= color.b && color.b <= 1);
+    reserve(batch, n);
+
+    SDL_Color fill = {color.r * 255, color.g * 255, color.b * 255, batch->alpha};
+    size_t center = batch->num_vertices;
+    SDL_Vertex *vertex = &batch->vertices[center];
+    float sum_x = 0, sum_y = 0;
+    for (size_t i = 1; i <= n; i++) {
+        vector_t *point = list_get(points, i - 1);
+        vertex[i].position.x = batch->window_center.x
+            + batch->scale * (point->x - batch->scene_center.x);
+        // Flip y axis if positive y is up in the scene, since it is down on the screen
+        vertex[i].position.y = batch->window_center.y
+            + batch->y_direction * batch->scale * (point->y - batch->scene_center.y);
+        vertex[i].color = fill;
+        vertex[i].tex_coord = (SDL_FPoint) {0, 0};
+        sum_x += vertex[i].position.x;
+        sum_y += vertex[i].position.y;
+    }
+    vertex[0].position = (SDL_FPoint) {sum_x / n, sum_y / n};
+    vertex[0].color = fill;
+    vertex[0].tex_coord = (SDL_FPoint) {0, 0};
+
+    int *index = &batch->indices[batch->num_indices];
+    for (size_t i = 0; i < n; i++) {
+        index[3 * i] = center;
+        index[3 * i + 1] = center + 1 + i;
+        index[3 * i + 2] = center + 1 + (i + 1) % n;
+    }
+    batch->num_vertices += n + 1;
+    batch->num_indices += 3 * n;
+    batch->size++;
+}
+
+size_t polygon_batch_size(polygon_batch_t *batch) {
+    return batch->size;
+}
+
+void polygon_batch_draw(polygon_batch_t *batch, SDL_Renderer *renderer) {
+    if (batch->size == 0) return;
+    // Untextured geometry is drawn with the renderer's draw blend mode
+    SDL_BlendMode blend_mode;
+    SDL_GetRenderDrawBlendMode(renderer, &blend_mode);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_RenderGeometry(
+        renderer, NULL,
+        batch->vertices, batch->num_vertices,
+        batch->indices, batch->num_indices
+    );
+    SDL_SetRenderDrawBlendMode(renderer, blend_mode);
+}
@@ -0,0 +1,251 @@
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "preview.h"
+#include "ball.h"
+#include "forces.h"
+#include "table.h"
+#include "timing.h"
+
+// Aims closer together than this share a cached path
+const double PREVIEW_ANGLE_STEP = 0.001;
+const double PREVIEW_POWER_STEP = 0.05;
+#define CACHED_PATHS 32
+// The most vertices kept of a cushion or pocket
+#define OBSTACLE_VERTICES 8
+// How many steps are simulated between looks at the clock
+const int STEPS_PER_CHECK = 32;
+
+/**
+ * A cushion or pocket, copied out of the scene.
+ */
+typedef struct obstacle {
+    size_t size;
+    vector_t points[OBSTACLE_VERTICES];
+} obstacle_t;
+
+/**
+ * How far one aim has been simulated.
+ */
+typedef struct preview_path {
+    bool used;
+    long angle_key;
+    long power_key;
+    uint64_t last_used;
+    vector_t position;
+    vector_t velocity;
+    aim_preview_t result;
+} preview_path_t;
+
+typedef struct preview {
+    double dt;
+    bool has_table;
+    double radius;
+    double speed_per_power;
+    vector_t balls[TABLE_BALLS];
+    obstacle_t cushions[TABLE_CUSHIONS];
+    obstacle_t pockets[TABLE_POCKETS];
+    preview_path_t paths[CACHED_PATHS];
+    preview_path_t *current;
+    // counts calls to preview_aim(), to find the least recently used path
+    uint64_t clock;
+} preview_t;
+
+preview_t *preview_init(double dt) {
+    assert(dt > 0);
+    preview_t *preview = malloc(sizeof(preview_t));
+    assert(preview != NULL);
+    preview->dt = dt;
+    preview->has_table = false;
+    preview->current = NULL;
+    preview->clock = 0;
+    for (size_t i = 0; i < CACHED_PATHS; i++) {
+        preview->paths[i].used = false;
+    }
+    return preview;
+}
+
+void preview_free(preview_t *preview) {
+    free(preview);
+}
+
+void copy_obstacle(body_t *body, obstacle_t *obstacle) {
+    list_t *shape = body_borrow_shape(body);
+    obstacle->size = list_size(shape);
+    assert(obstacle->size <= OBSTACLE_VERTICES);
+    for (size_t i = 0; i < obstacle->size; i++) {
+        obstacle->points[i] = *(vector_t *)list_get(shape, i);
+    }
+}
+
+void preview_set_table(preview_t *preview, scene_t *scene) {
+    list_t *balls = scene_get_balls(scene);
+    bool moved = !preview->has_table;
+    for (size_t i = 0; i < TABLE_BALLS && !moved; i++) {
+        vector_t position = body_get_centroid(ball_get_body(list_get(balls, i)));
+        moved = position.x != preview->balls[i].x || position.y != preview->balls[i].y;
+    }
+    if (!moved) {
+        return;
+    }
+    for (size_t i = 0; i < TABLE_BALLS; i++) {
+        preview->balls[i] = body_get_centroid(ball_get_body(list_get(balls, i)));
+    }
+    for (size_t i = 0; i < TABLE_CUSHIONS; i++) {
+        copy_obstacle(table_get_cushion(scene, i), &preview->cushions[i]);
+    }
+    for (size_t i = 0; i < TABLE_POCKETS; i++) {
+        copy_obstacle(table_get_pocket_body(scene, i), &preview->pockets[i]);
+    }
+    preview->radius = ball_get_radius(list_get(balls, 0));
+    preview->speed_per_power = table_get_shot_speed(scene, 1);
+    preview->has_table = true;
+    for (size_t i = 0; i < CACHED_PATHS; i++) {
+        preview->paths[i].used = false;
+    }
+    preview->current = NULL;
+}
+
+void preview_aim(preview_t *preview, double angle, double power) {
+    assert(preview->has_table);
+    angle = fmod(angle, 2 * M_PI);
+    if (angle < 0) angle += 2 * M_PI;
+    long angle_key = lround(angle / PREVIEW_ANGLE_STEP);
+    long power_key = lround(power / PREVIEW_POWER_STEP);
+    preview->clock++;
+
+    preview_path_t *path = NULL;
+    for (size_t i = 0; i < CACHED_PATHS; i++) {
+        preview_path_t *cached = &preview->paths[i];
+        if (cached->used && cached->angle_key == angle_key && cached->power_key == power_key) {
+            path = cached;
+            break;
+        }
+        if (path == NULL || !cached->used || (path->used && cached->last_used < path->last_used)) {
+            path = cached;
+        }
+    }
+    path->last_used = preview->clock;
+    preview->current = path;
+    if (path->used && path->angle_key == angle_key && path->power_key == power_key) {
+        return;
+    }
+
+    // Start again from the rounded off aim, so the path matches its key whoever asked first
+    path->used = true;
+    path->angle_key = angle_key;
+    path->power_key = power_key;
+    // The cue ball goes the opposite way to where the cue points
+    double direction = angle_key * PREVIEW_ANGLE_STEP + M_PI;
+    double speed = preview->speed_per_power * power_key * PREVIEW_POWER_STEP;
+    path->position = preview->balls[0];
+    path->velocity = (vector_t) {speed * cos(direction), speed * sin(direction)};
+    path->result = (aim_preview_t) {
+        .contact = PREVIEW_UNKNOWN,
+        .start = path->position,
+        .end = path->position,
+        .radius = preview->radius,
+        .ball = -1
+    };
+}
+
+bool inside_obstacle(const obstacle_t *obstacle, vector_t point) {
+    bool inside = false;
+    for (size_t i = 0, j = obstacle->size - 1; i < obstacle->size; j = i++) {
+        vector_t a = obstacle->points[i], b = obstacle->points[j];
+        if ((a.y > point.y) != (b.y > point.y)
+            && point.x < (b.x - a.x) * (point.y - a.y) / (b.y - a.y) + a.x) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+/**
+ * Returns whether a ball centered at a point overlaps an obstacle.
+ */
+bool touches_obstacle(const obstacle_t *obstacle, vector_t center, double radius) {
+    if (inside_obstacle(obstacle, center)) {
+        return true;
+    }
+    for (size_t i = 0, j = obstacle->size - 1; i < obstacle->size; j = i++) {
+        vector_t a = obstacle->points[j];
+        vector_t edge = vec_subtract(obstacle->points[i], a);
+        double length_squared = vec_dot(edge, edge);
+        double t = length_squared == 0 ? 0 : vec_dot(vec_subtract(center, a), edge) / length_squared;
+        t = t < 0 ? 0 : t > 1 ? 1 : t;
+        vector_t closest = vec_add(a, vec_multiply(t, edge));
+        if (vec_magnitude(vec_subtract(center, closest)) < radius) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Moves the cue ball one tick the way body_tick() and the table's friction would,
+ * and records what it touches first.
+ */
+void step_path(preview_t *preview, preview_path_t *path) {
+    aim_preview_t *result = &path->result;
+    if (vec_magnitude(path->velocity) <= MIN_FRICTION_SPEED) {
+        result->contact = PREVIEW_STOPS;
+        return;
+    }
+    vector_t old_velocity = path->velocity;
+    path->velocity = vec_multiply(1 - FRICTION_CONST * preview->dt, old_velocity);
+    vector_t average = vec_multiply(0.5, vec_add(old_velocity, path->velocity));
+    path->position = vec_add(path->position, vec_multiply(preview->dt, average));
+    result->end = path->position;
+
+    for (int i = 1; i < TABLE_BALLS; i++) {
+        vector_t to_ball = vec_subtract(preview->balls[i], path->position);
+        if (vec_magnitude(to_ball) < 2 * preview->radius) {
+            result->contact = PREVIEW_BALL;
+            result->ball = i;
+            // The struck ball heads along the line between the centers,
+            // and the cue ball keeps whatever of its velocity is across that line
+            vector_t normal = vec_normalize(to_ball);
+            vector_t across = vec_subtract(path->velocity,
+                                           vec_multiply(vec_dot(path->velocity, normal), normal));
+            result->ball_direction = normal;
+            result->cue_direction = vec_magnitude(across) > MIN_FRICTION_SPEED
+                ? vec_normalize(across)
+                : VEC_ZERO;
+            return;
+        }
+    }
+    for (size_t i = 0; i < TABLE_POCKETS; i++) {
+        if (touches_obstacle(&preview->pockets[i], path->position, preview->radius)) {
+            result->contact = PREVIEW_POCKET;
+            return;
+        }
+    }
+    for (size_t i = 0; i < TABLE_CUSHIONS; i++) {
+        if (touches_obstacle(&preview->cushions[i], path->position, preview->radius)) {
+            result->contact = PREVIEW_CUSHION;
+            return;
+        }
+    }
+}
+
+bool preview_refine(preview_t *preview, double seconds) {
+    preview_path_t *path = preview->current;
+    assert(path != NULL);
+    struct timespec start = timing_now();
+    while (path->result.contact == PREVIEW_UNKNOWN) {
+        for (int i = 0; i < STEPS_PER_CHECK && path->result.contact == PREVIEW_UNKNOWN; i++) {
+            step_path(preview, path);
+        }
+        if (seconds_since(start) >= seconds) {
+            break;
+        }
+    }
+    return path->result.contact != PREVIEW_UNKNOWN;
+}
+
+aim_preview_t preview_get(preview_t *preview) {
+    assert(preview->current != NULL);
+    return preview->current->result;
+}
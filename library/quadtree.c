@@ -0,0 +1,240 @@
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "quadtree.h"
+
+// Points closer together than the smallest node at this depth
+// share a leaf instead of splitting forever.
+#define MAX_DEPTH 32
+#define INITIAL_NODES 64
+
+typedef struct node {
+    // the square this node covers
+    vector_t center;
+    double half_width;
+    // total mass and mass-weighted position sum, then center of mass
+    double mass;
+    vector_t center_of_mass;
+    // children by quadrant, or -1; only used by internal nodes
+    int children[4];
+    bool leaf;
+    // first point in a leaf, or -1; the rest are linked through next
+    int first;
+    int depth;
+} node_t;
+
+typedef struct quadtree {
+    node_t *nodes;
+    size_t num_nodes;
+    size_t node_cap;
+    // the next point in the same leaf, or -1
+    int *next;
+    size_t point_cap;
+    const vector_t *positions;
+    const double *masses;
+    size_t count;
+} quadtree_t;
+
+quadtree_t *quadtree_init(void) {
+    quadtree_t *tree = malloc(sizeof(quadtree_t));
+    assert(tree != NULL);
+    tree->nodes = malloc(INITIAL_NODES * sizeof(node_t));
+    assert(tree->nodes != NULL);
+    tree->num_nodes = 0;
+    tree->node_cap = INITIAL_NODES;
+    tree->next = NULL;
+    tree->point_cap = 0;
+    tree->positions = NULL;
+    tree->masses = NULL;
+    tree->count = 0;
+    return tree;
+}
+
+void quadtree_free(quadtree_t *tree) {
+    free(tree->nodes);
+    free(tree->next);
+    free(tree);
+}
+
+// adds an empty leaf and returns its index; may move the nodes array
+int add_node(quadtree_t *tree, vector_t center, double half_width, int depth) {
+    if (tree->num_nodes >= tree->node_cap) {
+        node_t *tmp = realloc(tree->nodes, 2 * tree->node_cap * sizeof(node_t));
+        assert(tmp != NULL);
+        tree->nodes = tmp;
+        tree->node_cap *= 2;
+    }
+    node_t *node = &tree->nodes[tree->num_nodes];
+    node->center = center;
+    node->half_width = half_width;
+    node->mass = 0;
+    node->center_of_mass = VEC_ZERO;
+    for (size_t i = 0; i < 4; i++) {
+        node->children[i] = -1;
+    }
+    node->leaf = true;
+    node->first = -1;
+    node->depth = depth;
+    return tree->num_nodes++;
+}
+
+int get_quadrant(node_t *node, vector_t pos) {
+    return (pos.x >= node->center.x ? 1 : 0) + (pos.y >= node->center.y ? 2 : 0);
+}
+
+// gets the child of a node covering a quadrant, creating it if needed
+int get_child(quadtree_t *tree, int index, int quadrant) {
+    if (tree->nodes[index].children[quadrant] == -1) {
+        node_t *node = &tree->nodes[index];
+        double quarter = node->half_width / 2;
+        vector_t center = {
+            node->center.x + (quadrant & 1 ? quarter : -quarter),
+            node->center.y + (quadrant & 2 ? quarter : -quarter)
+        };
+        int depth = node->depth + 1;
+        int child = add_node(tree, center, quarter, depth);
+        tree->nodes[index].children[quadrant] = child;
+    }
+    return tree->nodes[index].children[quadrant];
+}
+
+void insert_point(quadtree_t *tree, int point) {
+    vector_t pos = tree->positions[point];
+    double mass = tree->masses[point];
+    int index = 0;
+    while (true) {
+        node_t *node = &tree->nodes[index];
+        node->mass += mass;
+        node->center_of_mass = vec_add(node->center_of_mass, vec_multiply(mass, pos));
+        if (!node->leaf) {
+            index = get_child(tree, index, get_quadrant(node, pos));
+            continue;
+        }
+        if (node->first == -1 || node->depth >= MAX_DEPTH) {
+            tree->next[point] = node->first;
+            node->first = point;
+            return;
+        }
+        // split the leaf, pushing its points down one level
+        int moved = node->first;
+        node->first = -1;
+        node->leaf = false;
+        while (moved != -1) {
+            int following = tree->next[moved];
+            vector_t moved_pos = tree->positions[moved];
+            double moved_mass = tree->masses[moved];
+            int child = get_child(tree, index, get_quadrant(&tree->nodes[index], moved_pos));
+            node_t *child_node = &tree->nodes[child];
+            child_node->mass += moved_mass;
+            child_node->center_of_mass =
+                vec_add(child_node->center_of_mass, vec_multiply(moved_mass, moved_pos));
+            tree->next[moved] = -1;
+            child_node->first = moved;
+            moved = following;
+        }
+        index = get_child(tree, index, get_quadrant(&tree->nodes[index], pos));
+    }
+}
+
+void quadtree_build(quadtree_t *tree, const vector_t *positions, const double *masses, size_t count) {
+    tree->positions = positions;
+    tree->masses = masses;
+    tree->count = count;
+    tree->num_nodes = 0;
+    if (count > tree->point_cap) {
+        int *tmp = realloc(tree->next, count * sizeof(int));
+        assert(tmp != NULL);
+        tree->next = tmp;
+        tree->point_cap = count;
+    }
+    if (count == 0) {
+        return;
+    }
+
+    // the root is the smallest square around every point
+    vector_t min = positions[0];
+    vector_t max = positions[0];
+    for (size_t i = 1; i < count; i++) {
+        min.x = fmin(min.x, positions[i].x);
+        min.y = fmin(min.y, positions[i].y);
+        max.x = fmax(max.x, positions[i].x);
+        max.y = fmax(max.y, positions[i].y);
+    }
+    vector_t center = vec_multiply(0.5, vec_add(min, max));
+    double half_width = 0.5 * fmax(max.x - min.x, max.y - min.y) + 1;
+    add_node(tree, center, half_width, 0);
+
+    for (size_t i = 0; i < count; i++) {
+        tree->next[i] = -1;
+        insert_point(tree, i);
+    }
+    for (size_t i = 0; i < tree->num_nodes; i++) {
+        node_t *node = &tree->nodes[i];
+        if (node->mass > 0) {
+            node->center_of_mass = vec_multiply(1 / node->mass, node->center_of_mass);
+        }
+    }
+}
+
+// adds the pull of a mass at other on a point at pos, as gravity() in forces.c does;
+// the vector functions are written out since this runs for every interaction
+void add_gravity(vector_t *force, vector_t pos, double mass, vector_t other,
+                 double other_mass, double G, double min_dist) {
+    double dx = pos.x - other.x;
+    double dy = pos.y - other.y;
+    double dist = sqrt(dx * dx + dy * dy);
+    if (dist <= min_dist) {
+        return;
+    }
+    double scale = -1.0 * G * mass * other_mass / dist / dist / dist;
+    force->x += scale * dx;
+    force->y += scale * dy;
+}
+
+bool node_contains(node_t *node, vector_t pos) {
+    return fabs(pos.x - node->center.x) <= node->half_width &&
+           fabs(pos.y - node->center.y) <= node->half_width;
+}
+
+vector_t quadtree_force(quadtree_t *tree, size_t index, double G, double theta, double min_dist) {
+    assert(index < tree->count);
+    vector_t pos = tree->positions[index];
+    double mass = tree->masses[index];
+    double theta_squared = theta * theta;
+    vector_t force = VEC_ZERO;
+    // each level of the walk leaves at most 3 siblings on the stack
+    int stack[3 * MAX_DEPTH + 4];
+    size_t top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        node_t *node = &tree->nodes[stack[--top]];
+        if (node->mass == 0) {
+            continue;
+        }
+        if (node->leaf) {
+            for (int j = node->first; j != -1; j = tree->next[j]) {
+                if (j != index) {
+                    add_gravity(&force, pos, mass, tree->positions[j], tree->masses[j],
+                                G, min_dist);
+                }
+            }
+            continue;
+        }
+        // open the node unless width / distance < theta
+        double dx = node->center_of_mass.x - pos.x;
+        double dy = node->center_of_mass.y - pos.y;
+        double width = 2 * node->half_width;
+        if (width * width < theta_squared * (dx * dx + dy * dy) && !node_contains(node, pos)) {
+            add_gravity(&force, pos, mass, node->center_of_mass, node->mass, G, min_dist);
+            continue;
+        }
+        for (size_t i = 0; i < 4; i++) {
+            if (node->children[i] != -1) {
+                stack[top++] = node->children[i];
+            }
+        }
+    }
+    return force;
+}
@@ -0,0 +1,22 @@
+#include <assert.h>
+#include <math.h>
+#include "render_component.h"
+
+const char *const SPRITE_PATHS[NUM_SPRITES] = {
+    "./assets/ball0.png", "./assets/ball1.png", "./assets/ball2.png", "./assets/ball3.png",
+    "./assets/ball4.png", "./assets/ball5.png", "./assets/ball6.png", "./assets/ball7.png",
+    "./assets/ball8.png", "./assets/ball9.png", "./assets/ball10.png", "./assets/ball11.png",
+    "./assets/ball12.png", "./assets/ball13.png", "./assets/ball14.png", "./assets/ball15.png",
+    [SPRITE_CUE] = "./assets/cue.png"
+};
+
+const char *sprite_get_path(sprite_id_t sprite) {
+    assert(sprite < NUM_SPRITES);
+    return SPRITE_PATHS[sprite];
+}
+
+double sprite_get_heading(sprite_id_t sprite) {
+    assert(sprite < NUM_SPRITES);
+    // The cue is drawn with its tip on the left
+    return sprite == SPRITE_CUE ? M_PI : 0;
+}
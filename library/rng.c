@@ -0,0 +1,19 @@
+#include "rng.h"
+
+// Any odd constant with a mix of bits; this one is 2^64 divided by the golden ratio
+const uint64_t RNG_ZERO_SEED = 0x9e3779b97f4a7c15ULL;
+
+uint64_t rng_seed(uint64_t seed) {
+    return seed != 0 ? seed : RNG_ZERO_SEED;
+}
+
+double rng_unit(uint64_t *rng) {
+    *rng ^= *rng >> 12;
+    *rng ^= *rng << 25;
+    *rng ^= *rng >> 27;
+    return (*rng * 0x2545f4914f6cdd1dULL >> 11) * (1.0 / (1ULL << 53));
+}
+
+double rng_between(uint64_t *rng, double min, double max) {
+    return min + (max - min) * rng_unit(rng);
+}
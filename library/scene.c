@@ -1,16 +1,23 @@
 #include "scene.h"
 #include <assert.h>
+#include <float.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "contact_solver.h"
 #include "forces.h"
 #include "player.h"
 #include "ball.h"
-#include "sdl_wrapper.h"
 
 const int BODIES = 50;
 const int FORCE_CREATORS = 5;
 const int BALLS = 16;
 const int PLAYERS = 2;
+const char *const FORCE_KIND_NAMES[FORCE_KINDS] = {
+    "user", "gravity", "spring", "drag", "collision", "physics_collision", "ideal_friction"
+};
+const char *const SCENE_PHASE_NAMES[SCENE_PHASES] = {"contacts", "integration", "removal"};
 
 
 //struct to hold a force, its argument pointer, freer, and list of bodies
@@ -19,8 +26,23 @@ typedef struct force_struct {
     void *arg;
     free_func_t freer;
     list_t *bodies;
+    force_kind_t kind;
 } force_struct_t;
 
+// where a body is at each stage of a tick that evaluates the forces more than once
+typedef struct body_stage {
+    body_t *body;
+    integrator_t integrator;
+    vector_t position;
+    vector_t velocity;
+    // for bodies that only need the first stage's forces
+    vector_t force;
+    vector_t impulse;
+    // the velocity and acceleration at each stage
+    vector_t stage_velocity[4];
+    vector_t stage_acceleration[4];
+} body_stage_t;
+
 typedef struct scene {
     list_t *bodies;
     list_t *forces;
@@ -28,10 +50,19 @@ typedef struct scene {
     list_t *balls;
     list_t *players;
     int turn;
+    double dt;
+    integrator_t integrator;
+    contact_solver_t *solver;
+    bool profiling;
+    scene_profile_t profile;
+    // reused by multi-stage ticks, grown to the body count
+    body_stage_t *stages;
+    size_t stage_capacity;
 } scene_t;
 
 
 
+
 void force_struct_free (force_struct_t *st);
 
 scene_t *scene_init(void) {
@@ -43,6 +74,13 @@ scene_t *scene_init(void) {
     sc->balls = list_init(BALLS, (free_func_t)ball_free);
     sc->players = list_init(PLAYERS, (free_func_t)player_free);
     sc->turn = 0;
+    sc->dt = 0;
+    sc->integrator = INTEGRATOR_TRAPEZOID;
+    sc->solver = NULL;
+    sc->profiling = false;
+    memset(&sc->profile, 0, sizeof(scene_profile_t));
+    sc->stages = NULL;
+    sc->stage_capacity = 0;
     return sc;
 }
 
@@ -56,10 +94,38 @@ int scene_set_state(scene_t *scene, int st) {
     return game_state;
 }
 
+double scene_get_dt(scene_t *scene) {
+    return scene->dt;
+}
+
+integrator_t scene_get_integrator(scene_t *scene) {
+    return scene->integrator;
+}
+
+void scene_set_integrator(scene_t *scene, integrator_t integrator) {
+    assert(integrator != INTEGRATOR_SCENE);
+    scene->integrator = integrator;
+}
+
+contact_solver_t *scene_get_contact_solver(scene_t *scene) {
+    return scene->solver;
+}
+
+void scene_set_contact_solver(scene_t *scene, contact_solver_t *solver) {
+    if (scene->solver != NULL) {
+        contact_solver_free(scene->solver);
+    }
+    scene->solver = solver;
+}
+
 int scene_get_turn(scene_t *scene) {
     return scene->turn;
 }
 
+void scene_set_turn(scene_t *scene, int turn) {
+    scene->turn = turn;
+}
+
 list_t *scene_get_players(scene_t *scene) {
     return scene->players;
 }
@@ -89,6 +155,10 @@ void scene_free(scene_t *scene) {
     list_free(scene->forces);
     list_free(scene->balls);
     list_free(scene->players);
+    if (scene->solver != NULL) {
+        contact_solver_free(scene->solver);
+    }
+    free(scene->stages);
     free(scene);
 }
 
@@ -129,12 +199,19 @@ void force_struct_free (force_struct_t *st) {
 
 void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
                                     list_t *bodies, free_func_t freer) {
+    scene_add_kind_force_creator(scene, FORCE_USER, forcer, aux, bodies, freer);
+}
+
+void scene_add_kind_force_creator(scene_t *scene, force_kind_t kind, force_creator_t forcer,
+                                  void *aux, list_t *bodies, free_func_t freer) {
+    assert(kind < FORCE_KINDS);
     force_struct_t *frc = malloc(sizeof(force_struct_t));
     assert(frc != NULL);
     frc->force = forcer;
     frc->arg = aux;
     frc->freer = freer;
     frc->bodies = bodies;
+    frc->kind = kind;
     list_add(scene->forces, frc);
 }
 
@@ -146,18 +223,85 @@ void scene_add_ball_list(scene_t *scene, list_t *balls) {
     }
 }
 
-void scene_tick(scene_t *scene, double dt) {
-    //apply all forces in the scene
-    for (size_t j = 0; j < list_size(scene->forces); j++) {
-        force_struct_t *fstruct = list_get(scene->forces, j);
-        (fstruct->force)(fstruct->arg);
+size_t scene_force_creators(scene_t *scene) {
+    return list_size(scene->forces);
+}
+
+force_creator_t scene_get_forcer(scene_t *scene, size_t index) {
+    force_struct_t *fstruct = list_get(scene->forces, index);
+    return fstruct->force;
+}
+
+void *scene_get_force_aux(scene_t *scene, size_t index) {
+    force_struct_t *fstruct = list_get(scene->forces, index);
+    return fstruct->arg;
+}
+
+force_kind_t scene_get_force_kind(scene_t *scene, size_t index) {
+    force_struct_t *fstruct = list_get(scene->forces, index);
+    return fstruct->kind;
+}
+
+void scene_set_profiling(scene_t *scene, bool profiling) {
+    scene->profiling = profiling;
+}
+
+scene_profile_t scene_get_profile(scene_t *scene) {
+    return scene->profile;
+}
+
+void scene_reset_profile(scene_t *scene) {
+    memset(&scene->profile, 0, sizeof(scene_profile_t));
+}
+
+const char *force_kind_name(force_kind_t kind) {
+    assert(kind < FORCE_KINDS);
+    return FORCE_KIND_NAMES[kind];
+}
+
+const char *scene_phase_name(scene_phase_t phase) {
+    assert(phase < SCENE_PHASES);
+    return SCENE_PHASE_NAMES[phase];
+}
+
+void print_profile_counter(FILE *file, const char *name, profile_counter_t counter, double total) {
+    if (counter.calls == 0) {
+        return;
     }
-    // tick each body in the scene
-    for (size_t i = 0; i < scene_bodies(scene); i++) {
-        body_t *curr =(body_t *)list_get(scene->bodies, i);
-        body_tick(curr, dt);
+    fprintf(file, "%-20s %12zu %12.3f %12.3f %7.1f%%\n", name, counter.calls,
+            counter.seconds * 1e3, counter.seconds * 1e6 / counter.calls,
+            total > 0 ? counter.seconds / total * 100 : 0);
+}
+
+void scene_print_profile(scene_t *scene, FILE *file) {
+    scene_profile_t *profile = &scene->profile;
+    fprintf(file, "%zu ticks, %.3f ms\n", profile->ticks, profile->seconds * 1e3);
+    fprintf(file, "%-20s %12s %12s %12s %8s\n", "", "calls", "total ms", "us/call", "share");
+    for (size_t kind = 0; kind < FORCE_KINDS; kind++) {
+        print_profile_counter(file, FORCE_KIND_NAMES[kind], profile->forces[kind], profile->seconds);
+    }
+    for (size_t phase = 0; phase < SCENE_PHASES; phase++) {
+        print_profile_counter(file, SCENE_PHASE_NAMES[phase], profile->phases[phase],
+                              profile->seconds);
     }
+}
 
+// Only read while profiling, so ticks that are not profiled never touch the clock
+double profile_clock(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+void add_profile_time(profile_counter_t *counter, double start) {
+    counter->calls++;
+    counter->seconds += profile_clock() - start;
+}
+
+void scene_remove_marked(scene_t *scene) {
+    if (scene->solver != NULL) {
+        contact_solver_remove_marked(scene->solver);
+    }
     //remove all forces that contain a body marked for removal
     for (size_t j = 0; j < list_size(scene->forces); j++) {
         int removed = 0;
@@ -187,3 +331,178 @@ void scene_tick(scene_t *scene, double dt) {
         }
     }
 }
+
+integrator_t body_integrator(scene_t *scene, body_t *body) {
+    integrator_t integrator = body_get_integrator(body);
+    return integrator == INTEGRATOR_SCENE ? scene->integrator : integrator;
+}
+
+void apply_forces(scene_t *scene) {
+    for (size_t j = 0; j < list_size(scene->forces); j++) {
+        force_struct_t *fstruct = list_get(scene->forces, j);
+        if (scene->profiling) {
+            double start = profile_clock();
+            (fstruct->force)(fstruct->arg);
+            add_profile_time(&scene->profile.forces[fstruct->kind], start);
+        } else {
+            (fstruct->force)(fstruct->arg);
+        }
+    }
+}
+
+// the force creators, then the contact solver, which needs their forces
+void apply_forces_and_contacts(scene_t *scene, double dt) {
+    apply_forces(scene);
+    if (scene->solver != NULL) {
+        double start = scene->profiling ? profile_clock() : 0;
+        contact_solver_solve(scene->solver, dt);
+        if (scene->profiling) {
+            add_profile_time(&scene->profile.phases[PHASE_CONTACTS], start);
+        }
+    }
+}
+
+// the time profiled so far in force creators and contacts, which happen during integration
+double profiled_force_seconds(scene_t *scene) {
+    double seconds = scene->profile.phases[PHASE_CONTACTS].seconds;
+    for (size_t kind = 0; kind < FORCE_KINDS; kind++) {
+        seconds += scene->profile.forces[kind].seconds;
+    }
+    return seconds;
+}
+
+// Moves a body to where it is at a stage of a multi-stage tick.
+// Stages are spaced over the tick at 0, dt/2, dt/2, dt for RK4
+// and at 0, dt when the most any body needs is Verlet.
+void set_stage(body_stage_t *st, size_t stage, size_t stages, double dt) {
+    vector_t x0 = st->position;
+    vector_t v0 = st->velocity;
+    vector_t a0 = st->stage_acceleration[0];
+    vector_t x = x0;
+    vector_t v = v0;
+    if (st->integrator == INTEGRATOR_RK4) {
+        double h = stage == 3 ? dt : dt / 2;
+        x = vec_add(x0, vec_multiply(h, st->stage_velocity[stage - 1]));
+        v = vec_add(v0, vec_multiply(h, st->stage_acceleration[stage - 1]));
+    } else if (st->integrator == INTEGRATOR_VELOCITY_VERLET && stage == stages - 1) {
+        x = vec_add(x0, vec_add(vec_multiply(dt, v0), vec_multiply(dt * dt / 2, a0)));
+        v = vec_add(v0, vec_multiply(dt, a0));
+    }
+    st->stage_velocity[stage] = v;
+    body_set_centroid(st->body, x);
+    body_set_velocity(st->body, v);
+}
+
+// Ticks a scene where some body's integrator needs the forces at more than
+// one point in the tick. Bodies with single-stage integrators are held still
+// until the end and then stepped with the forces from the first stage.
+void tick_staged(scene_t *scene, double dt, size_t stages) {
+    size_t n = scene_bodies(scene);
+    if (n > scene->stage_capacity) {
+        scene->stages = realloc(scene->stages, n * sizeof(body_stage_t));
+        assert(scene->stages != NULL);
+        scene->stage_capacity = n;
+    }
+    body_stage_t *states = scene->stages;
+
+    apply_forces_and_contacts(scene, dt);
+    for (size_t i = 0; i < n; i++) {
+        body_stage_t *st = &states[i];
+        st->body = list_get(scene->bodies, i);
+        st->integrator = body_integrator(scene, st->body);
+        st->position = body_get_centroid(st->body);
+        st->force = body_get_force(st->body);
+        st->impulse = body_get_impulse(st->body);
+        double mass = body_get_mass(st->body);
+        if (integrator_stages(st->integrator) == 1 || mass == DBL_MAX) {
+            st->integrator = integrator_stages(st->integrator) == 1
+                ? st->integrator : INTEGRATOR_SEMI_IMPLICIT_EULER;
+            st->velocity = body_get_velocity(st->body);
+        } else {
+            // impulses change the velocity instantly, before the tick
+            st->velocity = vec_add(body_get_velocity(st->body), vec_multiply(1 / mass, st->impulse));
+            st->stage_velocity[0] = st->velocity;
+            st->stage_acceleration[0] = vec_multiply(1 / mass, st->force);
+        }
+        body_clear_forces(st->body);
+    }
+
+    for (size_t stage = 1; stage < stages; stage++) {
+        for (size_t i = 0; i < n; i++) {
+            if (integrator_stages(states[i].integrator) > 1) {
+                set_stage(&states[i], stage, stages, dt);
+            }
+        }
+        apply_forces(scene);
+        for (size_t i = 0; i < n; i++) {
+            body_stage_t *st = &states[i];
+            if (integrator_stages(st->integrator) > 1) {
+                double mass = body_get_mass(st->body);
+                st->stage_acceleration[stage] = vec_multiply(1 / mass, body_get_force(st->body));
+            }
+            body_clear_forces(st->body);
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        body_stage_t *st = &states[i];
+        vector_t x0 = st->position;
+        vector_t v0 = st->velocity;
+        vector_t *v = st->stage_velocity;
+        vector_t *a = st->stage_acceleration;
+        if (st->integrator == INTEGRATOR_RK4) {
+            vector_t dx = vec_add(vec_add(v[0], vec_multiply(2, v[1])), vec_add(vec_multiply(2, v[2]), v[3]));
+            vector_t dv = vec_add(vec_add(a[0], vec_multiply(2, a[1])), vec_add(vec_multiply(2, a[2]), a[3]));
+            body_set_centroid(st->body, vec_add(x0, vec_multiply(dt / 6, dx)));
+            body_set_velocity(st->body, vec_add(v0, vec_multiply(dt / 6, dv)));
+        } else if (st->integrator == INTEGRATOR_VELOCITY_VERLET) {
+            // the position was already set for the last stage
+            vector_t dv = vec_add(a[0], a[stages - 1]);
+            body_set_velocity(st->body, vec_add(v0, vec_multiply(dt / 2, dv)));
+        } else {
+            body_set_centroid(st->body, x0);
+            body_set_velocity(st->body, v0);
+            body_add_force(st->body, st->force);
+            body_add_impulse(st->body, st->impulse);
+            body_step(st->body, dt, st->integrator);
+        }
+    }
+}
+
+void scene_tick(scene_t *scene, double dt) {
+    bool profiling = scene->profiling;
+    double start = profiling ? profile_clock() : 0;
+    double force_seconds = profiling ? profiled_force_seconds(scene) : 0;
+    scene->dt = dt;
+    size_t stages = 1;
+    for (size_t i = 0; i < scene_bodies(scene); i++) {
+        size_t body_stages = integrator_stages(body_integrator(scene, list_get(scene->bodies, i)));
+        stages = body_stages > stages ? body_stages : stages;
+    }
+    if (stages > 1) {
+        tick_staged(scene, dt, stages);
+    } else {
+        //apply all forces in the scene
+        apply_forces_and_contacts(scene, dt);
+        // tick each body in the scene
+        for (size_t i = 0; i < scene_bodies(scene); i++) {
+            body_t *curr =(body_t *)list_get(scene->bodies, i);
+            body_step(curr, dt, body_integrator(scene, curr));
+        }
+    }
+    if (!profiling) {
+        scene_remove_marked(scene);
+        return;
+    }
+    // Integration is interleaved with the force creators in multi-stage ticks,
+    // so it is whatever time in the tick they did not take
+    double removal_start = profile_clock();
+    scene_profile_t *profile = &scene->profile;
+    profile->phases[PHASE_INTEGRATION].calls++;
+    profile->phases[PHASE_INTEGRATION].seconds +=
+        removal_start - start - (profiled_force_seconds(scene) - force_seconds);
+    scene_remove_marked(scene);
+    add_profile_time(&profile->phases[PHASE_REMOVAL], removal_start);
+    profile->ticks++;
+    profile->seconds += profile_clock() - start;
+}
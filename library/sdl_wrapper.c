@@ -1,17 +1,56 @@
 #include <assert.h>
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL2_gfxPrimitives.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
+#include "asset_pack.h"
+#include "polygon_batch.h"
 #include "sdl_wrapper.h"
+#include "sprite_batch.h"
 
 const char WINDOW_TITLE[] = "Pageboy Pool";
 const int WINDOW_WIDTH = 1000;
 const int WINDOW_HEIGHT = 500;
 const double MS_PER_S = 1e3;
+const char FONT_FILE[] = "./assets/comic.ttf";
+const int FONT_SIZE = 24;
+// Where asset_packer puts the decoded images and glyphs
+const char ASSET_PACK_FILE[] = "./assets/assets.pack";
+// The glyph atlas holds the printable ASCII characters, 16 to a row
+#define FIRST_GLYPH ' '
+#define LAST_GLYPH '~'
+#define NUM_GLYPHS (LAST_GLYPH - FIRST_GLYPH + 1)
+const int ATLAS_COLUMNS = 16;
+// Lines of text that have not been drawn recently are dropped past this many
+const size_t MAX_CACHED_LINES = 64;
+const char MENU_BACKGROUND[] = "./assets/menu_background.png";
+const char GAME_OVER_1_BACKGROUND[] = "./assets/game_over_1.png";
+const char GAME_OVER_2_BACKGROUND[] = "./assets/game_over_2.png";
+const char GAME_BACKGROUND[] = "./assets/game_background.png";
+const char *const BACKGROUNDS[] = {
+    MENU_BACKGROUND, GAME_OVER_1_BACKGROUND, GAME_OVER_2_BACKGROUND, GAME_BACKGROUND
+};
+// Limits on what a render snapshot can hold
+#define SNAPSHOT_SPRITES 64
+#define HUD_PLAYERS 2
+#define HUD_TEXT_LENGTH 64
+// Where each player's info is drawn, the player whose turn it is first
+const vector_t HUD_POSITIONS[HUD_PLAYERS] = {{42, 67}, {42, 275}};
+// How the aim preview is drawn: white, or red if the cue ball would be sunk,
+// and fainter while the preview is still being worked out
+const SDL_Color PREVIEW_COLOR = {255, 255, 255, 200};
+const SDL_Color PREVIEW_SCRATCH_COLOR = {220, 40, 40, 200};
+const Uint8 PREVIEW_UNFINISHED_ALPHA = 90;
+// How long the lines showing where the balls go after they touch are, in pixels
+const double PREVIEW_BALL_GUIDE = 60;
+const double PREVIEW_CUE_GUIDE = 40;
+// How opaque sdl_draw_shapes() draws the bodies, so the sprites show through
+const Uint8 SHAPE_OVERLAY_ALPHA = 160;
 
 /**
  * The coordinate at the center of the screen.
@@ -21,6 +60,22 @@ vector_t center;
  * The coordinate difference from the center to the top right corner.
  */
 vector_t max_diff;
+/**
+ * The center of the window in pixels and the number of pixels per unit of scene distance.
+ * Worked out once per frame in sdl_clear(), rather than for every vertex drawn.
+ */
+vector_t window_center;
+double scene_scale;
+/**
+ * The batch polygons are queued into by sdl_queue_polygon().
+ */
+polygon_batch_t *polygon_layer;
+/**
+ * Where sdl_draw_polygon() puts each vertex's pixel, kept between calls.
+ */
+int16_t *polygon_x = NULL;
+int16_t *polygon_y = NULL;
+size_t polygon_capacity = 0;
 /**
  * The SDL window where the scene is rendered.
  */
@@ -30,13 +85,27 @@ SDL_Window *window;
  */
 SDL_Renderer *renderer;
 /**
- * A list of textures to be used by the renderer.
+ * The surface the scene is drawn to instead of a window
+ * after sdl_init_headless(), or NULL if there is a window.
+ */
+SDL_Surface *offscreen = NULL;
+/**
+ * How long each part of the last frame took to draw.
  */
- list_t *textures;
+render_timings_t last_timings;
 /**
-* A list of surfaces to be used by the renderer.
-*/
-list_t *surfaces;
+ * A texture loaded from an image file, kept for as long as the window is open.
+ */
+typedef struct cached_texture {
+    char *path;
+    SDL_Texture *texture;
+    int w;
+    int h;
+} cached_texture_t;
+/**
+ * Every image drawn so far, so each file is only decoded once.
+ */
+list_t *texture_cache;
 /**
  * The keypress handler, or NULL if none has been configured.
  */
@@ -58,39 +127,138 @@ clock_t last_clock = 0;
 
 //You already know what it is
 TTF_Font *comic_sans;
-
-/** Computes the center of the window in pixel coordinates */
-vector_t get_window_center(void) {
-    int *width = malloc(sizeof(*width)),
-        *height = malloc(sizeof(*height));
-    assert(width != NULL);
-    assert(height != NULL);
-    SDL_GetWindowSize(window, width, height);
-    vector_t dimensions = {.x = *width, .y = *height};
-    free(width);
-    free(height);
-    return vec_multiply(0.5, dimensions);
-}
+/**
+ * The decoded images and glyphs from ASSET_PACK_FILE,
+ * or NULL if there is no pack and they are loaded from the original files.
+ */
+asset_pack_t *assets = NULL;
+/**
+ * Where a character is in the glyph atlas and how far it moves the pen.
+ */
+typedef struct glyph {
+    SDL_Rect src;
+    int advance;
+} glyph_t;
+/**
+ * Every printable character in comic_sans, rendered once in sdl_init().
+ */
+SDL_Texture *glyph_atlas = NULL;
+glyph_t glyphs[NUM_GLYPHS];
+/**
+ * A line of text laid out as one quad per character in the glyph atlas.
+ */
+typedef struct text_line {
+    char *text;
+    size_t length;
+    SDL_Rect *src;
+    SDL_Rect *dst;
+} text_line_t;
+/**
+ * Lines of text drawn so far, most recently drawn last.
+ * A line is only laid out again if its text changes.
+ */
+list_t *text_cache;
+/**
+ * The balls and the cue, and the batch they are queued into each frame.
+ */
+sprite_atlas_t *sprites;
+sprite_batch_t *sprite_layer;
+/**
+ * The batch a line of text is queued into before it is drawn.
+ */
+sprite_batch_t *text_layer = NULL;
+/**
+ * One image in a render snapshot.
+ */
+typedef struct sprite_instance {
+    int sprite;
+    bool fixed;
+    vector_t position;
+    double angle;
+} sprite_instance_t;
+/**
+ * A copy of everything sdl_render_scene() draws, taken between ticks.
+ * It does not point into the scene, so it can be drawn
+ * while the scene is being ticked on another thread.
+ */
+typedef struct render_snapshot {
+    int state;
+    size_t num_sprites;
+    sprite_instance_t sprites[SNAPSHOT_SPRITES];
+    size_t num_players;
+    char names[HUD_PLAYERS][HUD_TEXT_LENGTH];
+    char infos[HUD_PLAYERS][HUD_TEXT_LENGTH];
+    bool has_preview;
+    aim_preview_t preview;
+} render_snapshot_t;
+/**
+ * The aim preview set by sdl_set_preview(), copied into every snapshot captured after it.
+ */
+bool has_preview = false;
+aim_preview_t current_preview;
+/**
+ * The snapshot sdl_render_scene() captures into and draws.
+ */
+render_snapshot_t frame_snapshot;
+/**
+ * The two halves of the buffer between sdl_publish_scene() and sdl_render_published().
+ * The simulation thread fills back_snapshot without holding any lock,
+ * then copies it to front_snapshot under snapshot_lock.
+ * The render thread copies front_snapshot to frame_snapshot under the lock
+ * and draws its copy after letting go of it, so neither thread waits on the other
+ * for longer than a copy.
+ */
+render_snapshot_t back_snapshot;
+render_snapshot_t front_snapshot;
+SDL_mutex *snapshot_lock;
+size_t snapshots_published = 0;
+size_t snapshots_rendered = 0;
+/**
+ * Everything that does not move, drawn once into a render target:
+ * the background and bodies in LAYER_STATIC.
+ * It is redrawn only when the background, the window size
+ * or those bodies change, or SDL loses the target's contents.
+ */
+SDL_Texture *static_layer = NULL;
+int static_layer_w = 0;
+int static_layer_h = 0;
+const char *static_layer_background = NULL;
+bool static_layer_valid = false;
+/**
+ * The fixed sprites last drawn into the static layer, in snapshot order,
+ * compared exactly against each new snapshot's fixed sprites.
+ */
+sprite_instance_t static_layer_sprites[SNAPSHOT_SPRITES];
+size_t static_layer_num_sprites = 0;
 
 /**
- * Computes the scaling factor between scene coordinates and pixel coordinates.
+ * Recomputes window_center and scene_scale from the window's current size.
  * The scene is scaled by the same factor in the x and y dimensions,
  * chosen to maximize the size of the scene while keeping it in the window.
  */
-double get_scene_scale(vector_t window_center) {
+void update_window_transform(void) {
+    int width, height;
+    if (offscreen != NULL) {
+        width = offscreen->w;
+        height = offscreen->h;
+    }
+    else {
+        SDL_GetWindowSize(window, &width, &height);
+    }
+    window_center = (vector_t) {.x = width / 2.0, .y = height / 2.0};
     // Scale scene so it fits entirely in the window
     double x_scale = window_center.x / max_diff.x,
            y_scale = window_center.y / max_diff.y;
-    return x_scale < y_scale ? x_scale : y_scale;
+    scene_scale = x_scale < y_scale ? x_scale : y_scale;
+    polygon_batch_set_transform(polygon_layer, center, scene_scale, window_center);
 }
 
 /** Maps a scene coordinate to a window coordinate */
-vector_t get_window_position(vector_t scene_pos, vector_t window_center) {
+vector_t get_window_position(vector_t scene_pos) {
     // Scale scene coordinates by the scaling factor
     // and map the center of the scene to the center of the window
     vector_t scene_center_offset = vec_subtract(scene_pos, center);
-    double scale = get_scene_scale(window_center);
-    vector_t pixel_center_offset = vec_multiply(scale, scene_center_offset);
+    vector_t pixel_center_offset = vec_multiply(scene_scale, scene_center_offset);
     vector_t pixel = {
         .x = round(window_center.x + pixel_center_offset.x),
         // Flip y axis since positive y is down on the screen
@@ -117,19 +285,388 @@ char get_keycode(SDL_Keycode key) {
     }
 }
 
-void sdl_init(vector_t min, vector_t max) {
+void cached_texture_free(cached_texture_t *cached) {
+    SDL_DestroyTexture(cached->texture);
+    free(cached->path);
+    free(cached);
+}
+
+/**
+ * Gets the texture for an image file, loading it the first time it is used.
+ */
+cached_texture_t *get_texture(const char *file) {
+    for (size_t i = 0; i < list_size(texture_cache); i++) {
+        cached_texture_t *cached = list_get(texture_cache, i);
+        if (strcmp(cached->path, file) == 0) {
+            return cached;
+        }
+    }
+    cached_texture_t *cached = malloc(sizeof(cached_texture_t));
+    assert(cached != NULL);
+    cached->path = malloc(strlen(file) + 1);
+    assert(cached->path != NULL);
+    strcpy(cached->path, file);
+    const void *pixels = assets == NULL
+        ? NULL
+        : asset_pack_find(assets, file, ASSET_IMAGE, &cached->w, &cached->h, NULL);
+    if (pixels != NULL) {
+        // Upload the mapped pixels as they are, with no decoding
+        cached->texture = SDL_CreateTexture(
+            renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, cached->w, cached->h
+        );
+        assert(cached->texture != NULL);
+        SDL_UpdateTexture(cached->texture, NULL, pixels, cached->w * 4);
+        SDL_SetTextureBlendMode(cached->texture, SDL_BLENDMODE_BLEND);
+    }
+    else {
+        cached->texture = IMG_LoadTexture(renderer, file);
+        assert(cached->texture != NULL);
+        SDL_QueryTexture(cached->texture, NULL, NULL, &cached->w, &cached->h);
+    }
+    list_add(texture_cache, cached);
+    return cached;
+}
+
+/**
+ * Renders every printable character of a font into one surface,
+ * filling in where each glyph is and how far it moves the pen.
+ */
+SDL_Surface *bake_glyph_atlas(TTF_Font *font, glyph_t *baked) {
+    SDL_Color black = {0, 0, 0, 255};
+    SDL_Surface *rendered[NUM_GLYPHS];
+    int cell_w = 0, cell_h = 0;
+    for (int i = 0; i < NUM_GLYPHS; i++) {
+        Uint16 ch = FIRST_GLYPH + i;
+        // Blank characters may not render to anything, but still have an advance
+        rendered[i] = TTF_RenderGlyph_Blended(font, ch, black);
+        if (TTF_GlyphMetrics(font, ch, NULL, NULL, NULL, NULL, &baked[i].advance) != 0) {
+            baked[i].advance = rendered[i] != NULL ? rendered[i]->w : 0;
+        }
+        if (rendered[i] == NULL) continue;
+        if (rendered[i]->w > cell_w) cell_w = rendered[i]->w;
+        if (rendered[i]->h > cell_h) cell_h = rendered[i]->h;
+    }
+
+    int rows = (NUM_GLYPHS + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS;
+    SDL_Surface *atlas = SDL_CreateRGBSurfaceWithFormat(
+        0, cell_w * ATLAS_COLUMNS, cell_h * rows, 32, SDL_PIXELFORMAT_RGBA32
+    );
+    assert(atlas != NULL);
+    for (int i = 0; i < NUM_GLYPHS; i++) {
+        if (rendered[i] == NULL) {
+            baked[i].src = (SDL_Rect) {0, 0, 0, 0};
+            continue;
+        }
+        SDL_Rect cell = {
+            .x = (i % ATLAS_COLUMNS) * cell_w,
+            .y = (i / ATLAS_COLUMNS) * cell_h,
+            .w = rendered[i]->w,
+            .h = rendered[i]->h
+        };
+        // Copy the glyph's alpha as is instead of blending it onto the atlas
+        SDL_SetSurfaceBlendMode(rendered[i], SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(rendered[i], NULL, atlas, &cell);
+        baked[i].src = cell;
+        SDL_FreeSurface(rendered[i]);
+    }
+    return atlas;
+}
+
+/**
+ * Gets the name the glyphs of the font are stored under in an asset pack.
+ * The size is part of the name, since the glyphs are rendered at that size.
+ */
+void get_font_asset_name(char *name) {
+    snprintf(name, ASSET_NAME_LENGTH, "%s@%d", FONT_FILE, FONT_SIZE);
+}
+
+/**
+ * Makes glyph_atlas from the asset pack, if the pack has the font's glyphs.
+ *
+ * @return whether the glyphs were found
+ */
+bool load_glyph_atlas(void) {
+    if (assets == NULL) return false;
+    char name[ASSET_NAME_LENGTH];
+    get_font_asset_name(name);
+    int w, h;
+    size_t size;
+    const void *pixels = asset_pack_find(assets, name, ASSET_GLYPH_ATLAS, &w, &h, NULL);
+    const int32_t *metrics = asset_pack_find(assets, name, ASSET_GLYPH_METRICS, NULL, NULL, &size);
+    if (pixels == NULL || metrics == NULL || size != sizeof(int32_t) * 5 * NUM_GLYPHS) {
+        return false;
+    }
+    for (int i = 0; i < NUM_GLYPHS; i++) {
+        const int32_t *glyph = &metrics[5 * i];
+        glyphs[i].src = (SDL_Rect) {glyph[0], glyph[1], glyph[2], glyph[3]};
+        glyphs[i].advance = glyph[4];
+    }
+    glyph_atlas = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, w, h);
+    assert(glyph_atlas != NULL);
+    SDL_UpdateTexture(glyph_atlas, NULL, pixels, w * 4);
+    SDL_SetTextureBlendMode(glyph_atlas, SDL_BLENDMODE_BLEND);
+    return true;
+}
+
+/**
+ * Renders every printable character of comic_sans into one texture.
+ */
+void build_glyph_atlas(void) {
+    SDL_Surface *atlas = bake_glyph_atlas(comic_sans, glyphs);
+    glyph_atlas = SDL_CreateTextureFromSurface(renderer, atlas);
+    assert(glyph_atlas != NULL);
+    SDL_SetTextureBlendMode(glyph_atlas, SDL_BLENDMODE_BLEND);
+    SDL_FreeSurface(atlas);
+}
+
+void text_line_free(text_line_t *line) {
+    free(line->text);
+    free(line->src);
+    free(line->dst);
+    free(line);
+}
+
+/**
+ * Gets the layout of a line of text relative to its top left corner,
+ * laying it out the first time it is drawn.
+ */
+text_line_t *get_text_line(const char *text) {
+    size_t size = list_size(text_cache);
+    for (size_t i = 0; i < size; i++) {
+        text_line_t *line = list_get(text_cache, i);
+        if (strcmp(line->text, text) == 0) {
+            // Keep recently drawn lines at the back so they are evicted last
+            if (i != size - 1) {
+                list_add(text_cache, list_remove(text_cache, i));
+            }
+            return line;
+        }
+    }
+    if (size == MAX_CACHED_LINES) {
+        text_line_free(list_remove(text_cache, 0));
+    }
+
+    text_line_t *line = malloc(sizeof(text_line_t));
+    assert(line != NULL);
+    line->length = strlen(text);
+    line->text = malloc(line->length + 1);
+    line->src = malloc(sizeof(SDL_Rect) * (line->length + 1));
+    line->dst = malloc(sizeof(SDL_Rect) * (line->length + 1));
+    assert(line->text != NULL && line->src != NULL && line->dst != NULL);
+    strcpy(line->text, text);
+    int pen = 0;
+    for (size_t i = 0; i < line->length; i++) {
+        unsigned char ch = text[i];
+        // Draw anything outside the atlas as a question mark
+        glyph_t *glyph = &glyphs[(ch >= FIRST_GLYPH && ch <= LAST_GLYPH ? ch : '?') - FIRST_GLYPH];
+        line->src[i] = glyph->src;
+        line->dst[i] = (SDL_Rect) {pen, 0, glyph->src.w, glyph->src.h};
+        pen += glyph->advance;
+    }
+    list_add(text_cache, line);
+    return line;
+}
+
+/**
+ * Copies what needs to be drawn out of a scene.
+ */
+void capture_snapshot(scene_t *scene, render_snapshot_t *snapshot) {
+    snapshot->state = scene_get_state(scene);
+    snapshot->num_sprites = 0;
+    for (size_t i = 0; i < scene_bodies(scene); i++) {
+        body_t *body = scene_get_body(scene, i);
+        render_component_t render = body_get_render(body);
+        if (render.kind == DRAW_NONE || snapshot->num_sprites == SNAPSHOT_SPRITES) {
+            continue;
+        }
+        sprite_instance_t *instance = &snapshot->sprites[snapshot->num_sprites++];
+        instance->sprite = render.sprite;
+        instance->fixed = render.layer == LAYER_STATIC;
+        instance->position = body_get_centroid(body);
+        instance->angle = render.kind == DRAW_ROTATED_SPRITE
+            ? body_get_angle(body) - sprite_get_heading(render.sprite)
+            : 0;
+    }
+
+    size_t players = list_size(scene_get_players(scene));
+    snapshot->num_players = players < HUD_PLAYERS ? players : HUD_PLAYERS;
+    int turn = scene_get_turn(scene);
+    for (size_t i = 0; i < snapshot->num_players; i++) {
+        player_t *player = scene_get_player(scene, (turn + i) % players);
+        snprintf(snapshot->names[i], HUD_TEXT_LENGTH, "%s", player_get_name(player));
+        snprintf(snapshot->infos[i], HUD_TEXT_LENGTH, "%s", player_get_info(player));
+    }
+    snapshot->has_preview = has_preview;
+    if (has_preview) {
+        snapshot->preview = current_preview;
+    }
+}
+
+//coords is center of image
+void sdl_draw_image(const char *file, vector_t coords) {
+    cached_texture_t *img = get_texture(file);
+    SDL_Rect rect;
+    rect.w = img->w;
+    rect.h = img->h;
+    rect.x = coords.x - img->w/2;
+    rect.y = coords.y - img->h/2;
+    SDL_RenderCopy(renderer, img->texture, NULL, &rect);
+}
+
+/**
+ * Draws a background and a snapshot's fixed sprites to the current render target.
+ */
+void draw_static_content(const render_snapshot_t *snapshot, const char *background) {
+    sdl_draw_image(background, window_center);
+    if (snapshot == NULL) return;
+    sprite_batch_clear(sprite_layer);
+    for (size_t i = 0; i < snapshot->num_sprites; i++) {
+        const sprite_instance_t *instance = &snapshot->sprites[i];
+        if (instance->fixed) {
+            sprite_batch_add(sprite_layer, sprite_atlas_get_rect(sprites, instance->sprite),
+                             instance->position, instance->angle);
+        }
+    }
+    sprite_batch_draw(sprite_layer, renderer);
+}
+
+/**
+ * Returns whether a snapshot's fixed sprites differ from the ones in the static layer,
+ * i.e. whether any was added, removed or moved since it was drawn.
+ */
+bool static_sprites_changed(const render_snapshot_t *snapshot) {
+    size_t fixed = 0;
+    for (size_t i = 0; i < snapshot->num_sprites; i++) {
+        const sprite_instance_t *instance = &snapshot->sprites[i];
+        if (!instance->fixed) continue;
+        if (fixed == static_layer_num_sprites) return true;
+        const sprite_instance_t *drawn = &static_layer_sprites[fixed++];
+        if (instance->sprite != drawn->sprite || instance->angle != drawn->angle
+            || instance->position.x != drawn->position.x || instance->position.y != drawn->position.y) {
+            return true;
+        }
+    }
+    return fixed != static_layer_num_sprites;
+}
+
+/**
+ * Remembers a snapshot's fixed sprites as the ones drawn into the static layer.
+ */
+void save_static_sprites(const render_snapshot_t *snapshot) {
+    static_layer_num_sprites = 0;
+    for (size_t i = 0; i < snapshot->num_sprites; i++) {
+        if (snapshot->sprites[i].fixed) {
+            static_layer_sprites[static_layer_num_sprites++] = snapshot->sprites[i];
+        }
+    }
+}
+
+/**
+ * Copies the static layer to the screen, redrawing it first if it is out of date.
+ * Falls back to drawing the static content directly
+ * if the renderer cannot draw to textures.
+ *
+ * @param snapshot the snapshot whose fixed sprites to draw, or NULL to only draw the background
+ * @param background the background image
+ */
+void draw_static_layer(const render_snapshot_t *snapshot, const char *background) {
+    if (!SDL_RenderTargetSupported(renderer)) {
+        draw_static_content(snapshot, background);
+        return;
+    }
+    int w, h;
+    SDL_GetRendererOutputSize(renderer, &w, &h);
+    if (static_layer == NULL || w != static_layer_w || h != static_layer_h) {
+        if (static_layer != NULL) {
+            SDL_DestroyTexture(static_layer);
+        }
+        static_layer = SDL_CreateTexture(
+            renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, w, h
+        );
+        assert(static_layer != NULL);
+        static_layer_w = w;
+        static_layer_h = h;
+        static_layer_valid = false;
+    }
+    // Without a snapshot there are no fixed sprites
+    bool changed = snapshot == NULL ? static_layer_num_sprites != 0 : static_sprites_changed(snapshot);
+    if (!static_layer_valid || background != static_layer_background || changed) {
+        SDL_SetRenderTarget(renderer, static_layer);
+        sdl_clear();
+        draw_static_content(snapshot, background);
+        SDL_SetRenderTarget(renderer, NULL);
+        static_layer_background = background;
+        if (snapshot != NULL) {
+            save_static_sprites(snapshot);
+        }
+        else {
+            static_layer_num_sprites = 0;
+        }
+        static_layer_valid = true;
+    }
+    SDL_RenderCopy(renderer, static_layer, NULL, NULL);
+}
+
+void sdl_invalidate_static_layer(void) {
+    static_layer_valid = false;
+}
+
+/**
+ * Sets up the scene bounds and starts SDL and SDL_ttf.
+ */
+void init_sdl(vector_t min, vector_t max, Uint32 subsystems) {
     // Check parameters
     assert(min.x < max.x);
     assert(min.y < max.y);
 
     center = vec_multiply(0.5, vec_add(min, max));
     max_diff = vec_subtract(max, center);
-    SDL_Init(SDL_INIT_EVERYTHING);
+    SDL_Init(subsystems);
     if (TTF_Init() == -1)
     {
         printf("TTF_Init: %s\n", TTF_GetError());
         exit(2);
     }
+}
+
+/**
+ * Loads the images and font and sets up everything drawn with them.
+ * Must be called once the renderer has been created.
+ */
+void init_resources(void) {
+    texture_cache = list_init(32, (free_func_t)cached_texture_free);
+    text_cache = list_init(MAX_CACHED_LINES, (free_func_t)text_line_free);
+    snapshot_lock = SDL_CreateMutex();
+    assert(snapshot_lock != NULL);
+    polygon_layer = polygon_batch_init();
+    update_window_transform();
+    // Without a pack, everything is decoded from the original files
+    assets = asset_pack_open(ASSET_PACK_FILE);
+    // The atlas numbers its sprites in the order of their paths, the same as sprite_id_t
+    const char *sprite_files[NUM_SPRITES];
+    for (size_t i = 0; i < NUM_SPRITES; i++) {
+        sprite_files[i] = sprite_get_path(i);
+    }
+    sprites = sprite_atlas_init(renderer, sprite_files, NUM_SPRITES, assets);
+    sprite_layer = sprite_batch_init(sprite_atlas_get_texture(sprites));
+    if (load_glyph_atlas()) {
+        text_layer = sprite_batch_init(glyph_atlas);
+        return;
+    }
+    comic_sans = TTF_OpenFont(FONT_FILE, FONT_SIZE);
+    if (!comic_sans)
+    {
+        printf("TTF_OpenFont: %s\n", TTF_GetError());
+        // handle error
+    }
+    else {
+        build_glyph_atlas();
+        text_layer = sprite_batch_init(glyph_atlas);
+    }
+}
+
+void sdl_init(vector_t min, vector_t max) {
+    init_sdl(min, max, SDL_INIT_EVERYTHING);
     window = SDL_CreateWindow(
         WINDOW_TITLE,
         SDL_WINDOWPOS_CENTERED,
@@ -139,14 +676,18 @@ void sdl_init(vector_t min, vector_t max) {
         SDL_WINDOW_RESIZABLE
     );
     renderer = SDL_CreateRenderer(window, -1, 0);
-    textures = list_init(15, NULL);
-    surfaces = list_init(15, NULL);
-    comic_sans = TTF_OpenFont("./assets/comic.ttf", 24);
-    if (!comic_sans)
-    {
-        printf("TTF_OpenFont: %s\n", TTF_GetError());
-        // handle error
-    }
+    init_resources();
+}
+
+void sdl_init_headless(vector_t min, vector_t max, int width, int height) {
+    assert(width > 0 && height > 0);
+    // No window is opened, so there is no need for a display
+    init_sdl(min, max, 0);
+    offscreen = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+    assert(offscreen != NULL);
+    renderer = SDL_CreateSoftwareRenderer(offscreen);
+    assert(renderer != NULL);
+    init_resources();
 }
 
 bool sdl_is_done(scene_t *scene) {
@@ -157,6 +698,11 @@ bool sdl_is_done(scene_t *scene) {
             case SDL_QUIT:
                 free(event);
                 return true;
+            case SDL_RENDER_TARGETS_RESET:
+            case SDL_RENDER_DEVICE_RESET:
+                // The static layer's pixels are gone and need drawing again
+                sdl_invalidate_static_layer();
+                break;
             case SDL_KEYDOWN: {
                 if (key_handler == NULL) break;
                 char key = get_keycode(event->key.keysym.sym);
@@ -187,9 +733,12 @@ bool sdl_is_done(scene_t *scene) {
                 key_handler(key, type, held_time, scene);
                 break;
             }
-            case SDL_MOUSEMOTION:
-                mouse_handler(SDL_MOUSEMOTION, scene, 0.0);
+            case SDL_MOUSEMOTION: {
+                if (mouse_handler == NULL) break;
+                vector_t position = {event->motion.x, event->motion.y};
+                mouse_handler(MOUSE_MOVED, scene, 0.0, position);
                 break;
+            }
             case SDL_MOUSEBUTTONUP:
             {
                 uint32_t timestamp = event->button.timestamp;
@@ -197,7 +746,9 @@ bool sdl_is_done(scene_t *scene) {
                 double held_time = (timestamp - mouse_down_start_timestamp) / MS_PER_S;
                 //printf("mouse case up\n");
                 mouse_down_start_timestamp = 0;
-                mouse_handler(SDL_MOUSEBUTTONUP, scene, held_time);
+                if (mouse_handler == NULL) break;
+                vector_t position = {event->button.x, event->button.y};
+                mouse_handler(MOUSE_RELEASED, scene, held_time, position);
                 break;
             }
             case SDL_MOUSEBUTTONDOWN:
@@ -209,7 +760,9 @@ bool sdl_is_done(scene_t *scene) {
                     mouse_down_start_timestamp = timestamp;
                 }
                 //printf("mouse case down\n");
-                mouse_handler(SDL_MOUSEBUTTONDOWN, scene, held_time);
+                if (mouse_handler == NULL) break;
+                vector_t position = {event->button.x, event->button.y};
+                mouse_handler(MOUSE_PRESSED, scene, held_time, position);
                 break;
             }
         }
@@ -219,6 +772,8 @@ bool sdl_is_done(scene_t *scene) {
 }
 
 void sdl_clear(void) {
+    // The window may have been resized since the last frame
+    update_window_transform();
     SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
     SDL_RenderClear(renderer);
 }
@@ -231,117 +786,86 @@ void sdl_draw_polygon(list_t *points, rgb_color_t color) {
     assert(0 <= color.g && color.g <= 1);
     assert(0 <= color.b && color.b <= 1);
 
-    vector_t window_center = get_window_center();
-
-    // Convert each vertex to a point on screen
-    int16_t *x_points = malloc(sizeof(*x_points) * n),
-            *y_points = malloc(sizeof(*y_points) * n);
-    assert(x_points != NULL);
-    assert(y_points != NULL);
+    // Convert each vertex to a point on screen,
+    // growing the buffers only when a polygon has more vertices than any before it
+    if (n > polygon_capacity) {
+        polygon_capacity = n;
+        polygon_x = realloc(polygon_x, sizeof(*polygon_x) * n);
+        polygon_y = realloc(polygon_y, sizeof(*polygon_y) * n);
+        assert(polygon_x != NULL);
+        assert(polygon_y != NULL);
+    }
     for (size_t i = 0; i < n; i++) {
         vector_t *vertex = list_get(points, i);
-        vector_t pixel = get_window_position(*vertex, window_center);
-        x_points[i] = pixel.x;
-        y_points[i] = pixel.y;
+        vector_t pixel = get_window_position(*vertex);
+        polygon_x[i] = pixel.x;
+        polygon_y[i] = pixel.y;
     }
 
     // Draw polygon with the given color
     filledPolygonRGBA(
         renderer,
-        x_points, y_points, n,
+        polygon_x, polygon_y, n,
         color.r * 255, color.g * 255, color.b * 255, 255
     );
-    free(x_points);
-    free(y_points);
 }
 
-//coords is center of image
-void sdl_draw_image(const char *file, vector_t coords) {
-    SDL_Texture *img = IMG_LoadTexture(renderer, file);
-    assert(img != NULL);
-    int w, h;
-    SDL_QueryTexture(img, NULL, NULL, &w, &h);
-    SDL_Rect rect;
-    rect.w = w;
-    rect.h = h;
-    rect.x = coords.x - w/2;
-    rect.y = coords.y - h/2;
-    SDL_RenderCopy(renderer, img, NULL, &rect);
-    list_add(textures, img);
+void sdl_queue_polygon(list_t *points, rgb_color_t color) {
+    polygon_batch_add(polygon_layer, points, color);
 }
 
-void sdl_draw_cue(const char *file, vector_t coords, double angle, vector_t center) {
-    SDL_Texture *img = IMG_LoadTexture(renderer, file);
-    assert(img != NULL);
-    int w, h;
-    SDL_QueryTexture(img, NULL, NULL, &w, &h);
-    SDL_Rect rect;
-    rect.w = w;
-    rect.h = h;
-    rect.x = coords.x - w/2;
-    rect.y = coords.y - h/2;
-    double angle_deg = (double)((angle-M_PI) * 180.0) / M_PI;
-    //SDL_Point pt = (SDL_Point){coords.x, coords.y};
-    //printf("angle: %f\n", angle_deg);
-    //printf("centroid: %d, %d\n", pt.x, pt.y);
-    //angle_deg
-    SDL_RenderCopyEx(renderer, img, NULL, &rect, angle_deg, NULL, SDL_FLIP_NONE);
-    //printf("just drew cue\n");
-    list_add(textures, img);
+void sdl_draw_queued_polygons(void) {
+    polygon_batch_draw(polygon_layer, renderer);
+    polygon_batch_clear(polygon_layer);
+}
+
+void sdl_draw_shapes(scene_t *scene) {
+    // Bodies are placed in window pixels, as the sprites are drawn
+    polygon_batch_set_pixel_transform(polygon_layer);
+    polygon_batch_set_alpha(polygon_layer, SHAPE_OVERLAY_ALPHA);
+    size_t bodies = scene_bodies(scene);
+    for (size_t i = 0; i < bodies; i++) {
+        body_t *body = scene_get_body(scene, i);
+        polygon_batch_add(polygon_layer, body_borrow_shape(body), body_get_color(body));
+    }
+    sdl_draw_queued_polygons();
+    polygon_batch_set_alpha(polygon_layer, 255);
+    polygon_batch_set_transform(polygon_layer, center, scene_scale, window_center);
 }
 
 //coords is top left corner of text
 void sdl_draw_text(const char *text, vector_t coords) {
-    SDL_Color black = {0,0,0};
-    SDL_Surface *surface = TTF_RenderText_Blended(comic_sans, text, black);
-    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-    int w, h;
-    SDL_QueryTexture(texture, NULL, NULL, &w, &h);
-    SDL_Rect rect;
-    rect.w = w;
-    rect.h = h;
-    rect.x = coords.x;
-    rect.y = coords.y;
-    SDL_RenderCopy(renderer, texture, NULL, &rect);
-    assert(surface != NULL);
-    assert(texture != NULL);
-    list_add(textures, texture);
-    list_add(surfaces, surface);
+    if (glyph_atlas == NULL) return;
+    text_line_t *line = get_text_line(text);
+    sprite_batch_clear(text_layer);
+    for (size_t i = 0; i < line->length; i++) {
+        if (line->src[i].w == 0) continue;
+        SDL_Rect dst = line->dst[i];
+        dst.x += coords.x;
+        dst.y += coords.y;
+        sprite_batch_add_rect(text_layer, line->src[i], dst);
+    }
+    sprite_batch_draw(text_layer, renderer);
 }
 
 //coords is top left corner
-void sdl_draw_player_info(player_t *player, vector_t coords)
-{
-    const char *name = player_get_name(player);
-    //printf("NAME: %s\n", name);
-    const char *info = player_get_info(player);
-    list_t *sunk = player_get_balls_sunk(player);
+void draw_hud_text(const char *name, const char *info, vector_t coords) {
     sdl_draw_text(name, coords);
     sdl_draw_text(info, vec_add(coords, (vector_t){0, 35}));
     sdl_draw_text("Balls sunk:", vec_add(coords, (vector_t){0, 70}));
-    //printf("Number of balls sunk: %zu\n", list_size(sunk));
-    for (size_t i = 0; i < list_size(sunk); i++)
-    {
-        ball_t *ball = (ball_t *)list_get(sunk, i);
-        //printf("Ball #%d\n", ball_get_num(ball));
-        body_t *body = ball_get_body(ball);
-        double radius = ball_get_radius(ball);
-        // add spacing as an argument to function
-        double x_addition = i * (2.0 * radius + 3);
-        //printf("x_addition: %f\n", x_addition);
-        body_set_velocity(body, (vector_t){0, 0});
-        body_reset_impulse(body);
-        body_set_centroid(body, vec_add(coords, (vector_t){x_addition + 10, 127}));
-    }
+}
+
+void sdl_draw_player_info(player_t *player, vector_t coords)
+{
+    draw_hud_text(player_get_name(player), player_get_info(player), coords);
 }
 
 void sdl_show(void) {
     // Draw boundary lines
-    vector_t window_center = get_window_center();
     vector_t max = vec_add(center, max_diff),
              min = vec_subtract(center, max_diff);
-    vector_t max_pixel = get_window_position(max, window_center),
-             min_pixel = get_window_position(min, window_center);
+    vector_t max_pixel = get_window_position(max),
+             min_pixel = get_window_position(min);
     SDL_Rect *boundary = malloc(sizeof(*boundary));
     boundary->x = min_pixel.x;
     boundary->y = max_pixel.y;
@@ -354,74 +878,226 @@ void sdl_show(void) {
     SDL_RenderPresent(renderer);
 }
 
-void sdl_clear_images() {
-    //destroy surfaces
-    for (size_t i = 0; i < list_size(surfaces); i++) {
-        SDL_FreeSurface((SDL_Surface *) list_remove(surfaces, i));
+/**
+ * Finishes timing one part of a frame.
+ * SDL may queue draw calls until the frame is presented, so the queue is flushed
+ * first to count the drawing towards the part that asked for it.
+ *
+ * @param phase_start when the part started; set to now for the next part
+ * @return how long the part took, in seconds
+ */
+double end_phase(uint64_t *phase_start) {
+    SDL_RenderFlush(renderer);
+    uint64_t now = SDL_GetPerformanceCounter();
+    double seconds = (double)(now - *phase_start) / SDL_GetPerformanceFrequency();
+    *phase_start = now;
+    return seconds;
+}
+
+void draw_guide(vector_t from, vector_t direction, double length, SDL_Color color) {
+    vector_t to = vec_add(from, vec_multiply(length, direction));
+    aalineRGBA(renderer, from.x, from.y, to.x, to.y, color.r, color.g, color.b, color.a);
+}
+
+/**
+ * Draws the cue ball's predicted path, where it touches something,
+ * and which ways it and any ball it hits go next.
+ */
+void draw_preview(const aim_preview_t *preview) {
+    SDL_Color color = preview->contact == PREVIEW_POCKET ? PREVIEW_SCRATCH_COLOR : PREVIEW_COLOR;
+    if (preview->contact == PREVIEW_UNKNOWN) {
+        color.a = PREVIEW_UNFINISHED_ALPHA;
     }
-    //destroy textures
-    for (size_t i = 0; i < list_size(textures); i++) {
-        SDL_DestroyTexture((SDL_Texture *) list_remove(textures, i));
+    aalineRGBA(renderer, preview->start.x, preview->start.y, preview->end.x, preview->end.y,
+               color.r, color.g, color.b, color.a);
+    if (preview->contact == PREVIEW_UNKNOWN) {
+        return;
+    }
+    aacircleRGBA(renderer, preview->end.x, preview->end.y, preview->radius,
+                 color.r, color.g, color.b, color.a);
+    if (preview->contact == PREVIEW_BALL) {
+        vector_t ball = vec_add(preview->end, vec_multiply(2 * preview->radius, preview->ball_direction));
+        draw_guide(ball, preview->ball_direction, PREVIEW_BALL_GUIDE, color);
+        draw_guide(preview->end, preview->cue_direction, PREVIEW_CUE_GUIDE, color);
     }
 }
 
-void sdl_render_scene(scene_t *scene) {
+/**
+ * Draws a snapshot and presents it, timing each part.
+ */
+void render_snapshot(const render_snapshot_t *snapshot) {
+    uint64_t start = SDL_GetPerformanceCounter();
+    uint64_t phase_start = start;
     sdl_clear();
-    size_t body_count = scene_bodies(scene);
+    last_timings.clear = end_phase(&phase_start);
+    last_timings.sprites = 0;
+    last_timings.text = 0;
     //draw background based on game state
-    if (scene_get_state(scene) == MENU) {
-        sdl_draw_image("./assets/menu_background.png", get_window_center());
+    if (snapshot->state == MENU) {
+        draw_static_layer(NULL, MENU_BACKGROUND);
     }
-    else if (scene_get_state(scene) == 4) {
-        sdl_draw_image("./assets/game_over_1.png", get_window_center());
+    else if (snapshot->state == 4) {
+        draw_static_layer(NULL, GAME_OVER_1_BACKGROUND);
     }
-    else if (scene_get_state(scene) == 5) {
-        sdl_draw_image("./assets/game_over_2.png", get_window_center());
+    else if (snapshot->state == 5) {
+        draw_static_layer(NULL, GAME_OVER_2_BACKGROUND);
     }
     else {
-        sdl_draw_image("./assets/game_background.png", get_window_center());
-        //draw balls
-        vector_t cue_center;
-        for (size_t i = 0; i < 16; i++) {
-            body_t *body = ball_get_body(list_get(scene_get_balls(scene), i));
-            vector_t centroid = body_get_centroid(body);
-            if (i == 0) {
-                cue_center = centroid;
+        draw_static_layer(snapshot, GAME_BACKGROUND);
+    }
+    last_timings.background = end_phase(&phase_start);
+    if (snapshot->state != MENU && snapshot->state != 4 && snapshot->state != 5) {
+        //draw the balls and the cue as one batch, in scene order
+        sprite_batch_clear(sprite_layer);
+        for (size_t i = 0; i < snapshot->num_sprites; i++) {
+            const sprite_instance_t *instance = &snapshot->sprites[i];
+            if (!instance->fixed) {
+                sprite_batch_add(sprite_layer, sprite_atlas_get_rect(sprites, instance->sprite),
+                                 instance->position, instance->angle);
             }
-            char *info = (char *)body_get_info(body);
-            sdl_draw_image(info, centroid);
         }
-        //draw non-ball objects as either polygons or images based on body info
-        for (size_t i = 0; i < body_count; i++) {
-            body_t *body = scene_get_body(scene, i);
-            char *info = (char *)body_get_info(body);
-            if (info == NULL) {
-                /*list_t *shape = body_get_shape(body);
-                sdl_draw_polygon(shape, body_get_color(body));
-                list_free(shape);*/
-            }
-            else if (strcmp(info, "./assets/cue.png") == 0) {
-                char *filename = (char *) body_get_info(body);
-                vector_t coords = body_get_centroid(body);
-                sdl_draw_cue(filename, coords, body_get_angle(body), cue_center);
-            }
-            else if (strcmp(info, "test") != 0) {
-                char *filename = (char *) body_get_info(body);
-                vector_t coords = body_get_centroid(body);
-                sdl_draw_image(filename, coords);
-            }
+        sprite_batch_draw(sprite_layer, renderer);
+        if (snapshot->has_preview && snapshot->state == FIRING) {
+            draw_preview(&snapshot->preview);
         }
-        int turn = scene_get_turn(scene);
-        int players = list_size(scene_get_players(scene));
-        //render player 1 text
-        sdl_draw_player_info(scene_get_player(scene, turn), (vector_t) {42, 69 - 2});
-        //render player 2 text
-        int turn2 = (turn + 1) % players;
-        sdl_draw_player_info(scene_get_player(scene, turn2), (vector_t) {42, 275});
-        //clear textures and surfaces
-    }
-    sdl_clear_images();
+        last_timings.sprites = end_phase(&phase_start);
+        //render player text, the player whose turn it is first
+        for (size_t i = 0; i < snapshot->num_players; i++) {
+            draw_hud_text(snapshot->names[i], snapshot->infos[i], HUD_POSITIONS[i]);
+        }
+        last_timings.text = end_phase(&phase_start);
+    }
     sdl_show();
+    last_timings.present = end_phase(&phase_start);
+    last_timings.total = (double)(phase_start - start) / SDL_GetPerformanceFrequency();
+}
+
+void sdl_set_preview(const aim_preview_t *preview) {
+    has_preview = preview != NULL;
+    if (has_preview) {
+        current_preview = *preview;
+    }
+}
+
+void sdl_render_scene(scene_t *scene) {
+    capture_snapshot(scene, &frame_snapshot);
+    render_snapshot(&frame_snapshot);
+}
+
+void sdl_publish_scene(scene_t *scene) {
+    capture_snapshot(scene, &back_snapshot);
+    SDL_LockMutex(snapshot_lock);
+    front_snapshot = back_snapshot;
+    snapshots_published++;
+    SDL_UnlockMutex(snapshot_lock);
+}
+
+bool sdl_render_published(void) {
+    SDL_LockMutex(snapshot_lock);
+    if (snapshots_rendered == snapshots_published) {
+        SDL_UnlockMutex(snapshot_lock);
+        return false;
+    }
+    frame_snapshot = front_snapshot;
+    snapshots_rendered = snapshots_published;
+    SDL_UnlockMutex(snapshot_lock);
+    render_snapshot(&frame_snapshot);
+    return true;
+}
+
+/**
+ * Decodes an image file and adds its pixels to a pack.
+ */
+bool pack_image(asset_pack_writer_t *writer, const char *file) {
+    SDL_Surface *image = IMG_Load(file);
+    if (image == NULL) {
+        return false;
+    }
+    SDL_Surface *rgba = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(image);
+    if (rgba == NULL) {
+        return false;
+    }
+    // Drop any padding at the ends of the rows
+    size_t row = rgba->w * 4;
+    char *pixels = malloc(row * rgba->h);
+    assert(pixels != NULL);
+    SDL_LockSurface(rgba);
+    for (int y = 0; y < rgba->h; y++) {
+        memcpy(pixels + y * row, (char *)rgba->pixels + y * rgba->pitch, row);
+    }
+    SDL_UnlockSurface(rgba);
+    asset_pack_writer_add(writer, file, ASSET_IMAGE, rgba->w, rgba->h, pixels, row * rgba->h);
+    free(pixels);
+    SDL_FreeSurface(rgba);
+    return true;
+}
+
+bool sdl_write_asset_pack(const char *path) {
+    if (!TTF_WasInit() && TTF_Init() == -1) {
+        printf("TTF_Init: %s\n", TTF_GetError());
+        return false;
+    }
+    asset_pack_writer_t *writer = asset_pack_writer_init();
+    bool packed = true;
+    for (size_t i = 0; i < NUM_SPRITES && packed; i++) {
+        packed = pack_image(writer, sprite_get_path(i));
+    }
+    for (size_t i = 0; i < sizeof(BACKGROUNDS) / sizeof(BACKGROUNDS[0]) && packed; i++) {
+        packed = pack_image(writer, BACKGROUNDS[i]);
+    }
+
+    TTF_Font *font = packed ? TTF_OpenFont(FONT_FILE, FONT_SIZE) : NULL;
+    if (font != NULL) {
+        glyph_t baked[NUM_GLYPHS];
+        SDL_Surface *atlas = bake_glyph_atlas(font, baked);
+        TTF_CloseFont(font);
+        int32_t metrics[5 * NUM_GLYPHS];
+        for (int i = 0; i < NUM_GLYPHS; i++) {
+            metrics[5 * i] = baked[i].src.x;
+            metrics[5 * i + 1] = baked[i].src.y;
+            metrics[5 * i + 2] = baked[i].src.w;
+            metrics[5 * i + 3] = baked[i].src.h;
+            metrics[5 * i + 4] = baked[i].advance;
+        }
+        char name[ASSET_NAME_LENGTH];
+        get_font_asset_name(name);
+        // The atlas surface is made with no padding at the ends of its rows
+        SDL_LockSurface(atlas);
+        asset_pack_writer_add(writer, name, ASSET_GLYPH_ATLAS, atlas->w, atlas->h,
+                              atlas->pixels, (size_t)atlas->pitch * atlas->h);
+        SDL_UnlockSurface(atlas);
+        asset_pack_writer_add(writer, name, ASSET_GLYPH_METRICS, 0, 0, metrics, sizeof(metrics));
+        SDL_FreeSurface(atlas);
+    }
+    packed = packed && font != NULL && asset_pack_writer_save(writer, path);
+    asset_pack_writer_free(writer);
+    return packed;
+}
+
+render_timings_t sdl_get_render_timings(void) {
+    return last_timings;
+}
+
+bool sdl_save_frame(const char *path) {
+    assert(offscreen != NULL);
+    size_t length = strlen(path);
+    if (length >= 4 && strcmp(path + length - 4, ".png") == 0) {
+        return IMG_SavePNG(offscreen, path) == 0;
+    }
+    // Anything else gets the raw RGBA pixels, row by row
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    bool written = true;
+    SDL_LockSurface(offscreen);
+    for (int y = 0; y < offscreen->h && written; y++) {
+        const char *row = (const char *)offscreen->pixels + y * offscreen->pitch;
+        written = fwrite(row, 4, offscreen->w, file) == (size_t)offscreen->w;
+    }
+    SDL_UnlockSurface(offscreen);
+    return fclose(file) == 0 && written;
 }
 
 void sdl_on_key(key_handler_t handler) {
@@ -442,6 +1118,36 @@ double time_since_last_tick(void) {
 }
 
 void sdl_free_images() {
-    list_free(surfaces);
-    list_free(textures);
+    list_free(texture_cache);
+    list_free(text_cache);
+    sprite_batch_free(sprite_layer);
+    sprite_atlas_free(sprites);
+    polygon_batch_free(polygon_layer);
+    free(polygon_x);
+    free(polygon_y);
+    polygon_x = NULL;
+    polygon_y = NULL;
+    polygon_capacity = 0;
+    if (static_layer != NULL) {
+        SDL_DestroyTexture(static_layer);
+        static_layer = NULL;
+    }
+    if (text_layer != NULL) {
+        sprite_batch_free(text_layer);
+        text_layer = NULL;
+    }
+    if (glyph_atlas != NULL) {
+        SDL_DestroyTexture(glyph_atlas);
+        glyph_atlas = NULL;
+    }
+    SDL_DestroyMutex(snapshot_lock);
+    if (assets != NULL) {
+        asset_pack_close(assets);
+        assets = NULL;
+    }
+    if (offscreen != NULL) {
+        SDL_DestroyRenderer(renderer);
+        SDL_FreeSurface(offscreen);
+        offscreen = NULL;
+    }
 }
@@ -0,0 +1,503 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "binary_io.h"
+#include "shot_log.h"
+
+const char SHOT_LOG_MAGIC[] = "PSHT";
+const int SHOT_LOG_VERSION = 1;
+const size_t INITIAL_SHOT_EVENTS = 64;
+const size_t INITIAL_SNAPSHOTS = 4;
+
+// The low bits of the varint starting each event, below the ticks since the previous one
+const uint32_t EVENT_SHOOT = 1;
+const uint32_t EVENT_PULLED_BACK = 2;
+const int EVENT_FLAG_BITS = 2;
+// Saved tables put the balls on a grid this many steps to a pixel,
+// which write_compact_double() stores in 3 bytes instead of 8
+const double SNAPSHOT_STEPS_PER_PIXEL = 1000;
+
+/**
+ * The table saved once the balls stopped after a multiple of the snapshot interval of shots.
+ */
+typedef struct snapshot {
+    uint32_t tick;
+    size_t shots;
+    table_state_t table;
+} snapshot_t;
+
+typedef struct shot_log {
+    unsigned int seed;
+    double dt;
+    size_t snapshot_interval;
+    uint32_t ticks;
+    size_t size;
+    size_t capacity;
+    shot_event_t *events;
+    size_t num_shots;
+    size_t num_snapshots;
+    size_t snapshot_capacity;
+    /** Sorted by tick */
+    snapshot_t *snapshots;
+} shot_log_t;
+
+typedef struct shot_replay {
+    shot_log_t *log;
+    scene_t *scene;
+    uint32_t tick;
+    /** The index of the first event not taken yet */
+    size_t next_event;
+    /** How many shots have been taken */
+    size_t shots;
+} shot_replay_t;
+
+shot_log_t *shot_log_init(unsigned int seed, double dt, size_t snapshot_interval) {
+    shot_log_t *log = malloc(sizeof(shot_log_t));
+    assert(log != NULL);
+    log->seed = seed;
+    log->dt = dt;
+    log->snapshot_interval = snapshot_interval;
+    log->ticks = 0;
+    log->size = 0;
+    log->capacity = INITIAL_SHOT_EVENTS;
+    log->events = malloc(sizeof(shot_event_t) * log->capacity);
+    log->num_shots = 0;
+    log->num_snapshots = 0;
+    log->snapshot_capacity = INITIAL_SNAPSHOTS;
+    log->snapshots = malloc(sizeof(snapshot_t) * log->snapshot_capacity);
+    assert(log->events != NULL && log->snapshots != NULL);
+    return log;
+}
+
+void shot_log_free(shot_log_t *log) {
+    free(log->events);
+    free(log->snapshots);
+    free(log);
+}
+
+void shot_log_add(shot_log_t *log, shot_event_t event) {
+    assert(log->size == 0 || event.tick >= log->events[log->size - 1].tick);
+    if (log->size == log->capacity) {
+        log->capacity *= 2;
+        log->events = realloc(log->events, sizeof(shot_event_t) * log->capacity);
+        assert(log->events != NULL);
+    }
+    log->events[log->size++] = event;
+    if (event.type == SHOT_SHOOT) {
+        log->num_shots++;
+    }
+    if (event.tick > log->ticks) {
+        log->ticks = event.tick;
+    }
+}
+
+snapshot_t *add_snapshot(shot_log_t *log, uint32_t tick, size_t shots) {
+    if (log->num_snapshots == log->snapshot_capacity) {
+        log->snapshot_capacity *= 2;
+        log->snapshots = realloc(log->snapshots, sizeof(snapshot_t) * log->snapshot_capacity);
+        assert(log->snapshots != NULL);
+    }
+    size_t index = log->num_snapshots;
+    while (index > 0 && log->snapshots[index - 1].tick > tick) {
+        index--;
+    }
+    memmove(&log->snapshots[index + 1], &log->snapshots[index],
+            sizeof(snapshot_t) * (log->num_snapshots - index));
+    log->num_snapshots++;
+    snapshot_t *snapshot = &log->snapshots[index];
+    snapshot->tick = tick;
+    snapshot->shots = shots;
+    return snapshot;
+}
+
+double snap_to_grid(double coordinate) {
+    return round(coordinate * SNAPSHOT_STEPS_PER_PIXEL) / SNAPSHOT_STEPS_PER_PIXEL;
+}
+
+/**
+ * Saves the table if it is due to be, given how many shots have been taken by the tick,
+ * with the balls moved onto the grid. The table is then put back from what was saved,
+ * so the game goes on from exactly where a seek to the saved table would.
+ * A replay passing the saved table puts it back the same way.
+ */
+void observe_shots(shot_log_t *log, scene_t *scene, uint32_t tick, size_t shots) {
+    int state = scene_get_state(scene);
+    if (log->snapshot_interval == 0 || shots == 0 || shots % log->snapshot_interval != 0
+        || (state != PLACING && state != FIRING)) {
+        return;
+    }
+    for (size_t i = 0; i < log->num_snapshots; i++) {
+        if (log->snapshots[i].shots == shots) {
+            if (log->snapshots[i].tick == tick) {
+                table_load(scene, &log->snapshots[i].table);
+            }
+            return;
+        }
+    }
+    table_state_t *table = &add_snapshot(log, tick, shots)->table;
+    table_save(scene, table);
+    // The balls have stopped, so this moves each by at most half a step
+    for (int i = 0; i < TABLE_BALLS; i++) {
+        table->balls[i].position.x = snap_to_grid(table->balls[i].position.x);
+        table->balls[i].position.y = snap_to_grid(table->balls[i].position.y);
+    }
+    table_load(scene, table);
+}
+
+void shot_log_observe(shot_log_t *log, scene_t *scene, uint32_t tick) {
+    observe_shots(log, scene, tick, log->num_shots);
+}
+
+void shot_log_set_ticks(shot_log_t *log, uint32_t ticks) {
+    assert(log->size == 0 || ticks >= log->events[log->size - 1].tick);
+    log->ticks = ticks;
+}
+
+size_t shot_log_size(shot_log_t *log) {
+    return log->size;
+}
+
+shot_event_t shot_log_get(shot_log_t *log, size_t index) {
+    assert(index < log->size);
+    return log->events[index];
+}
+
+size_t shot_log_shots(shot_log_t *log) {
+    return log->num_shots;
+}
+
+size_t shot_log_snapshots(shot_log_t *log) {
+    return log->num_snapshots;
+}
+
+unsigned int shot_log_get_seed(shot_log_t *log) {
+    return log->seed;
+}
+
+double shot_log_get_dt(shot_log_t *log) {
+    return log->dt;
+}
+
+uint32_t shot_log_get_ticks(shot_log_t *log) {
+    return log->ticks;
+}
+
+void write_vector(FILE *file, vector_t vector) {
+    write_double(file, vector.x);
+    write_double(file, vector.y);
+}
+
+bool read_vector(FILE *file, vector_t *vector) {
+    return read_double(file, &vector->x) && read_double(file, &vector->y);
+}
+
+/**
+ * Writes a saved table, leaving out the velocities of balls at rest
+ * and the contacts between balls that are not touching.
+ */
+void write_table(FILE *file, const table_state_t *table) {
+    write_uint(file, table->state, 1);
+    write_uint(file, table->turn, 1);
+    write_uint(file, table->has_cue, 1);
+    uint16_t moving = 0;
+    for (int i = 0; i < TABLE_BALLS; i++) {
+        vector_t velocity = table->balls[i].velocity;
+        if (velocity.x != 0 || velocity.y != 0) {
+            moving |= 1 << i;
+        }
+    }
+    write_uint(file, moving, 2);
+    for (int i = 0; i < TABLE_BALLS; i++) {
+        write_compact_double(file, table->balls[i].position.x);
+        write_compact_double(file, table->balls[i].position.y);
+        if (moving & (1 << i)) {
+            write_vector(file, table->balls[i].velocity);
+        }
+    }
+    if (table->has_cue) {
+        write_vector(file, table->cue.position);
+        write_vector(file, table->cue.velocity);
+        write_double(file, table->cue_angle);
+    }
+    for (int p = 0; p < TABLE_PLAYERS; p++) {
+        write_uint(file, (uint8_t)table->turn_states[p], 1);
+        write_uint(file, (uint8_t)table->fouls[p], 1);
+        write_uint(file, table->num_sunk[p], 1);
+        for (int i = 0; i < table->num_sunk[p]; i++) {
+            write_uint(file, table->sunk[p][i], 1);
+        }
+    }
+    // Once the balls have stopped, hardly anything is colliding
+    uint32_t colliding = 0;
+    for (int i = 0; i < TABLE_COLLISIONS; i++) {
+        colliding += table->collision_flags[i];
+    }
+    write_varint(file, colliding);
+    for (int i = 0; i < TABLE_COLLISIONS; i++) {
+        if (table->collision_flags[i]) {
+            write_varint(file, i);
+        }
+    }
+    uint32_t touching = 0;
+    for (int i = 0; i < TABLE_CONTACTS; i++) {
+        touching += table->contact_impulses[i] != 0;
+    }
+    write_varint(file, touching);
+    for (int i = 0; i < TABLE_CONTACTS; i++) {
+        if (table->contact_impulses[i] != 0) {
+            write_varint(file, i);
+            write_double(file, table->contact_impulses[i]);
+        }
+    }
+}
+
+bool read_table(FILE *file, table_state_t *table) {
+    uint64_t state, turn, has_cue, moving, value;
+    memset(table, 0, sizeof(*table));
+    if (!read_uint(file, &state, 1) || !read_uint(file, &turn, 1)
+        || !read_uint(file, &has_cue, 1) || !read_uint(file, &moving, 2)) {
+        return false;
+    }
+    table->state = state;
+    table->turn = turn;
+    table->has_cue = has_cue;
+    for (int i = 0; i < TABLE_BALLS; i++) {
+        if (!read_compact_double(file, &table->balls[i].position.x)
+            || !read_compact_double(file, &table->balls[i].position.y)) {
+            return false;
+        }
+        if ((moving & (1 << i)) && !read_vector(file, &table->balls[i].velocity)) return false;
+    }
+    if (table->has_cue && (!read_vector(file, &table->cue.position)
+                           || !read_vector(file, &table->cue.velocity)
+                           || !read_double(file, &table->cue_angle))) {
+        return false;
+    }
+    for (int p = 0; p < TABLE_PLAYERS; p++) {
+        uint64_t turn_state, fouls, num_sunk;
+        if (!read_uint(file, &turn_state, 1) || !read_uint(file, &fouls, 1)
+            || !read_uint(file, &num_sunk, 1) || num_sunk > TABLE_BALLS) {
+            return false;
+        }
+        table->turn_states[p] = (int8_t)turn_state;
+        table->fouls[p] = (int8_t)fouls;
+        table->num_sunk[p] = num_sunk;
+        for (uint64_t i = 0; i < num_sunk; i++) {
+            if (!read_uint(file, &value, 1) || value >= TABLE_BALLS) return false;
+            table->sunk[p][i] = value;
+        }
+    }
+    uint32_t colliding, touching, index;
+    if (!read_varint(file, &colliding) || colliding > TABLE_COLLISIONS) return false;
+    for (uint32_t i = 0; i < colliding; i++) {
+        if (!read_varint(file, &index) || index >= TABLE_COLLISIONS) return false;
+        table->collision_flags[index] = true;
+    }
+    if (!read_varint(file, &touching) || touching > TABLE_CONTACTS) return false;
+    for (uint32_t i = 0; i < touching; i++) {
+        if (!read_varint(file, &index) || index >= TABLE_CONTACTS
+            || !read_double(file, &table->contact_impulses[index])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool shot_log_save(shot_log_t *log, const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    fwrite(SHOT_LOG_MAGIC, 1, strlen(SHOT_LOG_MAGIC), file);
+    write_uint(file, SHOT_LOG_VERSION, 1);
+    write_uint(file, log->seed, 4);
+    write_double(file, log->dt);
+    write_uint(file, log->ticks, 4);
+    write_varint(file, log->snapshot_interval);
+    write_varint(file, log->size);
+    write_varint(file, log->num_snapshots);
+    uint32_t last_tick = 0;
+    for (size_t i = 0; i < log->size; i++) {
+        shot_event_t *event = &log->events[i];
+        uint32_t flags = 0;
+        if (event->type == SHOT_SHOOT) {
+            flags = EVENT_SHOOT | (event->pull_back != 0 ? EVENT_PULLED_BACK : 0);
+        }
+        assert(event->tick - last_tick < 1u << (32 - EVENT_FLAG_BITS));
+        write_varint(file, (event->tick - last_tick) << EVENT_FLAG_BITS | flags);
+        last_tick = event->tick;
+        if (event->type == SHOT_PLACE) {
+            write_compact_double(file, event->position.x);
+            write_compact_double(file, event->position.y);
+        }
+        else {
+            // Angles are hardly ever whole thousandths, so they are always written in full
+            write_double(file, event->angle);
+            write_compact_double(file, event->power);
+            if (flags & EVENT_PULLED_BACK) {
+                write_compact_double(file, event->pull_back);
+            }
+        }
+    }
+    for (size_t i = 0; i < log->num_snapshots; i++) {
+        write_varint(file, log->snapshots[i].tick);
+        write_varint(file, log->snapshots[i].shots);
+        write_table(file, &log->snapshots[i].table);
+    }
+    bool written = !ferror(file);
+    return fclose(file) == 0 && written;
+}
+
+shot_log_t *shot_log_load(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+    char magic[sizeof(SHOT_LOG_MAGIC)] = {0};
+    uint64_t version, seed, ticks;
+    uint32_t interval, size, snapshots;
+    double dt;
+    if (fread(magic, 1, strlen(SHOT_LOG_MAGIC), file) != strlen(SHOT_LOG_MAGIC)
+        || strcmp(magic, SHOT_LOG_MAGIC) != 0
+        || !read_uint(file, &version, 1) || version != SHOT_LOG_VERSION
+        || !read_uint(file, &seed, 4) || !read_double(file, &dt)
+        || !read_uint(file, &ticks, 4) || !read_varint(file, &interval)
+        || !read_varint(file, &size) || !read_varint(file, &snapshots)) {
+        fclose(file);
+        return NULL;
+    }
+
+    shot_log_t *log = shot_log_init(seed, dt, interval);
+    uint32_t tick = 0;
+    bool ok = true;
+    for (uint32_t i = 0; i < size && ok; i++) {
+        uint32_t header;
+        shot_event_t event = {0};
+        ok = read_varint(file, &header) && (header & EVENT_SHOOT || !(header & EVENT_PULLED_BACK));
+        if (!ok) break;
+        tick += header >> EVENT_FLAG_BITS;
+        event.tick = tick;
+        event.type = header & EVENT_SHOOT ? SHOT_SHOOT : SHOT_PLACE;
+        if (event.type == SHOT_PLACE) {
+            ok = read_compact_double(file, &event.position.x)
+                 && read_compact_double(file, &event.position.y);
+        }
+        else {
+            ok = read_double(file, &event.angle) && read_compact_double(file, &event.power)
+                 && (!(header & EVENT_PULLED_BACK) || read_compact_double(file, &event.pull_back));
+        }
+        if (ok) {
+            shot_log_add(log, event);
+        }
+    }
+    for (uint32_t i = 0; i < snapshots && ok; i++) {
+        uint32_t snapshot_tick, shots;
+        table_state_t table;
+        ok = read_varint(file, &snapshot_tick) && read_varint(file, &shots)
+             && read_table(file, &table);
+        if (ok) {
+            add_snapshot(log, snapshot_tick, shots)->table = table;
+        }
+    }
+    fclose(file);
+    if (!ok || tick > ticks) {
+        shot_log_free(log);
+        return NULL;
+    }
+    log->ticks = ticks;
+    return log;
+}
+
+/**
+ * Racks the table the same way the game did.
+ */
+scene_t *rack_table(shot_log_t *log) {
+    srand(log->seed);
+    scene_t *scene = scene_init();
+    scene_set_state(scene, MENU);
+    populate_scene(scene);
+    // Leaving the menu only changes the state, and the balls do not move before the break
+    scene_set_state(scene, PLACING);
+    return scene;
+}
+
+shot_replay_t *shot_replay_init(shot_log_t *log) {
+    shot_replay_t *replay = malloc(sizeof(shot_replay_t));
+    assert(replay != NULL);
+    replay->log = log;
+    replay->scene = rack_table(log);
+    replay->tick = 0;
+    replay->next_event = 0;
+    replay->shots = 0;
+    return replay;
+}
+
+void shot_replay_free(shot_replay_t *replay) {
+    scene_free(replay->scene);
+    free(replay);
+}
+
+scene_t *shot_replay_get_scene(shot_replay_t *replay) {
+    return replay->scene;
+}
+
+uint32_t shot_replay_get_tick(shot_replay_t *replay) {
+    return replay->tick;
+}
+
+void take_event(shot_replay_t *replay, shot_event_t *event) {
+    scene_t *scene = replay->scene;
+    if (event->type == SHOT_PLACE) {
+        bool placed = table_place_cue_ball(scene, event->position);
+        assert(placed);
+    }
+    else {
+        // The same steps as a computer player's shot, see ai_play_shot(),
+        // but striking with the cue rebuilt where it was, see table_set_cue()
+        update_game_state(scene);
+        table_set_cue(scene, event->angle, event->pull_back);
+        table_shoot(scene, event->power);
+        replay->shots++;
+    }
+}
+
+void shot_replay_step(shot_replay_t *replay) {
+    shot_log_t *log = replay->log;
+    while (replay->next_event < log->size && log->events[replay->next_event].tick == replay->tick) {
+        take_event(replay, &log->events[replay->next_event++]);
+    }
+    scene_tick(replay->scene, log->dt);
+    update_game_state(replay->scene);
+    table_park_sunk_balls(replay->scene);
+    replay->tick++;
+    observe_shots(log, replay->scene, replay->tick, replay->shots);
+}
+
+void shot_replay_seek(shot_replay_t *replay, uint32_t tick) {
+    shot_log_t *log = replay->log;
+    snapshot_t *snapshot = NULL;
+    for (size_t i = 0; i < log->num_snapshots && log->snapshots[i].tick <= tick; i++) {
+        snapshot = &log->snapshots[i];
+    }
+    if (snapshot != NULL && (tick < replay->tick || snapshot->tick > replay->tick)) {
+        table_load(replay->scene, &snapshot->table);
+        replay->tick = snapshot->tick;
+        replay->shots = snapshot->shots;
+        replay->next_event = 0;
+        while (replay->next_event < log->size && log->events[replay->next_event].tick < replay->tick) {
+            replay->next_event++;
+        }
+    }
+    else if (tick < replay->tick) {
+        scene_free(replay->scene);
+        replay->scene = rack_table(log);
+        replay->tick = 0;
+        replay->next_event = 0;
+        replay->shots = 0;
+    }
+    while (replay->tick < tick) {
+        shot_replay_step(replay);
+    }
+}
@@ -0,0 +1,267 @@
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "spring_network.h"
+
+#define INITIAL_CAPACITY 16
+// The conjugate gradient solve stops once the residual is this small
+// relative to the right hand side, or after this many iterations.
+const double SOLVE_TOLERANCE = 1e-10;
+const size_t MAX_SOLVE_ITERATIONS = 200;
+
+typedef struct spring {
+    double k;
+    size_t body1;
+    size_t body2;
+} spring_t;
+
+typedef struct spring_network {
+    scene_t *scene;
+    list_t *bodies;
+    spring_t *springs;
+    size_t num_springs;
+    size_t spring_cap;
+    // per body, gathered or computed each tick
+    size_t capacity;
+    bool *fixed;
+    double *mass;
+    double *diagonal;
+    vector_t *position;
+    vector_t *velocity;
+    // the change in velocity over a tick, kept to start the next solve from
+    vector_t *dv;
+    vector_t *rhs;
+    vector_t *residual;
+    vector_t *direction;
+    vector_t *product;
+    vector_t *preconditioned;
+} spring_network_t;
+
+spring_network_t *spring_network_init(void) {
+    spring_network_t *network = malloc(sizeof(spring_network_t));
+    assert(network != NULL);
+    network->scene = NULL;
+    network->bodies = list_init(INITIAL_CAPACITY, NULL);
+    network->springs = malloc(INITIAL_CAPACITY * sizeof(spring_t));
+    assert(network->springs != NULL);
+    network->num_springs = 0;
+    network->spring_cap = INITIAL_CAPACITY;
+    network->capacity = 0;
+    network->fixed = NULL;
+    network->mass = NULL;
+    network->diagonal = NULL;
+    network->position = NULL;
+    network->velocity = NULL;
+    network->dv = NULL;
+    network->rhs = NULL;
+    network->residual = NULL;
+    network->direction = NULL;
+    network->product = NULL;
+    network->preconditioned = NULL;
+    return network;
+}
+
+void free_arrays(spring_network_t *network) {
+    free(network->fixed);
+    free(network->mass);
+    free(network->diagonal);
+    free(network->position);
+    free(network->velocity);
+    free(network->dv);
+    free(network->rhs);
+    free(network->residual);
+    free(network->direction);
+    free(network->product);
+    free(network->preconditioned);
+}
+
+void spring_network_free(spring_network_t *network) {
+    // once added to a scene, the scene owns the list of bodies
+    if (network->scene == NULL) {
+        list_free(network->bodies);
+    }
+    free(network->springs);
+    free_arrays(network);
+    free(network);
+}
+
+size_t spring_network_add_body(spring_network_t *network, body_t *body) {
+    assert(network->scene == NULL);
+    list_add(network->bodies, body);
+    return list_size(network->bodies) - 1;
+}
+
+void spring_network_add(spring_network_t *network, double k, size_t body1, size_t body2) {
+    assert(network->scene == NULL);
+    assert(body1 < list_size(network->bodies) && body2 < list_size(network->bodies));
+    if (network->num_springs >= network->spring_cap) {
+        network->spring_cap *= 2;
+        network->springs = realloc(network->springs, network->spring_cap * sizeof(spring_t));
+        assert(network->springs != NULL);
+    }
+    spring_t *spring = &network->springs[network->num_springs++];
+    spring->k = k;
+    spring->body1 = body1;
+    spring->body2 = body2;
+}
+
+void *alloc_array(size_t n, size_t size) {
+    void *array = malloc(n * size);
+    assert(array != NULL);
+    return array;
+}
+
+void reserve(spring_network_t *network, size_t n) {
+    if (n <= network->capacity) {
+        return;
+    }
+    free_arrays(network);
+    network->fixed = alloc_array(n, sizeof(bool));
+    network->mass = alloc_array(n, sizeof(double));
+    network->diagonal = alloc_array(n, sizeof(double));
+    network->position = alloc_array(n, sizeof(vector_t));
+    network->velocity = alloc_array(n, sizeof(vector_t));
+    network->dv = alloc_array(n, sizeof(vector_t));
+    network->rhs = alloc_array(n, sizeof(vector_t));
+    network->residual = alloc_array(n, sizeof(vector_t));
+    network->direction = alloc_array(n, sizeof(vector_t));
+    network->product = alloc_array(n, sizeof(vector_t));
+    network->preconditioned = alloc_array(n, sizeof(vector_t));
+    for (size_t i = 0; i < n; i++) {
+        network->dv[i] = VEC_ZERO;
+    }
+    network->capacity = n;
+}
+
+// out = L * in, where L is the graph Laplacian of the network weighted by k,
+// so that -L * positions are the spring forces
+void apply_laplacian(spring_network_t *network, const vector_t *in, vector_t *out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = VEC_ZERO;
+    }
+    for (size_t s = 0; s < network->num_springs; s++) {
+        spring_t *spring = &network->springs[s];
+        double dx = in[spring->body1].x - in[spring->body2].x;
+        double dy = in[spring->body1].y - in[spring->body2].y;
+        out[spring->body1].x += spring->k * dx;
+        out[spring->body1].y += spring->k * dy;
+        out[spring->body2].x -= spring->k * dx;
+        out[spring->body2].y -= spring->k * dy;
+    }
+}
+
+// out = (M + dt^2 L) * in over the bodies that are free to move
+void apply_system(spring_network_t *network, const vector_t *in, vector_t *out, size_t n, double dt) {
+    apply_laplacian(network, in, out, n);
+    for (size_t i = 0; i < n; i++) {
+        if (network->fixed[i]) {
+            out[i] = VEC_ZERO;
+            continue;
+        }
+        out[i].x = network->mass[i] * in[i].x + dt * dt * out[i].x;
+        out[i].y = network->mass[i] * in[i].y + dt * dt * out[i].y;
+    }
+}
+
+double dot(const vector_t *a, const vector_t *b, size_t n) {
+    double sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += a[i].x * b[i].x + a[i].y * b[i].y;
+    }
+    return sum;
+}
+
+// Solves (M + dt^2 L) dv = rhs for dv with Jacobi-preconditioned
+// conjugate gradients, starting from the last tick's dv.
+void solve(spring_network_t *network, size_t n, double dt) {
+    vector_t *x = network->dv;
+    vector_t *r = network->residual;
+    vector_t *p = network->direction;
+    vector_t *ap = network->product;
+    vector_t *z = network->preconditioned;
+
+    apply_system(network, x, ap, n, dt);
+    for (size_t i = 0; i < n; i++) {
+        r[i] = vec_subtract(network->rhs[i], ap[i]);
+        z[i] = vec_multiply(1 / network->diagonal[i], r[i]);
+        p[i] = z[i];
+    }
+    double rz = dot(r, z, n);
+    double limit = SOLVE_TOLERANCE * SOLVE_TOLERANCE * dot(network->rhs, network->rhs, n);
+    for (size_t iter = 0; iter < MAX_SOLVE_ITERATIONS && dot(r, r, n) > limit; iter++) {
+        apply_system(network, p, ap, n, dt);
+        double pap = dot(p, ap, n);
+        if (pap <= 0) {
+            break;
+        }
+        double alpha = rz / pap;
+        for (size_t i = 0; i < n; i++) {
+            x[i] = vec_add(x[i], vec_multiply(alpha, p[i]));
+            r[i] = vec_subtract(r[i], vec_multiply(alpha, ap[i]));
+            z[i] = vec_multiply(1 / network->diagonal[i], r[i]);
+        }
+        double rz_next = dot(r, z, n);
+        double beta = rz_next / rz;
+        rz = rz_next;
+        for (size_t i = 0; i < n; i++) {
+            p[i] = vec_add(z[i], vec_multiply(beta, p[i]));
+        }
+    }
+}
+
+// Backward Euler on the springs gives
+//   (M + dt^2 L) dv = dt (f - dt L v)
+// where f = -L x are the spring forces now. The force that makes
+// body_tick() change the velocity by exactly dv is then M dv / dt.
+void spring_network_tick(spring_network_t *network) {
+    double dt = scene_get_dt(network->scene);
+    size_t n = list_size(network->bodies);
+    if (dt <= 0 || n == 0) {
+        return;
+    }
+    reserve(network, n);
+    for (size_t i = 0; i < n; i++) {
+        body_t *body = list_get(network->bodies, i);
+        network->mass[i] = body_get_mass(body);
+        network->fixed[i] = network->mass[i] == DBL_MAX;
+        network->position[i] = body_get_centroid(body);
+        network->velocity[i] = body_get_velocity(body);
+        network->diagonal[i] = network->mass[i];
+    }
+    for (size_t s = 0; s < network->num_springs; s++) {
+        spring_t *spring = &network->springs[s];
+        network->diagonal[spring->body1] += dt * dt * spring->k;
+        network->diagonal[spring->body2] += dt * dt * spring->k;
+    }
+
+    vector_t *force = network->rhs;
+    vector_t *lv = network->product;
+    apply_laplacian(network, network->position, force, n);
+    apply_laplacian(network, network->velocity, lv, n);
+    for (size_t i = 0; i < n; i++) {
+        if (network->fixed[i]) {
+            network->rhs[i] = VEC_ZERO;
+            network->dv[i] = VEC_ZERO;
+            continue;
+        }
+        network->rhs[i].x = -dt * (force[i].x + dt * lv[i].x);
+        network->rhs[i].y = -dt * (force[i].y + dt * lv[i].y);
+    }
+    solve(network, n, dt);
+
+    for (size_t i = 0; i < n; i++) {
+        if (!network->fixed[i]) {
+            body_add_force(list_get(network->bodies, i),
+                           vec_multiply(network->mass[i] / dt, network->dv[i]));
+        }
+    }
+}
+
+void create_spring_network(scene_t *scene, spring_network_t *network) {
+    assert(network->scene == NULL);
+    network->scene = scene;
+    scene_add_kind_force_creator(scene, FORCE_SPRING, (force_creator_t)spring_network_tick,
+                                 network, network->bodies, (free_func_t)spring_network_free);
+}
@@ -0,0 +1,203 @@
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include "sprite_batch.h"
+
+// Sprites are packed into rows no wider than this, unless one is wider
+const int ATLAS_WIDTH = 1024;
+// Empty pixels between sprites, so filtering never picks up a neighbour
+const int ATLAS_PADDING = 1;
+const size_t INITIAL_SPRITES = 32;
+const int VERTICES_PER_SPRITE = 4;
+const int INDICES_PER_SPRITE = 6;
+const SDL_Color SPRITE_TINT = {255, 255, 255, 255};
+
+typedef struct sprite_atlas {
+    size_t count;
+    SDL_Rect *rects;
+    SDL_Texture *texture;
+} sprite_atlas_t;
+
+typedef struct sprite_batch {
+    SDL_Texture *texture;
+    float inv_width;
+    float inv_height;
+    size_t size;
+    size_t capacity;
+    SDL_Vertex *vertices;
+    int *indices;
+} sprite_batch_t;
+
+/**
+ * Gets an image from a pack without copying its pixels,
+ * or decodes it from its file if the pack does not have it.
+ */
+SDL_Surface *load_image(const char *file, asset_pack_t *pack) {
+    int w, h;
+    void *pixels = pack == NULL
+        ? NULL
+        : (void *)asset_pack_find(pack, file, ASSET_IMAGE, &w, &h, NULL);
+    if (pixels != NULL) {
+        // The surface is only ever read from, so the pack's read-only mapping is safe
+        return SDL_CreateRGBSurfaceWithFormatFrom(pixels, w, h, 32, w * 4, SDL_PIXELFORMAT_RGBA32);
+    }
+    return IMG_Load(file);
+}
+
+sprite_atlas_t *sprite_atlas_init(
+    SDL_Renderer *renderer, const char *const *files, size_t count, asset_pack_t *pack
+) {
+    sprite_atlas_t *atlas = malloc(sizeof(sprite_atlas_t));
+    assert(atlas != NULL);
+    atlas->count = count;
+    atlas->rects = malloc(sizeof(SDL_Rect) * count);
+    SDL_Surface **images = malloc(sizeof(SDL_Surface *) * count);
+    assert(atlas->rects != NULL && images != NULL);
+
+    int width = ATLAS_WIDTH;
+    for (size_t i = 0; i < count; i++) {
+        images[i] = load_image(files[i], pack);
+        assert(images[i] != NULL);
+        if (images[i]->w > width) width = images[i]->w;
+    }
+
+    // Place the sprites left to right, starting a new row when one is full
+    int x = 0, y = 0, row_height = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (x + images[i]->w > width) {
+            x = 0;
+            y += row_height + ATLAS_PADDING;
+            row_height = 0;
+        }
+        atlas->rects[i] = (SDL_Rect) {x, y, images[i]->w, images[i]->h};
+        x += images[i]->w + ATLAS_PADDING;
+        if (images[i]->h > row_height) row_height = images[i]->h;
+    }
+
+    SDL_Surface *packed = SDL_CreateRGBSurfaceWithFormat(
+        0, width, y + row_height, 32, SDL_PIXELFORMAT_RGBA32
+    );
+    assert(packed != NULL);
+    for (size_t i = 0; i < count; i++) {
+        SDL_SetSurfaceBlendMode(images[i], SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(images[i], NULL, packed, &atlas->rects[i]);
+        SDL_FreeSurface(images[i]);
+    }
+    free(images);
+    atlas->texture = SDL_CreateTextureFromSurface(renderer, packed);
+    assert(atlas->texture != NULL);
+    SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+    SDL_FreeSurface(packed);
+    return atlas;
+}
+
+void sprite_atlas_free(sprite_atlas_t *atlas) {
+    free(atlas->rects);
+    SDL_DestroyTexture(atlas->texture);
+    free(atlas);
+}
+
+SDL_Texture *sprite_atlas_get_texture(sprite_atlas_t *atlas) {
+    return atlas->texture;
+}
+
+SDL_Rect sprite_atlas_get_rect(sprite_atlas_t *atlas, size_t sprite) {
+    assert(sprite < atlas->count);
+    return atlas->rects[sprite];
+}
+
+sprite_batch_t *sprite_batch_init(SDL_Texture *texture) {
+    sprite_batch_t *batch = malloc(sizeof(sprite_batch_t));
+    assert(batch != NULL);
+    int w, h;
+    SDL_QueryTexture(texture, NULL, NULL, &w, &h);
+    batch->texture = texture;
+    batch->inv_width = 1.0f / w;
+    batch->inv_height = 1.0f / h;
+    batch->size = 0;
+    batch->capacity = INITIAL_SPRITES;
+    batch->vertices = malloc(sizeof(SDL_Vertex) * VERTICES_PER_SPRITE * batch->capacity);
+    batch->indices = malloc(sizeof(int) * INDICES_PER_SPRITE * batch->capacity);
+    assert(batch->vertices != NULL && batch->indices != NULL);
+    return batch;
+}
+
+void sprite_batch_free(sprite_batch_t *batch) {
+    free(batch->vertices);
+    free(batch->indices);
+    free(batch);
+}
+
+void sprite_batch_clear(sprite_batch_t *batch) {
+    batch->size = 0;
+}
+
+size_t sprite_batch_size(sprite_batch_t *batch) {
+    return batch->size;
+}
+
+/**
+ * Adds a sprite whose corners go at the given points on screen,
+ * clockwise from the top left.
+ */
+void add_quad(sprite_batch_t *batch, SDL_Rect src, const SDL_FPoint *corners) {
+    if (batch->size == batch->capacity) {
+        batch->capacity *= 2;
+        batch->vertices = realloc(batch->vertices,
+            sizeof(SDL_Vertex) * VERTICES_PER_SPRITE * batch->capacity);
+        batch->indices = realloc(batch->indices,
+            sizeof(int) * INDICES_PER_SPRITE * batch->capacity);
+        assert(batch->vertices != NULL && batch->indices != NULL);
+    }
+    float u0 = src.x * batch->inv_width, u1 = (src.x + src.w) * batch->inv_width,
+          v0 = src.y * batch->inv_height, v1 = (src.y + src.h) * batch->inv_height;
+    SDL_FPoint tex_coords[] = {{u0, v0}, {u1, v0}, {u1, v1}, {u0, v1}};
+
+    int first = batch->size * VERTICES_PER_SPRITE;
+    SDL_Vertex *vertex = &batch->vertices[first];
+    for (int i = 0; i < VERTICES_PER_SPRITE; i++) {
+        vertex[i].position = corners[i];
+        vertex[i].color = SPRITE_TINT;
+        vertex[i].tex_coord = tex_coords[i];
+    }
+    // Two triangles: top left, top right, bottom right and bottom right, bottom left, top left
+    int *index = &batch->indices[batch->size * INDICES_PER_SPRITE];
+    index[0] = first;
+    index[1] = first + 1;
+    index[2] = first + 2;
+    index[3] = first + 2;
+    index[4] = first + 3;
+    index[5] = first;
+    batch->size++;
+}
+
+void sprite_batch_add(sprite_batch_t *batch, SDL_Rect src, vector_t center, double angle) {
+    double half_w = src.w / 2.0, half_h = src.h / 2.0;
+    double offsets[][2] = {{-half_w, -half_h}, {half_w, -half_h}, {half_w, half_h}, {-half_w, half_h}};
+    // With y pointing down, this turns the sprite clockwise on screen
+    double c = cos(angle), s = sin(angle);
+    SDL_FPoint corners[4];
+    for (int i = 0; i < VERTICES_PER_SPRITE; i++) {
+        double dx = offsets[i][0], dy = offsets[i][1];
+        corners[i].x = center.x + dx * c - dy * s;
+        corners[i].y = center.y + dx * s + dy * c;
+    }
+    add_quad(batch, src, corners);
+}
+
+void sprite_batch_add_rect(sprite_batch_t *batch, SDL_Rect src, SDL_Rect dst) {
+    float left = dst.x, right = dst.x + dst.w, top = dst.y, bottom = dst.y + dst.h;
+    SDL_FPoint corners[] = {{left, top}, {right, top}, {right, bottom}, {left, bottom}};
+    add_quad(batch, src, corners);
+}
+
+void sprite_batch_draw(sprite_batch_t *batch, SDL_Renderer *renderer) {
+    if (batch->size == 0) return;
+    SDL_RenderGeometry(
+        renderer, batch->texture,
+        batch->vertices, batch->size * VERTICES_PER_SPRITE,
+        batch->indices, batch->size * INDICES_PER_SPRITE
+    );
+}
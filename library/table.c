@@ -0,0 +1,537 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "table.h"
+#include "ball.h"
+#include "body.h"
+#include "forces.h"
+#include "player.h"
+
+const int CUE_WIDTH = 10;
+const int CUE_HEIGHT = 300;
+const int CUE_MASS = 1000;
+const double CUE_ELASTICITY = 1.0;
+const double VEL_SCALAR = 100;
+const int BOX_VERTICES = 4;
+const double BOX_MASS = INFINITY;
+const int BALL_INDEX = 12;
+const int NUM_BALLS = 16;
+const double WALL_ELASTICITY = 0.8;
+const double BALL_ELASTICITY = 0.92;
+const size_t CONTACT_ITERATIONS = 8;
+const double CONTACT_BAUMGARTE = 0.2;
+const double CONTACT_SLOP = 0.5;
+const double FRICTION_CONST = 0.27;//9.8*0.25;
+const int WALL_POINTS = 6;
+const vector_t LEFT_WALL[] = {{297, 388}, {301, 388}, {309, 379}, {309, 125}, {299, 115}, {297, 115}};
+const vector_t RIGHT_WALL[] = {{948, 387}, {943, 387}, {935, 376}, {935, 127}, {944, 116}, {948, 116}};
+const vector_t TOP_LEFT_WALL[] = {{322, 414}, {322, 410}, {332, 402}, {601, 402}, {605, 410}, {605, 414}};
+const vector_t TOP_RIGHT_WALL[] = {{639, 414}, {639, 410}, {643, 402}, {914, 402}, {922, 409}, {922, 413}};
+const vector_t BOTTOM_LEFT_WALL[] = {{321, 93}, {330, 101}, {599, 101}, {604, 92}, {604, 89}, {321, 89}};
+const vector_t BOTTOM_RIGHT_WALL[] = {{639, 92}, {646, 101}, {913, 101}, {923, 93}, {923, 90}, {639, 90}};
+const int POCKET_POINTS = 3;
+const vector_t TOP_LEFT_POCKET[] = {{298, 393}, {317, 412}, {297, 394}};
+const vector_t TOP_RIGHT_POCKET[] = {{926, 411}, {945, 381}, {941, 408}};
+const vector_t BOTTOM_LEFT_POCKET[] = {{315, 89}, {295, 109}, {295, 112}};
+const vector_t BOTTOM_RIGHT_POCKET[] = {{930, 89}, {950, 109}, {944, 95}};
+const vector_t TOP_POCKET[] = {{606, 416}, {637, 416}, {622, 424}};
+const vector_t BOTTOM_POCKET[] = {{622, 80}, {609, 82}, {623, 72}, {635, 82}};
+const vector_t *const POCKETS[TABLE_POCKETS] = {
+    TOP_LEFT_POCKET, TOP_POCKET, TOP_RIGHT_POCKET, BOTTOM_RIGHT_POCKET, BOTTOM_POCKET, BOTTOM_LEFT_POCKET
+};
+const vector_t KITCHEN[] = {{309, 101}, {463, 402}};
+const vector_t FIRST_BALL_COORDS = {778, 250};
+const vector_t CUE_BALL_START = {400, 250};
+const vector_t CURRENT_PLAYER_RACK = {42, 69 - 2};
+const vector_t OTHER_PLAYER_RACK = {42, 275};
+const vector_t RACK_OFFSET = {10, 127};
+const vector_t PLAYER_1_BALL_RACK = {55, 190};
+const vector_t PLAYER_2_BALL_RACK = {55, 400};
+const int BALL_RACK_SPACING = 3;
+
+void scene_add_wall(scene_t *scene, const vector_t coords[], int elements) {
+    list_t *points = list_init(elements, (free_func_t) free);
+    for (size_t i = 0; i < elements; i++) {
+        vector_t *vec = malloc(sizeof(vector_t));
+        vec[0] = coords[i];
+        list_add(points, vec);
+    }
+    body_t *wall = body_init(points, BOX_MASS, (rgb_color_t) {0,0,0});
+    scene_add_body(scene, wall);
+}
+
+list_t *cue_generate_points(vector_t dimensions) {
+    double width = dimensions.x;
+    double height = dimensions.y;
+    list_t *points = list_init(BOX_VERTICES, (free_func_t)free);
+    vector_t *v1 = malloc(sizeof(vector_t));
+    assert (v1 != 0);
+    v1[0] = (vector_t){0.5*width, 0.5*height};
+    list_add(points, v1);
+
+    vector_t *v2 = malloc(sizeof(vector_t));
+    assert (v2 != 0);
+    v2[0] = (vector_t){-0.5*width, 0.5*height};
+    list_add(points, v2);
+
+    vector_t *v3 = malloc(sizeof(vector_t));
+    assert (v3 != 0);
+    v3[0] = (vector_t){-0.5*width, -0.5*height};
+    list_add(points, v3);
+
+    vector_t *v4 = malloc(sizeof(vector_t));
+    assert (v4 != 0);
+    v4[0] = (vector_t){0.5*width, -0.5*height};
+    list_add(points, v4);
+    return points;
+}
+
+void scene_add_ball_collisions(scene_t *scene, list_t *balls)
+{
+    // balls are never removed, only moved off the table, so they can share one friction force
+    list_t *ball_bodies = list_init(list_size(balls), NULL);
+    for (int i = 0; i < list_size(balls); i++)
+    {
+        list_add(ball_bodies, ball_get_body(list_get(balls, i)));
+    }
+    create_group_friction(scene, FRICTION_CONST, ball_bodies);
+    // balls touch each other in clusters (the rack especially),
+    // so they are resolved together by the contact solver
+    contact_solver_t *solver = contact_solver_init(CONTACT_ITERATIONS, CONTACT_BAUMGARTE, CONTACT_SLOP);
+    scene_set_contact_solver(scene, solver);
+    for (int i = 0; i < list_size(balls); i++)
+    {
+        ball_t *curr_ball = (ball_t *)list_get(balls, i);
+        body_t *curr_body = ball_get_body(curr_ball);
+        for (int j = 0; j < 6; j++)
+        {
+            body_t *wall = scene_get_body(scene, j);
+            create_physics_collision(scene, WALL_ELASTICITY, curr_body, wall, false);
+        }
+        for (int l = 6; l < BALL_INDEX; l++)
+        {
+            // either use physics collision with removal or make a new physics collision to translate the pocketed ball
+            body_t *pocket = scene_get_body(scene, l);
+            create_physics_collision_with_translation(scene, WALL_ELASTICITY, curr_body, pocket, curr_ball);
+        }
+        for (int k = i + 1; k < NUM_BALLS; k++)
+        {
+            body_t *temp_body = ball_get_body(list_get(balls, k));
+            contact_solver_add_pair(solver, BALL_ELASTICITY, curr_body, temp_body);
+        }
+    }
+}
+
+void scene_add_balls(scene_t *scene, vector_t cue_start, vector_t ball_start, bool shuffle) {
+    list_t *balls = scene_get_balls(scene);
+    list_add(balls, ball_init(0, cue_start));
+    double radius = ball_get_radius(list_get(balls, 0));
+    vector_t curr = ball_start;
+    list_add(balls, ball_init(1, ball_start));
+    double x_inc = cos(M_PI/6)*2*radius;
+    double y_inc = sin(M_PI/6)*2*radius;
+    curr = vec_add(curr, (vector_t){x_inc, y_inc});
+    vector_t loc = curr;
+    for (size_t i = 2; i < 4; i++) {
+        loc = vec_subtract(curr, vec_multiply((i-2), (vector_t){0,2*radius}));
+        list_add(balls, ball_init(i, loc));
+    }
+    curr = vec_add(curr, (vector_t){x_inc, y_inc});
+    for (size_t j = 4; j < 7; j++) {
+        loc = vec_subtract(curr, vec_multiply((j-4), (vector_t){0,2*radius}));
+        list_add(balls, ball_init(j, loc));
+    }
+    curr = vec_add(curr, (vector_t){x_inc, y_inc});
+    for (size_t k = 7; k < 11; k++) {
+        loc = vec_subtract(curr, vec_multiply((k-7), (vector_t){0,2*radius}));
+        list_add(balls, ball_init(k, loc));
+    }
+    curr = vec_add(curr, (vector_t){x_inc, y_inc});
+    for (size_t l = 11; l < NUM_BALLS; l++) {
+        loc = vec_subtract(curr, vec_multiply((l-11), (vector_t){0,2*radius}));
+        list_add(balls, ball_init(l, loc));
+    }
+
+    if (!shuffle) {
+        scene_add_ball_collisions(scene, balls);
+        scene_add_ball_list(scene, balls);
+        return;
+    }
+
+    size_t cent_ball_num = 5;
+    vector_t cent_loc = body_get_centroid(ball_get_body(list_get(balls, cent_ball_num)));
+
+    float rand_swaps = ((((float)rand() / RAND_MAX) * (NUM_BALLS + 1)));
+    for (size_t m = 0; m < rand_swaps; m++) {
+        size_t rand1 = (size_t)((((float)rand() / RAND_MAX) * (NUM_BALLS - 1))+1);
+        size_t rand2 = (size_t)((((float)rand() / RAND_MAX) * (NUM_BALLS - 1))+1);
+        while (rand2 == rand1) {
+            rand2 = (size_t)((((float)rand() / RAND_MAX) * (NUM_BALLS - 1))+1);
+        }
+        body_t *r1_body = ball_get_body(list_get(balls, rand1));
+        body_t *r2_body = ball_get_body(list_get(balls, rand2));
+        vector_t r1_cent = body_get_centroid(r1_body);
+        vector_t r2_cent = body_get_centroid(r2_body);
+        body_set_centroid(r1_body, r2_cent);
+        if (r2_cent.x == cent_loc.x && r2_cent.y == cent_loc.y) {
+            cent_ball_num = ball_get_num(list_get(balls, rand1));
+        }
+        body_set_centroid(r2_body, r1_cent);
+        if (r1_cent.x == cent_loc.x && r1_cent.y == cent_loc.y) {
+            cent_ball_num = ball_get_num(list_get(balls, rand2));
+        }
+    }
+    body_t *cent_body = ball_get_body(list_get(balls, cent_ball_num));
+    body_t *eight_ball = ball_get_body(list_get(balls, 8));
+    vector_t eight_ball_cent = body_get_centroid(eight_ball);
+    body_set_centroid(eight_ball, cent_loc);
+    body_set_centroid(cent_body, eight_ball_cent);
+
+    scene_add_ball_collisions(scene, balls);
+    scene_add_ball_list(scene, balls);
+
+}
+
+void scene_add_pockets(scene_t *scene) {
+    //adds bodies that the balls can collide with in the pockets
+    scene_add_wall(scene, TOP_LEFT_POCKET, POCKET_POINTS);
+    scene_add_wall(scene, TOP_POCKET, POCKET_POINTS);
+    scene_add_wall(scene, TOP_RIGHT_POCKET, POCKET_POINTS);
+    scene_add_wall(scene, BOTTOM_RIGHT_POCKET, POCKET_POINTS);
+    scene_add_wall(scene, BOTTOM_POCKET, POCKET_POINTS);
+    scene_add_wall(scene, BOTTOM_LEFT_POCKET, POCKET_POINTS);
+}
+
+void scene_add_cue(scene_t *scene, rgb_color_t col) {
+    ball_t *cb = (ball_t *)list_get(scene_get_balls(scene), 0);
+    body_t *cueball = ball_get_body(cb);
+    vector_t coords = vec_subtract(body_get_centroid(cueball), (vector_t){ball_get_radius(cb)*2 + .5*CUE_HEIGHT, 0});
+    list_t *shape = cue_generate_points((vector_t){CUE_HEIGHT, CUE_WIDTH});
+    rgb_color_t color = {0.0, 0.0, 0.0};
+    body_t *cue = body_init(shape, CUE_MASS, color);
+    body_set_render(cue, (render_component_t){DRAW_ROTATED_SPRITE, LAYER_DYNAMIC, SPRITE_CUE});
+    body_set_angle(cue, M_PI);
+    body_set_centroid(cue, coords);
+    scene_add_body(scene, cue);
+
+
+    size_t cue_index = scene_bodies(scene)-1;
+    body_t *cue_body = scene_get_body(scene, cue_index);
+    list_t *for_aux = list_init(1, NULL);
+    list_add(for_aux, cue_body);
+
+    create_physics_collision_with_removal(scene, CUE_ELASTICITY, cueball, cue_body, for_aux, 0.0);
+}
+
+void populate_table(scene_t *scene, bool shuffle) {
+    //add walls
+    scene_add_wall(scene, TOP_LEFT_WALL, WALL_POINTS);
+    scene_add_wall(scene, TOP_RIGHT_WALL, WALL_POINTS);
+    scene_add_wall(scene, BOTTOM_LEFT_WALL, WALL_POINTS);
+    scene_add_wall(scene, BOTTOM_RIGHT_WALL, WALL_POINTS);
+    scene_add_wall(scene, LEFT_WALL, WALL_POINTS);
+    scene_add_wall(scene, RIGHT_WALL, WALL_POINTS);
+
+    //ADD 6 boxes for the pockets, rotate the corner boxes
+    scene_add_pockets(scene);
+    //add player
+    player_t *player1 = player_init("solid", PLAYER_1_BALL_RACK, "Player1");
+    player_t *player2 = player_init("stripe", PLAYER_2_BALL_RACK, "Player2");
+    scene_add_player(scene, player1);
+    scene_add_player(scene, player2);
+    //add ball
+    scene_add_balls(scene, CUE_BALL_START, FIRST_BALL_COORDS, shuffle);
+
+}
+
+void populate_scene(scene_t *scene) {
+    populate_table(scene, true);
+}
+
+scene_t *table_scene_init(void) {
+    scene_t *scene = scene_init();
+    populate_table(scene, false);
+    return scene;
+}
+
+void save_body(body_t *body, body_state_t *state) {
+    state->position = body_get_centroid(body);
+    state->velocity = body_get_velocity(body);
+}
+
+void load_body(body_t *body, const body_state_t *state) {
+    body_set_centroid(body, state->position);
+    body_set_velocity(body, state->velocity);
+    body_reset_impulse(body);
+}
+
+void table_save(scene_t *scene, table_state_t *state) {
+    list_t *balls = scene_get_balls(scene);
+    state->state = scene_get_state(scene);
+    state->turn = scene_get_turn(scene);
+    for (size_t i = 0; i < TABLE_BALLS; i++) {
+        save_body(ball_get_body(list_get(balls, i)), &state->balls[i]);
+    }
+    body_t *cue = table_get_cue(scene);
+    state->has_cue = cue != NULL;
+    if (cue != NULL) {
+        save_body(cue, &state->cue);
+        state->cue_angle = body_get_angle(cue);
+    }
+    for (size_t p = 0; p < TABLE_PLAYERS; p++) {
+        player_t *player = scene_get_player(scene, p);
+        list_t *sunk = player_get_balls_sunk(player);
+        assert(list_size(sunk) <= TABLE_BALLS);
+        state->turn_states[p] = player_get_turn_state(player);
+        state->fouls[p] = player_foul(player);
+        state->num_sunk[p] = list_size(sunk);
+        for (size_t i = 0; i < list_size(sunk); i++) {
+            state->sunk[p][i] = ball_get_num(list_get(sunk, i));
+        }
+    }
+    // Without a cue there is no flag for it, so it is left cleared
+    memset(state->collision_flags, 0, sizeof(state->collision_flags));
+    size_t flags = scene_get_collision_flags(scene, state->collision_flags, TABLE_COLLISIONS);
+    assert(flags == TABLE_COLLISIONS - !state->has_cue);
+    size_t contacts = contact_solver_get_impulses(scene_get_contact_solver(scene),
+                                                  state->contact_impulses, TABLE_CONTACTS);
+    assert(contacts == TABLE_CONTACTS);
+}
+
+void table_load(scene_t *scene, const table_state_t *state) {
+    list_t *balls = scene_get_balls(scene);
+    scene_set_state(scene, state->state);
+    scene_set_turn(scene, state->turn);
+    for (size_t i = 0; i < TABLE_BALLS; i++) {
+        load_body(ball_get_body(list_get(balls, i)), &state->balls[i]);
+    }
+    for (size_t p = 0; p < TABLE_PLAYERS; p++) {
+        player_t *player = scene_get_player(scene, p);
+        list_t *sunk = player_get_balls_sunk(player);
+        player_set_turn_state(player, state->turn_states[p]);
+        player_set_foul(player, state->fouls[p]);
+        while (list_size(sunk) > 0) {
+            list_remove(sunk, list_size(sunk) - 1);
+        }
+        for (int i = 0; i < state->num_sunk[p]; i++) {
+            list_add(sunk, list_get(balls, state->sunk[p][i]));
+        }
+    }
+    // A fresh cue turned once, so its shape does not depend on how it was aimed before
+    body_t *cue = table_get_cue(scene);
+    if (cue != NULL) {
+        body_remove(cue);
+        scene_remove_marked(scene);
+    }
+    if (state->has_cue) {
+        scene_add_cue(scene, (rgb_color_t) {0,0,0});
+        cue = table_get_cue(scene);
+        body_set_rotation(cue, state->cue_angle);
+        load_body(cue, &state->cue);
+    }
+    scene_set_collision_flags(scene, state->collision_flags, TABLE_COLLISIONS);
+    contact_solver_set_impulses(scene_get_contact_solver(scene), state->contact_impulses, TABLE_CONTACTS);
+}
+
+bool balls_moving(list_t *balls) {
+    for (int i = 0; i < NUM_BALLS; i++) {
+        body_t *ball = ball_get_body(list_get(balls, i));
+        if (body_get_velocity(ball).x != 0.0 || body_get_velocity(ball).y != 0.0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void update_game_state(scene_t *scene) {
+    list_t *balls = scene_get_balls(scene);
+    // firing
+    if (scene_get_state(scene) == 2) {
+        bool moving = balls_moving(balls);
+        if (!moving && scene_bodies(scene) == 28) {
+            //printf("inside moving!\n");
+            scene_add_cue(scene, (rgb_color_t) {0,0,0});
+        }
+    }
+    // settling
+    else if (scene_get_state(scene) == 3) {
+        if (!balls_moving(balls) && scene_bodies(scene) == 28) {
+            player_t *curr_player = scene_get_player(scene, scene_get_turn(scene));
+            list_t *num_sunk = player_get_balls_sunk(curr_player);
+            // if foul (hit no balls or hit cue ball)
+            if (player_get_turn_state(curr_player) == 1) {
+                // Player loses turn and opponent is able to place cue
+                player_set_turn_state(curr_player, 0);
+                scene_switch_turn(scene);
+                scene_set_state(scene, 1);
+            }
+            // if ball not sunk or sunk other player's ball
+            else if (player_get_turn_state(curr_player) == 0) {
+                scene_switch_turn(scene);
+                scene_set_state(scene, 2);
+            }
+            //if ball sunk add cue back and set to firing mode
+            else if (player_get_turn_state(curr_player) == 2) {
+                scene_set_state(scene, 2);
+            }
+            //eight ball sunk
+            else if (player_get_turn_state(curr_player) == 3) {
+                if (list_size(num_sunk) == 8) {
+                    if (strcmp(player_get_name(curr_player), "Player1") == 0) {
+                        scene_set_state(scene, 4);
+                    }
+                    else {
+                        scene_set_state(scene, 5);
+                    }
+                }
+                else {
+                    if (strcmp(player_get_name(curr_player), "Player1") == 0) {
+                        scene_set_state(scene, 5);
+                    }
+                    else {
+                        scene_set_state(scene, 4);
+                    }
+                }
+            }
+        }
+
+    }
+}
+
+void park_player_balls(player_t *player, vector_t coords) {
+    list_t *sunk = player_get_balls_sunk(player);
+    for (size_t i = 0; i < list_size(sunk); i++) {
+        ball_t *ball = (ball_t *)list_get(sunk, i);
+        body_t *body = ball_get_body(ball);
+        double x_addition = i * (2.0 * ball_get_radius(ball) + BALL_RACK_SPACING);
+        body_set_velocity(body, (vector_t){0, 0});
+        body_reset_impulse(body);
+        body_set_centroid(body, vec_add(coords, vec_add(RACK_OFFSET, (vector_t){x_addition, 0})));
+    }
+}
+
+void table_park_sunk_balls(scene_t *scene) {
+    int state = scene_get_state(scene);
+    if (state == MENU || state == GAME_OVER_1 || state == GAME_OVER_2) {
+        return;
+    }
+    int turn = scene_get_turn(scene);
+    int players = list_size(scene_get_players(scene));
+    park_player_balls(scene_get_player(scene, turn), CURRENT_PLAYER_RACK);
+    park_player_balls(scene_get_player(scene, (turn + 1) % players), OTHER_PLAYER_RACK);
+}
+
+vector_t table_get_pocket(size_t pocket) {
+    assert(pocket < TABLE_POCKETS);
+    vector_t sum = {0, 0};
+    for (int i = 0; i < POCKET_POINTS; i++) {
+        sum = vec_add(sum, POCKETS[pocket][i]);
+    }
+    return vec_multiply(1.0 / POCKET_POINTS, sum);
+}
+
+// The cushions are the first bodies in the scene, and the pockets come next
+body_t *table_get_pocket_body(scene_t *scene, size_t pocket) {
+    assert(pocket < TABLE_POCKETS);
+    return scene_get_body(scene, TABLE_CUSHIONS + pocket);
+}
+
+body_t *table_get_cushion(scene_t *scene, size_t cushion) {
+    assert(cushion < TABLE_CUSHIONS);
+    return scene_get_body(scene, cushion);
+}
+
+bool table_place_cue_ball(scene_t *scene, vector_t position) {
+    ball_t *cueball = list_get(scene_get_balls(scene), 0);
+    double radius = ball_get_radius(cueball);
+    vector_t min = vec_add(KITCHEN[0], (vector_t){radius, radius});
+    vector_t max = vec_subtract(KITCHEN[1], (vector_t){0, radius});
+    if (scene_get_state(scene) != PLACING || !vec_within(position, min, max)) {
+        return false;
+    }
+    body_set_centroid(ball_get_body(cueball), position);
+    scene_set_state(scene, FIRING);
+    return true;
+}
+
+body_t *table_get_cue(scene_t *scene) {
+    if (scene_bodies(scene) != BALL_INDEX + NUM_BALLS + 1) {
+        return NULL;
+    }
+    return scene_get_body(scene, scene_bodies(scene) - 1);
+}
+
+void table_aim(scene_t *scene, double angle) {
+    body_t *cue = table_get_cue(scene);
+    assert(cue != NULL);
+    body_t *cueball = ball_get_body(list_get(scene_get_balls(scene), 0));
+    body_set_rotation_about_point(cue, angle, body_get_centroid(cueball));
+}
+
+// How far the cue's centroid is from the cue ball's when it is added, see scene_add_cue()
+double cue_distance(scene_t *scene) {
+    return ball_get_radius(list_get(scene_get_balls(scene), 0)) * 2 + .5 * CUE_HEIGHT;
+}
+
+double table_get_cue_pull_back(scene_t *scene) {
+    body_t *cue = table_get_cue(scene);
+    assert(cue != NULL);
+    body_t *cueball = ball_get_body(list_get(scene_get_balls(scene), 0));
+    double angle = body_get_angle(cue);
+    vector_t offset = vec_subtract(body_get_centroid(cue), body_get_centroid(cueball));
+    return vec_dot(offset, (vector_t) {cos(angle), sin(angle)}) - cue_distance(scene);
+}
+
+void table_set_cue(scene_t *scene, double angle, double pull_back) {
+    body_t *cue = table_get_cue(scene);
+    assert(cue != NULL);
+    body_remove(cue);
+    scene_remove_marked(scene);
+    scene_add_cue(scene, (rgb_color_t) {0,0,0});
+    table_aim(scene, angle);
+    // Moving by 0 leaves the cue exactly where table_aim() put it
+    body_translate(table_get_cue(scene), vec_multiply(pull_back, (vector_t) {cos(angle), sin(angle)}));
+}
+
+double table_get_shot_speed(scene_t *scene, double power) {
+    double ball_mass = body_get_mass(ball_get_body(list_get(scene_get_balls(scene), 0)));
+    // The cue hits the cue ball at rest and is removed, see scene_add_cue()
+    return (1 + CUE_ELASTICITY) * CUE_MASS / (CUE_MASS + ball_mass) * VEL_SCALAR * power;
+}
+
+void table_shoot(scene_t *scene, double power) {
+    body_t *cue = table_get_cue(scene);
+    assert(cue != NULL);
+    double angle = body_get_angle(cue);
+    double dx = -1 * VEL_SCALAR * power * (cos(angle));
+    double dy = -1 * VEL_SCALAR * power * (sin(angle));
+
+    body_set_velocity(cue, (vector_t){dx,dy});
+    scene_set_state(scene, SETTLING);
+}
+
+int table_play_shot(scene_t *scene, double angle, double power, double dt, int max_ticks) {
+    update_game_state(scene);
+    table_aim(scene, angle);
+    table_shoot(scene, power);
+    int ticks = 0;
+    while (scene_get_state(scene) == SETTLING && ticks < max_ticks) {
+        scene_tick(scene, dt);
+        update_game_state(scene);
+        table_park_sunk_balls(scene);
+        ticks++;
+    }
+    return ticks;
+}
+
+double table_ball_checksum(scene_t *scene) {
+    double sum = 0;
+    list_t *balls = scene_get_balls(scene);
+    for (size_t i = 0; i < list_size(balls); i++) {
+        vector_t position = body_get_centroid(ball_get_body(list_get(balls, i)));
+        sum += (i + 1) * (position.x + 1e3 * position.y);
+    }
+    return sum;
+}
@@ -19,14 +19,14 @@ bool vec_equal(vector_t v1, vector_t v2) {
 }
 
 bool vec_isclose(vector_t v1, vector_t v2) {
-    return vec_within(DEFAULT_EPSILON, v1, v2);
+    return vec_within_epsilon(DEFAULT_EPSILON, v1, v2);
 }
 
 bool within(double epsilon, double d1, double d2) {
     return fabs(d1 - d2) < epsilon;
 }
 
-bool vec_within(double epsilon, vector_t v1, vector_t v2) {
+bool vec_within_epsilon(double epsilon, vector_t v1, vector_t v2) {
     return within(epsilon, v1.x, v2.x) && within(epsilon, v1.y, v2.y);
 }
 
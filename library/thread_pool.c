@@ -0,0 +1,124 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "thread_pool.h"
+
+typedef struct worker {
+    struct thread_pool *pool;
+    size_t id;
+    pthread_t thread;
+} worker_t;
+
+typedef struct thread_pool {
+    worker_t *workers;
+    size_t size;
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    // the batch currently being run
+    task_func_t task;
+    void *aux;
+    size_t count;
+    size_t next;
+    // how many of the other workers are still in the current batch
+    size_t busy;
+    // incremented for every batch, so workers can tell a new one has started
+    unsigned long batch;
+    bool stopping;
+} thread_pool_t;
+
+// runs tasks until there are none left; called and returns with the lock held
+void run_tasks(thread_pool_t *pool, size_t worker) {
+    while (pool->next < pool->count) {
+        size_t index = pool->next++;
+        pthread_mutex_unlock(&pool->lock);
+        (pool->task)(pool->aux, index, worker);
+        pthread_mutex_lock(&pool->lock);
+    }
+}
+
+void *worker_main(void *arg) {
+    worker_t *worker = arg;
+    thread_pool_t *pool = worker->pool;
+    unsigned long seen = 0;
+    pthread_mutex_lock(&pool->lock);
+    while (true) {
+        while (pool->batch == seen && !pool->stopping) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        if (pool->stopping) {
+            break;
+        }
+        seen = pool->batch;
+        run_tasks(pool, worker->id);
+        pool->busy--;
+        if (pool->busy == 0) {
+            pthread_cond_signal(&pool->work_done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+thread_pool_t *thread_pool_init(size_t workers) {
+    assert(workers > 0);
+    thread_pool_t *pool = malloc(sizeof(thread_pool_t));
+    assert(pool != NULL);
+    pool->workers = malloc(workers * sizeof(worker_t));
+    assert(pool->workers != NULL);
+    pool->size = workers;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+    pool->task = NULL;
+    pool->aux = NULL;
+    pool->count = 0;
+    pool->next = 0;
+    pool->busy = 0;
+    pool->batch = 0;
+    pool->stopping = false;
+    // worker 0 is whichever thread calls thread_pool_run()
+    for (size_t i = 1; i < workers; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].id = i;
+        int err = pthread_create(&pool->workers[i].thread, NULL, worker_main, &pool->workers[i]);
+        assert(err == 0);
+    }
+    return pool;
+}
+
+size_t thread_pool_size(thread_pool_t *pool) {
+    return pool->size;
+}
+
+void thread_pool_run(thread_pool_t *pool, task_func_t task, void *aux, size_t count) {
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->aux = aux;
+    pool->count = count;
+    pool->next = 0;
+    pool->busy = pool->size - 1;
+    pool->batch++;
+    pthread_cond_broadcast(&pool->work_ready);
+    run_tasks(pool, 0);
+    while (pool->busy > 0) {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void thread_pool_free(thread_pool_t *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t i = 1; i < pool->size; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_cond_destroy(&pool->work_done);
+    free(pool->workers);
+    free(pool);
+}
@@ -0,0 +1,12 @@
+#include "timing.h"
+
+struct timespec timing_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now;
+}
+
+double seconds_since(struct timespec start) {
+    struct timespec now = timing_now();
+    return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+}
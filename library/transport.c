@@ -0,0 +1,201 @@
+#include <arpa/inet.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "transport.h"
+#include "rng.h"
+
+typedef struct transport {
+    transport_send_t sender;
+    transport_receive_t receiver;
+    void *aux;
+    free_func_t freer;
+} transport_t;
+
+transport_t *transport_init(
+    transport_send_t sender,
+    transport_receive_t receiver,
+    void *aux,
+    free_func_t freer
+) {
+    transport_t *transport = malloc(sizeof(transport_t));
+    assert(transport != NULL);
+    transport->sender = sender;
+    transport->receiver = receiver;
+    transport->aux = aux;
+    transport->freer = freer;
+    return transport;
+}
+
+void transport_free(transport_t *transport) {
+    if (transport->freer != NULL) {
+        transport->freer(transport->aux);
+    }
+    free(transport);
+}
+
+void transport_send(transport_t *transport, const uint8_t *data, size_t size) {
+    assert(size <= TRANSPORT_MAX_PACKET);
+    transport->sender(transport->aux, data, size);
+}
+
+size_t transport_receive(transport_t *transport, uint8_t *buffer, size_t capacity) {
+    assert(capacity >= TRANSPORT_MAX_PACKET);
+    return transport->receiver(transport->aux, buffer, capacity);
+}
+
+/**
+ * A connected UDP socket.
+ */
+typedef struct udp_socket {
+    int fd;
+} udp_socket_t;
+
+void udp_send(void *aux, const uint8_t *data, size_t size) {
+    udp_socket_t *udp = aux;
+    // A full buffer counts as a lost packet
+    send(udp->fd, data, size, 0);
+}
+
+size_t udp_receive(void *aux, uint8_t *buffer, size_t capacity) {
+    udp_socket_t *udp = aux;
+    ssize_t size = recv(udp->fd, buffer, capacity, 0);
+    return size > 0 ? size : 0;
+}
+
+void udp_free(void *aux) {
+    udp_socket_t *udp = aux;
+    close(udp->fd);
+    free(udp);
+}
+
+transport_t *transport_udp_init(uint16_t local_port, const char *host, uint16_t remote_port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct sockaddr_in local = {.sin_family = AF_INET, .sin_port = htons(local_port)};
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    struct sockaddr_in remote = {.sin_family = AF_INET, .sin_port = htons(remote_port)};
+    // Connecting the socket makes it ignore packets from anywhere else
+    if (inet_pton(AF_INET, host, &remote.sin_addr) != 1
+        || bind(fd, (struct sockaddr *)&local, sizeof(local)) != 0
+        || connect(fd, (struct sockaddr *)&remote, sizeof(remote)) != 0
+        || fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0) {
+        close(fd);
+        return NULL;
+    }
+    udp_socket_t *udp = malloc(sizeof(udp_socket_t));
+    assert(udp != NULL);
+    udp->fd = fd;
+    return transport_init(udp_send, udp_receive, udp, udp_free);
+}
+
+/**
+ * A packet on its way through a loopback.
+ */
+typedef struct packet {
+    uint32_t arrives;
+    size_t size;
+    uint8_t data[TRANSPORT_MAX_PACKET];
+} packet_t;
+
+/**
+ * One end of a loopback, and the packets on their way to it.
+ */
+typedef struct loopback_end {
+    loopback_t *loopback;
+    list_t *incoming;
+    struct loopback_end *other;
+} loopback_end_t;
+
+typedef struct loopback {
+    uint32_t latency;
+    double loss;
+    uint64_t rng;
+    uint32_t clock;
+    size_t sent;
+    size_t lost;
+    loopback_end_t ends[2];
+    transport_t *transports[2];
+} loopback_t;
+
+void loopback_send(void *aux, const uint8_t *data, size_t size) {
+    loopback_end_t *end = aux;
+    loopback_t *loopback = end->loopback;
+    loopback->sent++;
+    if (rng_unit(&loopback->rng) < loopback->loss) {
+        loopback->lost++;
+        return;
+    }
+    packet_t *packet = malloc(sizeof(packet_t));
+    assert(packet != NULL);
+    packet->arrives = loopback->clock + loopback->latency;
+    packet->size = size;
+    memcpy(packet->data, data, size);
+    list_add(end->other->incoming, packet);
+}
+
+size_t loopback_receive(void *aux, uint8_t *buffer, size_t capacity) {
+    loopback_end_t *end = aux;
+    // Every packet takes as long, so they arrive in the order they were sent
+    if (list_size(end->incoming) == 0) {
+        return 0;
+    }
+    packet_t *packet = list_get(end->incoming, 0);
+    if (packet->arrives > end->loopback->clock) {
+        return 0;
+    }
+    list_remove(end->incoming, 0);
+    size_t size = packet->size;
+    memcpy(buffer, packet->data, size);
+    free(packet);
+    return size;
+}
+
+loopback_t *loopback_init(uint32_t latency, double loss, uint64_t seed) {
+    assert(0 <= loss && loss <= 1);
+    loopback_t *loopback = malloc(sizeof(loopback_t));
+    assert(loopback != NULL);
+    loopback->latency = latency;
+    loopback->loss = loss;
+    // Packet loss never touches rand() and the game's random numbers
+    loopback->rng = rng_seed(seed);
+    loopback->clock = 0;
+    loopback->sent = 0;
+    loopback->lost = 0;
+    for (int i = 0; i < 2; i++) {
+        loopback->ends[i].loopback = loopback;
+        loopback->ends[i].incoming = list_init(8, (free_func_t)free);
+        loopback->ends[i].other = &loopback->ends[1 - i];
+        loopback->transports[i] = transport_init(loopback_send, loopback_receive,
+                                                 &loopback->ends[i], NULL);
+    }
+    return loopback;
+}
+
+void loopback_free(loopback_t *loopback) {
+    for (int i = 0; i < 2; i++) {
+        list_free(loopback->ends[i].incoming);
+        transport_free(loopback->transports[i]);
+    }
+    free(loopback);
+}
+
+transport_t *loopback_get_end(loopback_t *loopback, int end) {
+    assert(end == 0 || end == 1);
+    return loopback->transports[end];
+}
+
+void loopback_tick(loopback_t *loopback) {
+    loopback->clock++;
+}
+
+void loopback_get_counts(loopback_t *loopback, size_t *sent, size_t *lost) {
+    *sent = loopback->sent;
+    *lost = loopback->lost;
+}
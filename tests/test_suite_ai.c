@@ -0,0 +1,134 @@
+#include "ai.h"
+#include "player.h"
+#include "table.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdlib.h>
+
+const unsigned int RACK_SEED = 5;
+const double DT = 1.0 / 60.0;
+// Two rounds of screening, so the second round refines the first
+const size_t SEARCH_SHOTS = 128;
+const size_t THREAD_COUNTS[] = {1, 3};
+#define NUM_THREAD_COUNTS (sizeof(THREAD_COUNTS) / sizeof(*THREAD_COUNTS))
+// How many moves each search is checked on
+#define MOVES 2
+const int MAX_MOVE_TICKS = 60 * 60;
+// Solids, as the ai keeps them: balls 1 to 7
+const uint16_t SOLID_BALLS = 0xfe & ~(1 << 8);
+const uint16_t STRIPE_BALLS = 0xfe00;
+
+scene_t *computer_rack(void) {
+    srand(RACK_SEED);
+    scene_t *scene = scene_init();
+    populate_scene(scene);
+    for (int p = 0; p < TABLE_PLAYERS; p++) {
+        player_set_computer(scene_get_player(scene, p), true);
+    }
+    return scene;
+}
+
+// Plays a few moves of a game with an opponent, recording the shots it chose
+void play_moves(ai_t *ai, shot_t shots[MOVES]) {
+    scene_t *scene = computer_rack();
+    for (size_t move = 0; move < MOVES; move++) {
+        int ticks = 0;
+        while (!ai_has_turn(scene) && ticks < MAX_MOVE_TICKS) {
+            scene_tick(scene, DT);
+            update_game_state(scene);
+            table_park_sunk_balls(scene);
+            ticks++;
+        }
+        assert(ai_has_turn(scene));
+        shots[move] = ai_choose_shot(ai, scene);
+        assert(ai_get_stats(ai).screened == SEARCH_SHOTS);
+        ai_play_shot(scene, shots[move]);
+    }
+    scene_free(scene);
+}
+
+// Tests that without a time limit, the shots chosen do not depend on the number of threads
+void test_choose_shot_deterministic() {
+    shot_t expected[MOVES];
+    for (size_t t = 0; t < NUM_THREAD_COUNTS; t++) {
+        ai_t *ai = ai_init(THREAD_COUNTS[t], DT, SEARCH_SHOTS, 0);
+        shot_t shots[MOVES];
+        play_moves(ai, shots);
+        // Searching again with the same opponent gives the same shots too
+        shot_t again[MOVES];
+        play_moves(ai, again);
+        ai_free(ai);
+        for (size_t move = 0; move < MOVES; move++) {
+            if (t == 0) {
+                expected[move] = shots[move];
+            }
+            assert(shots[move].angle == expected[move].angle);
+            assert(shots[move].power == expected[move].power);
+            assert(vec_equal(shots[move].cue_ball, expected[move].cue_ball));
+            assert(again[move].angle == expected[move].angle);
+            assert(again[move].power == expected[move].power);
+            assert(vec_equal(again[move].cue_ball, expected[move].cue_ball));
+        }
+    }
+}
+
+shot_outcome_t make_outcome(uint16_t sunk, bool scratch, bool foul, int state, int turn) {
+    return (shot_outcome_t) {
+        .sunk = sunk, .scratch = scratch, .foul = foul, .state = state, .turn = turn
+    };
+}
+
+// Tests that a legal pot is preferred to a miss, which is preferred to a scratch or a foul,
+// and that the 8 ball only helps once the shooter's other balls are down
+void test_score_outcome() {
+    turn_t turn = {.shooter = 0, .own = SOLID_BALLS, .own_before = 2};
+    shot_outcome_t pot = make_outcome(1 << 3, false, false, FIRING, 0);
+    shot_outcome_t two_pots = make_outcome(1 << 3 | 1 << 5, false, false, FIRING, 0);
+    shot_outcome_t miss = make_outcome(0, false, false, FIRING, 1);
+    shot_outcome_t scratch = make_outcome(1 << 3, true, false, PLACING, 1);
+    shot_outcome_t foul = make_outcome(1 << 12, false, true, FIRING, 1);
+    shot_outcome_t early_eight = make_outcome(1 << 8, false, false, FIRING, 1);
+    shot_outcome_t lost = make_outcome(1 << 8, false, false, GAME_OVER_2, 1);
+
+    assert(score_outcome(&pot, &turn) > 0);
+    assert(score_outcome(&two_pots, &turn) > score_outcome(&pot, &turn));
+    assert(score_outcome(&pot, &turn) > score_outcome(&miss, &turn));
+    assert(score_outcome(&miss, &turn) > score_outcome(&scratch, &turn));
+    assert(score_outcome(&miss, &turn) > score_outcome(&foul, &turn));
+    assert(score_outcome(&scratch, &turn) < 0);
+    assert(score_outcome(&foul, &turn) < 0);
+
+    // Sinking the 8 ball early loses, which is worse than any scratch or foul
+    assert(score_outcome(&early_eight, &turn) < score_outcome(&scratch, &turn));
+    assert(score_outcome(&early_eight, &turn) < score_outcome(&foul, &turn));
+    assert(score_outcome(&early_eight, &turn) == score_outcome(&lost, &turn));
+    // A game the shooter won scores above any pot
+    shot_outcome_t won = make_outcome(1 << 8, false, false, GAME_OVER_1, 0);
+    assert(score_outcome(&won, &turn) > score_outcome(&two_pots, &turn));
+    // Once the other 7 are down, the 8 ball wins
+    turn_t last_ball = {.shooter = 0, .own = SOLID_BALLS, .own_before = 7};
+    assert(score_outcome(&early_eight, &last_ball) == score_outcome(&won, &turn));
+
+    // The same for the other player, who shoots at the stripes
+    turn_t stripes = {.shooter = 1, .own = STRIPE_BALLS, .own_before = 0};
+    shot_outcome_t stripe_pot = make_outcome(1 << 12, false, false, FIRING, 1);
+    shot_outcome_t solid_foul = make_outcome(1 << 3, false, true, FIRING, 0);
+    assert(score_outcome(&stripe_pot, &stripes) > 0);
+    assert(score_outcome(&solid_foul, &stripes) < 0);
+    assert(score_outcome(&lost, &stripes) > score_outcome(&stripe_pot, &stripes));
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_choose_shot_deterministic)
+    DO_TEST(test_score_outcome)
+
+    puts("ai_test PASS");
+}
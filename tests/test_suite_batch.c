@@ -0,0 +1,153 @@
+#include "batch.h"
+#include "ball.h"
+#include "scene.h"
+#include "table.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const unsigned int RACK_SEED = 11;
+const double DT = 1.0 / 60.0;
+const int MAX_TICKS = 60 * 120;
+#define SHOTS 12
+const size_t THREADS = 4;
+const int TICKS_BEFORE_SAVE = 90;
+const int TICKS_AFTER_SAVE = 3000;
+
+// A freshly shuffled rack with the cue ball where it starts
+scene_t *rack(void) {
+    srand(RACK_SEED);
+    scene_t *scene = scene_init();
+    populate_scene(scene);
+    return scene;
+}
+
+// Shots around the break, from soft to hard, some of which pot a ball or scratch
+void make_shots(shot_t shots[SHOTS]) {
+    for (size_t i = 0; i < SHOTS; i++) {
+        shots[i].angle = M_PI + (i % 6 - 2.5) * 0.1;
+        shots[i].power = 1.0 + 0.4 * i;
+        shots[i].cue_ball = CUE_BALL_START;
+    }
+}
+
+void assert_same_outcome(const shot_outcome_t *o1, const shot_outcome_t *o2) {
+    assert(o1->sunk == o2->sunk);
+    assert(o1->scratch == o2->scratch);
+    assert(o1->foul == o2->foul);
+    assert(o1->state == o2->state);
+    assert(o1->turn == o2->turn);
+    assert(o1->ticks == o2->ticks);
+    for (size_t i = 0; i < TABLE_BALLS; i++) {
+        assert(vec_equal(o1->positions[i], o2->positions[i]));
+    }
+}
+
+void assert_same_balls(scene_t *scene1, scene_t *scene2) {
+    list_t *balls1 = scene_get_balls(scene1);
+    list_t *balls2 = scene_get_balls(scene2);
+    for (size_t i = 0; i < TABLE_BALLS; i++) {
+        body_t *ball1 = ball_get_body(list_get(balls1, i));
+        body_t *ball2 = ball_get_body(list_get(balls2, i));
+        assert(vec_equal(body_get_centroid(ball1), body_get_centroid(ball2)));
+        assert(vec_equal(body_get_velocity(ball1), body_get_velocity(ball2)));
+    }
+}
+
+void test_threads_match_serial() {
+    scene_t *scene = rack();
+    table_state_t *table = malloc(sizeof(table_state_t));
+    assert(table != NULL);
+    table_save(scene, table);
+    scene_free(scene);
+    shot_t shots[SHOTS];
+    make_shots(shots);
+
+    shot_outcome_t *serial = malloc(SHOTS * sizeof(shot_outcome_t));
+    shot_outcome_t *parallel = malloc(SHOTS * sizeof(shot_outcome_t));
+    assert(serial != NULL && parallel != NULL);
+    batch_t *batch = batch_init(1);
+    batch_run(batch, table, shots, serial, SHOTS, DT, MAX_TICKS);
+    batch_free(batch);
+    batch = batch_init(THREADS);
+    batch_run(batch, table, shots, parallel, SHOTS, DT, MAX_TICKS);
+    // Running the batch again on the same tables gives the same outcomes
+    batch_run(batch, table, shots, parallel, SHOTS, DT, MAX_TICKS);
+    batch_free(batch);
+
+    bool any_sunk = false;
+    for (size_t i = 0; i < SHOTS; i++) {
+        assert_same_outcome(&serial[i], &parallel[i]);
+        assert(serial[i].state != SETTLING);
+        any_sunk |= serial[i].sunk != 0;
+
+        // The same shot played on the table it was racked on, not a loaded copy
+        scene = rack();
+        assert(table_place_cue_ball(scene, shots[i].cue_ball));
+        int ticks = table_play_shot(scene, shots[i].angle, shots[i].power, DT, MAX_TICKS);
+        assert(ticks == serial[i].ticks);
+        assert(scene_get_state(scene) == serial[i].state);
+        assert(scene_get_turn(scene) == serial[i].turn);
+        list_t *balls = scene_get_balls(scene);
+        for (size_t b = 0; b < TABLE_BALLS; b++) {
+            vector_t position = body_get_centroid(ball_get_body(list_get(balls, b)));
+            assert(vec_equal(position, serial[i].positions[b]));
+        }
+        scene_free(scene);
+    }
+    assert(any_sunk);
+    free(serial);
+    free(parallel);
+    free(table);
+}
+
+void test_load_ticks_identically() {
+    scene_t *scene = rack();
+    assert(table_place_cue_ball(scene, CUE_BALL_START));
+    update_game_state(scene);
+    table_aim(scene, M_PI);
+    table_shoot(scene, 2.5);
+    for (int i = 0; i < TICKS_BEFORE_SAVE; i++) {
+        scene_tick(scene, DT);
+        update_game_state(scene);
+        table_park_sunk_balls(scene);
+    }
+    table_state_t *table = malloc(sizeof(table_state_t));
+    assert(table != NULL);
+    table_save(scene, table);
+
+    // Mid-shot, with balls already touching the cushions and each other
+    scene_t *copy = table_scene_init();
+    table_load(copy, table);
+    assert_same_balls(scene, copy);
+    for (int i = 0; i < TICKS_AFTER_SAVE; i++) {
+        scene_tick(scene, DT);
+        update_game_state(scene);
+        table_park_sunk_balls(scene);
+        scene_tick(copy, DT);
+        update_game_state(copy);
+        table_park_sunk_balls(copy);
+        assert(scene_get_state(copy) == scene_get_state(scene));
+        assert(scene_get_turn(copy) == scene_get_turn(scene));
+        assert_same_balls(scene, copy);
+    }
+    scene_free(scene);
+    scene_free(copy);
+    free(table);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_threads_match_serial)
+    DO_TEST(test_load_ticks_identically)
+
+    puts("batch_test PASS");
+}
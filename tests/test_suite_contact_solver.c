@@ -0,0 +1,159 @@
+#include "ball.h"
+#include "contact_solver.h"
+#include "scene.h"
+#include "test_util.h"
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+
+// The scenes use semi-implicit Euler, since the default integrator
+// stops slow bodies itself, which would hide whether the solver settled them.
+const double DT = 1.0 / 120;
+const double RADIUS = 10;
+const double MASS = 2;
+// Small enough that one tick of falling (0.5 px/s) stays under the solver's
+// 1 px/s bounce threshold, so resting balls do not bounce
+const double FALL_ACCELERATION = 60;
+
+body_t *make_ball_body(vector_t center, double mass) {
+    body_t *body = body_init(make_ball_shape(RADIUS), mass, (rgb_color_t) {0, 0, 0});
+    body_set_centroid(body, center);
+    return body;
+}
+
+scene_t *make_solver_scene(contact_solver_t *solver) {
+    scene_t *scene = scene_init();
+    scene_set_integrator(scene, INTEGRATOR_SEMI_IMPLICIT_EULER);
+    scene_set_contact_solver(scene, solver);
+    return scene;
+}
+
+// Pulls every body with finite mass down
+void fall(void *aux) {
+    scene_t *scene = aux;
+    for (size_t i = 0; i < scene_bodies(scene); i++) {
+        body_t *body = scene_get_body(scene, i);
+        if (body_get_mass(body) != DBL_MAX) {
+            body_add_force(body, (vector_t) {0, -FALL_ACCELERATION * body_get_mass(body)});
+        }
+    }
+}
+
+// Tests that a stack of balls on a fixed ball comes to rest without sinking into it
+void test_resting_stack() {
+    const size_t HEIGHT = 4;
+    const double SLOP = 0.1;
+    contact_solver_t *solver = contact_solver_init(8, 0.2, SLOP);
+    scene_t *scene = make_solver_scene(solver);
+    for (size_t i = 0; i < HEIGHT; i++) {
+        scene_add_body(scene, make_ball_body((vector_t) {0, 2 * RADIUS * i}, i == 0 ? DBL_MAX : MASS));
+    }
+    for (size_t i = 0; i + 1 < HEIGHT; i++) {
+        contact_solver_add_pair(solver, 0.5, scene_get_body(scene, i), scene_get_body(scene, i + 1));
+    }
+    scene_add_force_creator(scene, fall, scene, NULL);
+    for (int step = 0; step < 600; step++) {
+        scene_tick(scene, DT);
+    }
+    for (size_t i = 1; i < HEIGHT; i++) {
+        body_t *body = scene_get_body(scene, i);
+        assert(vec_magnitude(body_get_velocity(body)) < 1e-6);
+        // Each contact may overlap by at most about the slop
+        double height = body_get_centroid(body).y;
+        assert(height > 2 * RADIUS * i - 2 * SLOP * i);
+        assert(height <= 2 * RADIUS * i + 1e-9);
+        assert(fabs(body_get_centroid(body).x) < 1e-9);
+    }
+    scene_free(scene);
+}
+
+// Runs two equal balls into each other head on and returns their velocities afterwards
+void collide(double elasticity, vector_t *v1, vector_t *v2) {
+    const double SPEED = 100;
+    // Each tick the balls close by 2 * SPEED * DT; the slop is larger than that,
+    // so the contact is found with less overlap than the slop and is not pushed apart
+    contact_solver_t *solver = contact_solver_init(8, 0.2, 2);
+    scene_t *scene = make_solver_scene(solver);
+    body_t *body1 = make_ball_body((vector_t) {-50, 0}, MASS);
+    body_t *body2 = make_ball_body((vector_t) {50, 0}, MASS);
+    body_set_velocity(body1, (vector_t) {SPEED, 0});
+    body_set_velocity(body2, (vector_t) {-SPEED, 0});
+    scene_add_body(scene, body1);
+    scene_add_body(scene, body2);
+    contact_solver_add_pair(solver, elasticity, body1, body2);
+    for (int step = 0; step < 60; step++) {
+        scene_tick(scene, DT);
+    }
+    *v1 = body_get_velocity(body1);
+    *v2 = body_get_velocity(body2);
+    scene_free(scene);
+}
+
+// Tests that the balls separate at the elasticity times the speed they met at,
+// conserving momentum
+void test_restitution() {
+    const double ELASTICITIES[] = {1, 0.5, 0};
+    for (size_t i = 0; i < sizeof(ELASTICITIES) / sizeof(ELASTICITIES[0]); i++) {
+        vector_t v1, v2;
+        collide(ELASTICITIES[i], &v1, &v2);
+        assert(vec_within_epsilon(1e-9, vec_add(v1, v2), VEC_ZERO));
+        assert(within(1e-9, v2.x - v1.x, 200 * ELASTICITIES[i]));
+        assert(within(1e-9, v1.y, 0));
+    }
+}
+
+// Tests that a ball hitting a fixed ball bounces back and the fixed ball stays put
+void test_fixed_body() {
+    contact_solver_t *solver = contact_solver_init(8, 0.2, 2);
+    scene_t *scene = make_solver_scene(solver);
+    body_t *wall = make_ball_body(VEC_ZERO, DBL_MAX);
+    body_t *ball = make_ball_body((vector_t) {-50, 0}, MASS);
+    body_set_velocity(ball, (vector_t) {100, 0});
+    scene_add_body(scene, wall);
+    scene_add_body(scene, ball);
+    contact_solver_add_pair(solver, 1, wall, ball);
+    for (int step = 0; step < 60; step++) {
+        scene_tick(scene, DT);
+    }
+    assert(vec_within_epsilon(1e-9, body_get_velocity(ball), (vector_t) {-100, 0}));
+    assert(vec_equal(body_get_centroid(wall), VEC_ZERO));
+    assert(vec_equal(body_get_velocity(wall), VEC_ZERO));
+    scene_free(scene);
+}
+
+// Tests that balls approaching too slowly to bounce just stop against each other
+void test_no_bounce_below_threshold() {
+    contact_solver_t *solver = contact_solver_init(8, 0.2, 2);
+    scene_t *scene = make_solver_scene(solver);
+    body_t *body1 = make_ball_body((vector_t) {-RADIUS - 0.05, 0}, MASS);
+    body_t *body2 = make_ball_body((vector_t) {RADIUS + 0.05, 0}, MASS);
+    body_set_velocity(body1, (vector_t) {0.4, 0});
+    body_set_velocity(body2, (vector_t) {-0.4, 0});
+    scene_add_body(scene, body1);
+    scene_add_body(scene, body2);
+    contact_solver_add_pair(solver, 1, body1, body2);
+    for (int step = 0; step < 60; step++) {
+        scene_tick(scene, DT);
+    }
+    assert(vec_within_epsilon(1e-9, body_get_velocity(body1), VEC_ZERO));
+    assert(vec_within_epsilon(1e-9, body_get_velocity(body2), VEC_ZERO));
+    scene_free(scene);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_resting_stack)
+    DO_TEST(test_restitution)
+    DO_TEST(test_fixed_body)
+    DO_TEST(test_no_bounce_below_threshold)
+
+    puts("contact_solver_test PASS");
+}
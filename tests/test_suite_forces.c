@@ -29,6 +29,8 @@ void test_spring_sinusoid() {
     const double DT = 1e-6;
     const int STEPS = 1000000;
     scene_t *scene = scene_init();
+    // Second order, like the trapezoid integrator this was written for, but without its rest cutoff
+    scene_set_integrator(scene, INTEGRATOR_VELOCITY_VERLET);
     body_t *mass = body_init(make_shape(), M, (rgb_color_t) {0, 0, 0});
     body_set_centroid(mass, (vector_t) {A, 0});
     scene_add_body(scene, mass);
@@ -62,6 +64,7 @@ void test_energy_conservation() {
     const double DT = 1e-6;
     const int STEPS = 1000000;
     scene_t *scene = scene_init();
+    scene_set_integrator(scene, INTEGRATOR_SEMI_IMPLICIT_EULER);
     body_t *mass1 = body_init(make_shape(), M1, (rgb_color_t) {0, 0, 0});
     scene_add_body(scene, mass1);
     body_t *mass2 = body_init(make_shape(), M2, (rgb_color_t) {0, 0, 0});
@@ -101,6 +104,7 @@ void test_collisions() {
     const int TICKS_TO_COLLISION = 10;
 
     scene_t *scene = scene_init();
+    scene_set_integrator(scene, INTEGRATOR_SEMI_IMPLICIT_EULER);
     body_t *body1 = make_triangle_body();
     vector_t initial_separation =
         {SEPARATION_AT_COLLISION + V * DT * (TICKS_TO_COLLISION - 0.5), 0};
@@ -136,6 +140,7 @@ void test_collisions() {
 // If they don't, asan will report a heap-use-after-free failure.
 void test_forces_removed() {
     scene_t *scene = scene_init();
+    scene_set_integrator(scene, INTEGRATOR_SEMI_IMPLICIT_EULER);
     for (int i = 0; i < 10; i++) {
         body_t *body = body_init(make_shape(), 1, (rgb_color_t) {0, 0, 0});
         body_set_centroid(body, (vector_t) {i, i});
@@ -153,6 +158,107 @@ void test_forces_removed() {
     scene_free(scene);
 }
 
+// A scene with a row of unit-mass bodies moving at different velocities
+scene_t *make_moving_bodies(size_t count) {
+    scene_t *scene = scene_init();
+    scene_set_integrator(scene, INTEGRATOR_SEMI_IMPLICIT_EULER);
+    for (size_t i = 0; i < count; i++) {
+        body_t *body = body_init(make_shape(), 1 + i % 3, (rgb_color_t) {0, 0, 0});
+        body_set_centroid(body, (vector_t) {10 * i, 0});
+        body_set_velocity(body, (vector_t) {40 + 7.5 * i, 25 - 3.0 * i});
+        scene_add_body(scene, body);
+    }
+    return scene;
+}
+
+// Tests that create_group_friction() and create_group_drag() slow bodies
+// exactly as create_ideal_friction() and create_drag() on each body do
+void test_group_friction_and_drag() {
+    const size_t COUNT = 12;
+    const double MUG = 0.8;
+    const double GAMMA = 0.3;
+    const double DT = 1e-2;
+    const int STEPS = 200;
+    scene_t *single = make_moving_bodies(COUNT);
+    scene_t *group = make_moving_bodies(COUNT);
+    list_t *friction_bodies = list_init(COUNT, NULL);
+    list_t *drag_bodies = list_init(COUNT, NULL);
+    for (size_t i = 0; i < COUNT; i++) {
+        create_ideal_friction(single, MUG, scene_get_body(single, i));
+        create_drag(single, GAMMA, scene_get_body(single, i));
+        list_add(friction_bodies, scene_get_body(group, i));
+        list_add(drag_bodies, scene_get_body(group, i));
+    }
+    create_group_friction(group, MUG, friction_bodies);
+    create_group_drag(group, GAMMA, drag_bodies);
+    for (int step = 0; step < STEPS; step++) {
+        scene_tick(single, DT);
+        scene_tick(group, DT);
+        for (size_t i = 0; i < COUNT; i++) {
+            assert(vec_equal(
+                body_get_velocity(scene_get_body(group, i)),
+                body_get_velocity(scene_get_body(single, i))
+            ));
+        }
+    }
+    // The bodies did slow down
+    vector_t last = body_get_velocity(scene_get_body(group, COUNT - 1));
+    assert(fabs(last.x) < 40 + 7.5 * (COUNT - 1));
+    scene_free(single);
+    scene_free(group);
+}
+
+// A scene with bodies at rest at pseudo-random positions, with masses from 1 to 10
+scene_t *make_scattered_bodies(size_t count) {
+    scene_t *scene = scene_init();
+    scene_set_integrator(scene, INTEGRATOR_SEMI_IMPLICIT_EULER);
+    unsigned int seed = 1;
+    for (size_t i = 0; i < count; i++) {
+        seed = seed * 1103515245 + 12345;
+        double x = seed % 100000 / 100.0;
+        seed = seed * 1103515245 + 12345;
+        double y = seed % 100000 / 100.0;
+        body_t *body = body_init(make_shape(), 1 + i % 10, (rgb_color_t) {0, 0, 0});
+        body_set_centroid(body, (vector_t) {x, y});
+        scene_add_body(scene, body);
+    }
+    return scene;
+}
+
+// Tests that create_group_gravity() pulls each body like create_newtonian_gravity()
+// on every pair does, including when the bodies do not fill the last tile
+void test_group_gravity_matches_pairs() {
+    const size_t COUNTS[] = {2, 37, 512, 513, 700};
+    const double G = 50;
+    const double DT = 1;
+    for (size_t c = 0; c < sizeof(COUNTS) / sizeof(*COUNTS); c++) {
+        size_t count = COUNTS[c];
+        scene_t *pairs = make_scattered_bodies(count);
+        scene_t *group = make_scattered_bodies(count);
+        list_t *bodies = list_init(count, NULL);
+        for (size_t i = 0; i < count; i++) {
+            list_add(bodies, scene_get_body(group, i));
+            for (size_t j = i + 1; j < count; j++) {
+                create_newtonian_gravity(pairs, G, scene_get_body(pairs, i), scene_get_body(pairs, j));
+            }
+        }
+        create_group_gravity(group, G, bodies);
+        // Starting at rest, one tick leaves each body moving at its acceleration
+        scene_tick(pairs, DT);
+        scene_tick(group, DT);
+        for (size_t i = 0; i < count; i++) {
+            vector_t expected = body_get_velocity(scene_get_body(pairs, i));
+            vector_t actual = body_get_velocity(scene_get_body(group, i));
+            assert(vec_magnitude(expected) > 0);
+            // The sums are taken in a different order, so they only agree to rounding
+            double tolerance = 1e-9 * vec_magnitude(expected);
+            assert(vec_within_epsilon(tolerance, actual, expected));
+        }
+        scene_free(pairs);
+        scene_free(group);
+    }
+}
+
 int main(int argc, char *argv[]) {
     // Run all tests if there are no command-line arguments
     bool all_tests = argc == 1;
@@ -166,6 +272,8 @@ int main(int argc, char *argv[]) {
     DO_TEST(test_energy_conservation)
     DO_TEST(test_collisions)
     DO_TEST(test_forces_removed)
+    DO_TEST(test_group_friction_and_drag)
+    DO_TEST(test_group_gravity_matches_pairs)
 
     puts("forces_test PASS");
 }
@@ -0,0 +1,225 @@
+#include "ball.h"
+#include "controls.h"
+#include "input_log.h"
+#include "rng.h"
+#include "table.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+const unsigned int RACK_SEED = 7;
+const double DT = 1.0 / 60;
+const char *const LOG_PATH = "out/test_suite_input_log.log";
+// Somewhere on the menu's two player button
+const vector_t TWO_PLAYER_BUTTON = {800, 300};
+// How many ticks space is held to wind up a shot
+const int WIND_UP_TICKS = 6;
+const size_t SHOTS = 12;
+// Ticks left for the balls to settle after the last shot
+const uint32_t SETTLE_TICKS = 60 * 20;
+
+/**
+ * A game played with the mouse and keyboard, and how the balls ended up.
+ */
+typedef struct {
+    input_log_t *log;
+    double checksum;
+} recorded_game_t;
+
+// Racked the same way as pool and replay
+scene_t *rack(unsigned int seed) {
+    srand(seed);
+    scene_t *scene = scene_init();
+    scene_set_state(scene, MENU);
+    populate_scene(scene);
+    return scene;
+}
+
+void apply_event(scene_t *scene, input_event_t event) {
+    if (event.device == INPUT_KEY) {
+        controls_on_key(event.key, event.type, event.held_time, scene);
+    }
+    else {
+        controls_on_mouse(event.type, scene, event.held_time, event.position);
+    }
+}
+
+void tick(scene_t *scene) {
+    scene_tick(scene, DT);
+    update_game_state(scene);
+    table_park_sunk_balls(scene);
+}
+
+// Handles an event and records it, stamped with the current tick
+void handle(scene_t *scene, input_log_t *log, uint32_t ticks, input_event_t event) {
+    event.tick = ticks;
+    apply_event(scene, event);
+    input_log_add(log, event);
+}
+
+/**
+ * Plays a two player game of random shots from the menu, recording every event.
+ * Mouse positions are whole pixels and shots are held for whole milliseconds,
+ * as they are from a window.
+ */
+recorded_game_t record_game(unsigned int seed) {
+    scene_t *scene = rack(seed);
+    input_log_t *log = input_log_init(seed, DT);
+    uint64_t rng = rng_seed(seed);
+    uint32_t ticks = 0;
+    size_t shots = 0;
+    int wind_up = 0;
+    while (shots < SHOTS) {
+        int state = scene_get_state(scene);
+        if (state == GAME_OVER_1 || state == GAME_OVER_2) {
+            break;
+        }
+        if (state == MENU) {
+            handle(scene, log, ticks, (input_event_t) {
+                .device = INPUT_MOUSE, .type = MOUSE_PRESSED, .position = TWO_PLAYER_BUTTON
+            });
+        }
+        else if (state == PLACING) {
+            handle(scene, log, ticks, (input_event_t) {
+                .device = INPUT_MOUSE, .type = MOUSE_MOVED, .position = CUE_BALL_START
+            });
+            handle(scene, log, ticks, (input_event_t) {
+                .device = INPUT_MOUSE, .type = MOUSE_RELEASED, .held_time = 0.125,
+                .position = CUE_BALL_START
+            });
+        }
+        else if (state == FIRING && table_get_cue(scene) != NULL && wind_up < WIND_UP_TICKS) {
+            vector_t mouse = {(int)rng_between(&rng, 100, 900), (int)rng_between(&rng, 100, 400)};
+            handle(scene, log, ticks, (input_event_t) {
+                .device = INPUT_MOUSE, .type = MOUSE_MOVED, .position = mouse
+            });
+            handle(scene, log, ticks, (input_event_t) {
+                .device = INPUT_KEY, .type = KEY_PRESSED, .key = SPACE, .held_time = wind_up * DT
+            });
+            wind_up++;
+        }
+        else if (state == FIRING && table_get_cue(scene) != NULL) {
+            handle(scene, log, ticks, (input_event_t) {
+                .device = INPUT_KEY, .type = KEY_RELEASED, .key = SPACE,
+                .held_time = (int)rng_between(&rng, 500, 2000) / 1000.0
+            });
+            assert(scene_get_state(scene) == SETTLING);
+            wind_up = 0;
+            shots++;
+        }
+        tick(scene);
+        ticks++;
+    }
+    for (uint32_t i = 0; i < SETTLE_TICKS; i++) {
+        tick(scene);
+        ticks++;
+    }
+    input_log_set_ticks(log, ticks);
+    recorded_game_t game = {log, table_ball_checksum(scene)};
+    scene_free(scene);
+    return game;
+}
+
+// Plays a recording again the way replay does, handling each event before its tick
+scene_t *replay(input_log_t *log) {
+    scene_t *scene = rack(input_log_get_seed(log));
+    size_t next_event = 0;
+    for (uint32_t ticks = 0; ticks < input_log_get_ticks(log); ticks++) {
+        while (next_event < input_log_size(log) && input_log_get(log, next_event).tick == ticks) {
+            apply_event(scene, input_log_get(log, next_event++));
+        }
+        tick(scene);
+    }
+    assert(next_event == input_log_size(log));
+    return scene;
+}
+
+// Tests that a saved recording loads back event for event
+void test_save_load() {
+    recorded_game_t game = record_game(RACK_SEED);
+    assert(input_log_save(game.log, LOG_PATH));
+    input_log_t *loaded = input_log_load(LOG_PATH);
+    assert(loaded != NULL);
+    assert(input_log_get_seed(loaded) == RACK_SEED);
+    assert(input_log_get_dt(loaded) == DT);
+    assert(input_log_get_ticks(loaded) == input_log_get_ticks(game.log));
+    assert(input_log_size(loaded) == input_log_size(game.log));
+    for (size_t i = 0; i < input_log_size(loaded); i++) {
+        input_event_t expected = input_log_get(game.log, i);
+        input_event_t actual = input_log_get(loaded, i);
+        assert(actual.tick == expected.tick);
+        assert(actual.device == expected.device);
+        assert(actual.type == expected.type);
+        if (expected.device == INPUT_KEY) {
+            assert(actual.key == expected.key);
+        }
+        else {
+            assert(vec_equal(actual.position, expected.position));
+        }
+        if (expected.device == INPUT_KEY || expected.type != MOUSE_MOVED) {
+            assert(actual.held_time == expected.held_time);
+        }
+    }
+    input_log_free(loaded);
+
+    // A recording cut short is not read at all
+    FILE *file = fopen(LOG_PATH, "r+b");
+    assert(file != NULL);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    assert(truncate(LOG_PATH, size - 1) == 0);
+    assert(input_log_load(LOG_PATH) == NULL);
+
+    remove(LOG_PATH);
+    input_log_free(game.log);
+}
+
+// Tests that a loaded recording replays to where the game ended, every time
+void test_replay_deterministic() {
+    recorded_game_t game = record_game(RACK_SEED);
+    assert(input_log_save(game.log, LOG_PATH));
+    input_log_t *loaded = input_log_load(LOG_PATH);
+    assert(loaded != NULL);
+
+    // The shots moved the balls from where they were racked
+    scene_t *racked = rack(RACK_SEED);
+    assert(table_ball_checksum(racked) != game.checksum);
+    scene_free(racked);
+
+    scene_t *first = replay(loaded);
+    scene_t *second = replay(loaded);
+    assert(table_ball_checksum(first) == game.checksum);
+    assert(table_ball_checksum(second) == game.checksum);
+    assert(scene_get_state(first) == scene_get_state(second));
+    assert(scene_get_turn(first) == scene_get_turn(second));
+    list_t *balls1 = scene_get_balls(first);
+    list_t *balls2 = scene_get_balls(second);
+    for (size_t i = 0; i < TABLE_BALLS; i++) {
+        assert(vec_equal(body_get_centroid(ball_get_body(list_get(balls1, i))),
+                         body_get_centroid(ball_get_body(list_get(balls2, i)))));
+    }
+    scene_free(first);
+    scene_free(second);
+
+    remove(LOG_PATH);
+    input_log_free(loaded);
+    input_log_free(game.log);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_save_load)
+    DO_TEST(test_replay_deterministic)
+
+    puts("input_log_test PASS");
+}
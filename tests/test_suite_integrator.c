@@ -0,0 +1,169 @@
+#include "forces.h"
+#include "integrator.h"
+#include "test_util.h"
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+
+// The scenes from demo/integrator_bench.c, run for 10 seconds at 120 ticks per second.
+// Each integrator's energy bound is a few times the error it has today,
+// so a change that makes one noticeably worse fails.
+const double DT = 1.0 / 120;
+const int STEPS = 1200;
+const integrator_t INTEGRATORS[] = {
+    INTEGRATOR_TRAPEZOID, INTEGRATOR_SEMI_IMPLICIT_EULER,
+    INTEGRATOR_VELOCITY_VERLET, INTEGRATOR_RK4
+};
+const size_t NUM_INTEGRATORS = sizeof(INTEGRATORS) / sizeof(INTEGRATORS[0]);
+// The worst relative energy error allowed, indexed like INTEGRATORS
+const double ORBIT_ENERGY_BOUNDS[] = {0.3, 5e-4, 5e-8, 1e-9};
+const double SPRING_ENERGY_BOUNDS[] = {0.4, 2e-2, 2e-4, 2e-9};
+
+const double ORBIT_G = 20;
+const double SUN_MASS = 1e6;
+const double PLANET_MASS = 1;
+const double ORBIT_RADIUS = 200;
+const double SPRING_K = 100;
+const double SPRING_MASS = 25;
+const double SPRING_STRETCH = 100;
+const double BINARY_MASS = 1000;
+const double BINARY_SEPARATION = 200;
+
+body_t *make_square_body(vector_t center, double mass) {
+    list_t *shape = list_init(4, free);
+    for (int i = 0; i < 4; i++) {
+        vector_t *v = malloc(sizeof(*v));
+        *v = vec_add(center, (vector_t) {i == 0 || i == 3 ? -2 : 2, i < 2 ? -2 : 2});
+        list_add(shape, v);
+    }
+    return body_init(shape, mass, (rgb_color_t) {0, 0, 0});
+}
+
+double kinetic(body_t *body) {
+    vector_t v = body_get_velocity(body);
+    return 0.5 * body_get_mass(body) * vec_dot(v, v);
+}
+
+// A planet in a circular orbit, with zero total momentum
+scene_t *make_orbit() {
+    scene_t *scene = scene_init();
+    body_t *sun = make_square_body(VEC_ZERO, SUN_MASS);
+    body_t *planet = make_square_body((vector_t) {ORBIT_RADIUS, 0}, PLANET_MASS);
+    double speed = sqrt(ORBIT_G * SUN_MASS / ORBIT_RADIUS);
+    body_set_velocity(planet, (vector_t) {0, speed});
+    body_set_velocity(sun, (vector_t) {0, -speed * PLANET_MASS / SUN_MASS});
+    scene_add_body(scene, sun);
+    scene_add_body(scene, planet);
+    create_newtonian_gravity(scene, ORBIT_G, sun, planet);
+    return scene;
+}
+
+double orbit_energy(scene_t *scene) {
+    body_t *sun = scene_get_body(scene, 0);
+    body_t *planet = scene_get_body(scene, 1);
+    double r = vec_magnitude(vec_subtract(body_get_centroid(sun), body_get_centroid(planet)));
+    return kinetic(sun) + kinetic(planet) - ORBIT_G * SUN_MASS * PLANET_MASS / r;
+}
+
+// A mass on a spring to a fixed anchor
+scene_t *make_spring() {
+    scene_t *scene = scene_init();
+    body_t *anchor = make_square_body(VEC_ZERO, DBL_MAX);
+    body_t *mass = make_square_body((vector_t) {SPRING_STRETCH, 0}, SPRING_MASS);
+    scene_add_body(scene, anchor);
+    scene_add_body(scene, mass);
+    create_spring(scene, SPRING_K, anchor, mass);
+    return scene;
+}
+
+double spring_energy(scene_t *scene) {
+    body_t *mass = scene_get_body(scene, 1);
+    vector_t x = vec_subtract(body_get_centroid(mass), body_get_centroid(scene_get_body(scene, 0)));
+    return kinetic(mass) + 0.5 * SPRING_K * vec_dot(x, x);
+}
+
+double worst_energy_error(scene_t *scene, double (*energy)(scene_t *)) {
+    double start = energy(scene);
+    double worst = 0;
+    for (int i = 0; i < STEPS; i++) {
+        scene_tick(scene, DT);
+        worst = fmax(worst, fabs(energy(scene) - start) / fabs(start));
+    }
+    return worst;
+}
+
+void test_stages() {
+    assert(integrator_stages(INTEGRATOR_TRAPEZOID) == 1);
+    assert(integrator_stages(INTEGRATOR_SEMI_IMPLICIT_EULER) == 1);
+    assert(integrator_stages(INTEGRATOR_VELOCITY_VERLET) == 2);
+    assert(integrator_stages(INTEGRATOR_RK4) == 4);
+}
+
+// Tests that each integrator keeps an orbit's energy within its bound
+void test_orbit_energy() {
+    for (size_t i = 0; i < NUM_INTEGRATORS; i++) {
+        scene_t *scene = make_orbit();
+        scene_set_integrator(scene, INTEGRATORS[i]);
+        assert(worst_energy_error(scene, orbit_energy) < ORBIT_ENERGY_BOUNDS[i]);
+        scene_free(scene);
+    }
+}
+
+// Tests that each integrator keeps a spring's energy within its bound
+void test_spring_energy() {
+    for (size_t i = 0; i < NUM_INTEGRATORS; i++) {
+        scene_t *scene = make_spring();
+        scene_set_integrator(scene, INTEGRATORS[i]);
+        assert(worst_energy_error(scene, spring_energy) < SPRING_ENERGY_BOUNDS[i]);
+        scene_free(scene);
+    }
+}
+
+// Tests that each integrator keeps the momentum of two bodies pulling on each other,
+// with equal masses so neither is slow enough for body_tick() to stop it
+void test_binary_momentum() {
+    const vector_t DRIFT = {3, 1};
+    double speed = sqrt(ORBIT_G * BINARY_MASS / (2 * BINARY_SEPARATION));
+    for (size_t i = 0; i < NUM_INTEGRATORS; i++) {
+        scene_t *scene = scene_init();
+        scene_set_integrator(scene, INTEGRATORS[i]);
+        body_t *body1 = make_square_body((vector_t) {-BINARY_SEPARATION / 2, 0}, BINARY_MASS);
+        body_t *body2 = make_square_body((vector_t) {BINARY_SEPARATION / 2, 0}, BINARY_MASS);
+        body_set_velocity(body1, vec_add(DRIFT, (vector_t) {0, -speed}));
+        body_set_velocity(body2, vec_add(DRIFT, (vector_t) {0, speed}));
+        scene_add_body(scene, body1);
+        scene_add_body(scene, body2);
+        create_newtonian_gravity(scene, ORBIT_G, body1, body2);
+        vector_t momentum = vec_multiply(2 * BINARY_MASS, DRIFT);
+        for (int step = 0; step < STEPS; step++) {
+            scene_tick(scene, DT);
+            vector_t total = vec_add(
+                vec_multiply(BINARY_MASS, body_get_velocity(body1)),
+                vec_multiply(BINARY_MASS, body_get_velocity(body2))
+            );
+            assert(vec_within_epsilon(1e-9 * BINARY_MASS * speed, total, momentum));
+        }
+        // The center of mass drifts in a straight line
+        vector_t center = vec_multiply(0.5, vec_add(body_get_centroid(body1), body_get_centroid(body2)));
+        assert(vec_within_epsilon(1e-6, center, vec_multiply(STEPS * DT, DRIFT)));
+        scene_free(scene);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_stages)
+    DO_TEST(test_orbit_energy)
+    DO_TEST(test_spring_energy)
+    DO_TEST(test_binary_momentum)
+
+    puts("integrator_test PASS");
+}
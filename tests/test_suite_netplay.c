@@ -0,0 +1,147 @@
+#include "netplay.h"
+#include "table.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+// Two computer players over a loopback, as in demo/netplay_sim.c
+const double DT = 1.0 / 120;
+const uint64_t LOSS_SEED = 12345;
+const unsigned int RACK_SEED = 7;
+// How likely a player is to shoot on each tick of their turn
+const double SHOOT_CHANCE = 1.0 / 90;
+// How far a player sweeps the cue each tick while aiming, in radians
+const double AIM_STEP = 0.02;
+const double SHOT_MIN_POWER = 0.5;
+const double SHOT_MAX_POWER = 2.0;
+// A rollback this long has to fit in a 60 Hz frame
+const size_t BUDGET_TICKS = 10;
+const double FRAME_SECONDS = 1.0 / 60;
+
+typedef struct {
+    loopback_t *loopback;
+    scene_t *scenes[2];
+    netplay_t *games[2];
+    double aims[2];
+} match_t;
+
+double random_fraction(void) {
+    return (double)rand() / RAND_MAX;
+}
+
+/**
+ * Decides what a computer player does this tick, from their own view of the table.
+ */
+net_input_t choose_input(scene_t *scene, int player, double *aim) {
+    int state = scene_get_state(scene);
+    if (scene_get_turn(scene) != player || (state != PLACING && state != FIRING)
+        || balls_moving(scene_get_balls(scene))) {
+        return (net_input_t) {0};
+    }
+    *aim += AIM_STEP;
+    if (random_fraction() >= SHOOT_CHANCE) {
+        return (net_input_t) {.actions = NET_AIM, .angle = *aim};
+    }
+    net_input_t input = {
+        .actions = NET_SHOOT,
+        .angle = random_fraction() * 2 * M_PI,
+        .power = SHOT_MIN_POWER + random_fraction() * (SHOT_MAX_POWER - SHOT_MIN_POWER)
+    };
+    if (state == PLACING) {
+        input.actions |= NET_PLACE;
+        input.position = CUE_BALL_START;
+    }
+    return input;
+}
+
+/**
+ * Plays a number of ticks, then lets both sides catch up to the same tick
+ * and wait for all of each other's input.
+ */
+match_t play_match(uint32_t latency, double loss, size_t max_rollback, int ticks) {
+    match_t match = {loopback_init(latency, loss, LOSS_SEED), {NULL}, {NULL}, {0, M_PI}};
+    for (int p = 0; p < 2; p++) {
+        // Both sides rack the same way
+        srand(RACK_SEED);
+        match.scenes[p] = scene_init();
+        scene_set_state(match.scenes[p], MENU);
+        populate_scene(match.scenes[p]);
+        scene_set_state(match.scenes[p], PLACING);
+        match.games[p] = netplay_init(match.scenes[p], p, loopback_get_end(match.loopback, p),
+                                      DT, max_rollback);
+    }
+    for (int i = 0; i < ticks; i++) {
+        for (int p = 0; p < 2; p++) {
+            netplay_advance(match.games[p], choose_input(match.scenes[p], p, &match.aims[p]));
+        }
+        loopback_tick(match.loopback);
+    }
+    uint32_t end = fmax(netplay_get_tick(match.games[0]), netplay_get_tick(match.games[1]));
+    while (netplay_get_confirmed_tick(match.games[0]) < end
+           || netplay_get_confirmed_tick(match.games[1]) < end) {
+        for (int p = 0; p < 2; p++) {
+            if (netplay_get_tick(match.games[p]) < end) {
+                netplay_advance(match.games[p], (net_input_t) {0});
+            }
+            else {
+                netplay_poll(match.games[p]);
+            }
+        }
+        loopback_tick(match.loopback);
+    }
+    return match;
+}
+
+void free_match(match_t match) {
+    for (int p = 0; p < 2; p++) {
+        netplay_free(match.games[p]);
+        scene_free(match.scenes[p]);
+    }
+    loopback_free(match.loopback);
+}
+
+// Tests that both sides end up with the same table after a minute of shots over a lossy link
+void test_peers_agree() {
+    match_t match = play_match(6, 0.05, 20, 120 * 60);
+    size_t sent, lost;
+    loopback_get_counts(match.loopback, &sent, &lost);
+    assert(lost > 0);
+    netplay_stats_t stats[2] = {netplay_get_stats(match.games[0]), netplay_get_stats(match.games[1])};
+    assert(stats[0].rollbacks > 0 && stats[1].rollbacks > 0);
+    assert(netplay_get_tick(match.games[0]) == netplay_get_tick(match.games[1]));
+    assert(table_ball_checksum(match.scenes[0]) == table_ball_checksum(match.scenes[1]));
+    assert(scene_get_state(match.scenes[0]) == scene_get_state(match.scenes[1]));
+    assert(scene_get_turn(match.scenes[0]) == scene_get_turn(match.scenes[1]));
+    free_match(match);
+}
+
+// Tests that rolling back as far as a shot BUDGET_TICKS late takes under a frame
+void test_rollback_fits_frame() {
+    // Input is always exactly the budget late, so every rollback is that long
+    match_t match = play_match(BUDGET_TICKS, 0, 2 * BUDGET_TICKS, 120 * 30);
+    for (int p = 0; p < 2; p++) {
+        netplay_stats_t stats = netplay_get_stats(match.games[p]);
+        assert(stats.rollbacks > 0);
+        assert(stats.max_resimulated_ticks >= BUDGET_TICKS);
+        assert(stats.max_resimulated_ticks <= BUDGET_TICKS + 1);
+        assert(stats.max_rollback_seconds < FRAME_SECONDS);
+    }
+    assert(table_ball_checksum(match.scenes[0]) == table_ball_checksum(match.scenes[1]));
+    free_match(match);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_peers_agree)
+    DO_TEST(test_rollback_fits_frame)
+
+    puts("netplay_test PASS");
+}
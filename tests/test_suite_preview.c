@@ -0,0 +1,173 @@
+#include "ball.h"
+#include "preview.h"
+#include "scene.h"
+#include "table.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const unsigned int RACK_SEED = 3;
+const double DT = 1.0 / 60.0;
+const int MAX_TICKS = 60 * 60;
+// Enough for any path to finish in one call
+const double REFINE_SECONDS = 10;
+// How far the cue ball may turn before it counts as having bounced, in radians
+const double DIRECTION_TOLERANCE = 0.05;
+
+typedef struct aim {
+    double angle;
+    double power;
+    preview_contact_t contact;
+} aim_t;
+
+// Angles are multiples of the preview's angle step, and powers of its power step,
+// so the preview simulates exactly the shot that is played
+const aim_t AIMS[] = {
+    // Into the rack
+    {3.142, 2.0, PREVIEW_BALL},
+    {3.100, 3.0, PREVIEW_BALL},
+    // Straight up and down the table, and back towards the head cushion
+    {4.712, 1.0, PREVIEW_CUSHION},
+    {1.571, 2.5, PREVIEW_CUSHION},
+    {0.000, 1.5, PREVIEW_CUSHION},
+    // Into the top left corner pocket
+    {5.240, 1.5, PREVIEW_POCKET},
+    // Too soft to reach anything
+    {4.712, 0.1, PREVIEW_STOPS}
+};
+#define NUM_AIMS (sizeof(AIMS) / sizeof(*AIMS))
+
+scene_t *rack(void) {
+    srand(RACK_SEED);
+    scene_t *scene = scene_init();
+    populate_scene(scene);
+    assert(table_place_cue_ball(scene, CUE_BALL_START));
+    update_game_state(scene);
+    return scene;
+}
+
+body_t *get_ball(scene_t *scene, size_t number) {
+    return ball_get_body(list_get(scene_get_balls(scene), number));
+}
+
+double angle_between(vector_t v1, vector_t v2) {
+    double cosine = vec_dot(v1, v2) / (vec_magnitude(v1) * vec_magnitude(v2));
+    return acos(fmax(-1, fmin(1, cosine)));
+}
+
+/**
+ * Plays a shot in full and stops at the first thing the cue ball touches.
+ *
+ * @param ball set to the ball struck, if any
+ * @param position set to where the cue ball was on the tick it touched something or stopped
+ */
+preview_contact_t play_to_contact(scene_t *scene, double angle, double power,
+                                  int *ball, vector_t *position) {
+    vector_t rest[TABLE_BALLS];
+    for (size_t i = 0; i < TABLE_BALLS; i++) {
+        rest[i] = body_get_centroid(get_ball(scene, i));
+    }
+    table_aim(scene, angle);
+    table_shoot(scene, power);
+    body_t *cue_ball = get_ball(scene, 0);
+    vector_t direction = VEC_ZERO;
+    vector_t last = rest[0];
+    for (int tick = 0; tick < MAX_TICKS; tick++) {
+        scene_tick(scene, DT);
+        vector_t velocity = body_get_velocity(cue_ball);
+        vector_t centroid = body_get_centroid(cue_ball);
+        for (size_t i = 1; i < TABLE_BALLS; i++) {
+            if (!vec_equal(body_get_centroid(get_ball(scene, i)), rest[i])) {
+                *ball = i;
+                *position = last;
+                return PREVIEW_BALL;
+            }
+        }
+        // A sunk cue ball is put back off the table, left of the head cushion
+        if (centroid.x < KITCHEN[0].x) {
+            *position = last;
+            return PREVIEW_POCKET;
+        }
+        if (vec_equal(direction, VEC_ZERO)) {
+            // Still waiting for the cue to strike
+            direction = velocity;
+        }
+        else if (vec_equal(velocity, VEC_ZERO)) {
+            *position = centroid;
+            return PREVIEW_STOPS;
+        }
+        else if (angle_between(velocity, direction) > DIRECTION_TOLERANCE) {
+            *position = last;
+            return PREVIEW_CUSHION;
+        }
+        last = centroid;
+    }
+    return PREVIEW_UNKNOWN;
+}
+
+// Tests that the preview's first contact is what happens when the shot is played
+void test_first_contact_matches_shot() {
+    preview_t *preview = preview_init(DT);
+    for (size_t i = 0; i < NUM_AIMS; i++) {
+        scene_t *scene = rack();
+        preview_set_table(preview, scene);
+        preview_aim(preview, AIMS[i].angle, AIMS[i].power);
+        assert(preview_refine(preview, REFINE_SECONDS));
+        aim_preview_t path = preview_get(preview);
+        assert(path.contact == AIMS[i].contact);
+        assert(vec_equal(path.start, CUE_BALL_START));
+
+        int ball = -1;
+        vector_t position;
+        preview_contact_t contact = play_to_contact(scene, AIMS[i].angle, AIMS[i].power,
+                                                    &ball, &position);
+        assert(contact == path.contact);
+        // The cue ball gets there within a tick of the preview
+        assert(vec_magnitude(vec_subtract(position, path.end)) < path.radius);
+        // The rack is packed tight, so the struck ball's neighbours push it off
+        // the direction the preview gives; only which ball is struck is compared
+        assert(ball == path.ball);
+        scene_free(scene);
+    }
+    preview_free(preview);
+}
+
+// Tests that sweeping back to an aim gives the same path as working it out afresh
+void test_cached_path_reused() {
+    scene_t *scene = rack();
+    preview_t *preview = preview_init(DT);
+    preview_set_table(preview, scene);
+    aim_preview_t first[NUM_AIMS];
+    for (size_t i = 0; i < NUM_AIMS; i++) {
+        preview_aim(preview, AIMS[i].angle, AIMS[i].power);
+        assert(preview_refine(preview, REFINE_SECONDS));
+        first[i] = preview_get(preview);
+    }
+    for (size_t i = 0; i < NUM_AIMS; i++) {
+        preview_aim(preview, AIMS[i].angle, AIMS[i].power);
+        // Already finished, so no time is needed
+        assert(preview_refine(preview, 0));
+        aim_preview_t again = preview_get(preview);
+        assert(again.contact == first[i].contact);
+        assert(vec_equal(again.end, first[i].end));
+        assert(again.ball == first[i].ball);
+    }
+    preview_free(preview);
+    scene_free(scene);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_first_contact_matches_shot)
+    DO_TEST(test_cached_path_reused)
+
+    puts("preview_test PASS");
+}
@@ -0,0 +1,166 @@
+#include "forces.h"
+#include "quadtree.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#define NUM_POINTS 300
+const double G = 20;
+const double MIN_DISTANCE = 5;
+
+// Scatters points over a 1000x1000 square, with a few close pairs
+void make_points(vector_t *positions, double *masses, size_t count) {
+    srand(1);
+    for (size_t i = 0; i < count; i++) {
+        positions[i] = (vector_t) {rand() % 1000, rand() % 1000};
+        masses[i] = 1 + rand() % 100;
+    }
+    positions[1] = vec_add(positions[0], (vector_t) {3, 0});
+    positions[3] = vec_add(positions[2], (vector_t) {0, 7});
+}
+
+// Sums the pull of every other point, as create_newtonian_gravity() would
+vector_t exact_force(const vector_t *positions, const double *masses, size_t count, size_t i) {
+    vector_t force = VEC_ZERO;
+    for (size_t j = 0; j < count; j++) {
+        vector_t r = vec_subtract(positions[i], positions[j]);
+        double dist = vec_magnitude(r);
+        if (j == i || dist <= MIN_DISTANCE) {
+            continue;
+        }
+        double scale = -G * masses[i] * masses[j] / (dist * dist * dist);
+        force = vec_add(force, vec_multiply(scale, r));
+    }
+    return force;
+}
+
+// Tests that with theta = 0, every force is the exact sum over all pairs
+void test_theta_zero_exact() {
+    vector_t positions[NUM_POINTS];
+    double masses[NUM_POINTS];
+    make_points(positions, masses, NUM_POINTS);
+    quadtree_t *tree = quadtree_init();
+    quadtree_build(tree, positions, masses, NUM_POINTS);
+    for (size_t i = 0; i < NUM_POINTS; i++) {
+        vector_t expected = exact_force(positions, masses, NUM_POINTS, i);
+        vector_t force = quadtree_force(tree, i, G, 0, MIN_DISTANCE);
+        assert(vec_within_epsilon(1e-9 * vec_magnitude(expected), force, expected));
+    }
+    quadtree_free(tree);
+}
+
+// Tests that a typical theta stays close to the exact forces
+void test_theta_half_close() {
+    vector_t positions[NUM_POINTS];
+    double masses[NUM_POINTS];
+    make_points(positions, masses, NUM_POINTS);
+    quadtree_t *tree = quadtree_init();
+    quadtree_build(tree, positions, masses, NUM_POINTS);
+    double error = 0;
+    double total = 0;
+    for (size_t i = 0; i < NUM_POINTS; i++) {
+        vector_t expected = exact_force(positions, masses, NUM_POINTS, i);
+        vector_t force = quadtree_force(tree, i, G, 0.5, MIN_DISTANCE);
+        error += vec_magnitude(vec_subtract(force, expected));
+        total += vec_magnitude(expected);
+    }
+    assert(error / total < 0.01);
+    quadtree_free(tree);
+}
+
+// Tests that a tree can be rebuilt with more and then fewer points
+void test_rebuild() {
+    vector_t positions[NUM_POINTS];
+    double masses[NUM_POINTS];
+    make_points(positions, masses, NUM_POINTS);
+    quadtree_t *tree = quadtree_init();
+    quadtree_build(tree, positions, masses, 2);
+    quadtree_build(tree, positions, masses, NUM_POINTS);
+    quadtree_build(tree, positions, masses, 10);
+    for (size_t i = 0; i < 10; i++) {
+        vector_t expected = exact_force(positions, masses, 10, i);
+        vector_t force = quadtree_force(tree, i, G, 0, MIN_DISTANCE);
+        assert(vec_within_epsilon(1e-9 * vec_magnitude(expected), force, expected));
+    }
+    // A single point feels nothing
+    quadtree_build(tree, positions, masses, 1);
+    assert(vec_equal(quadtree_force(tree, 0, G, 0, MIN_DISTANCE), VEC_ZERO));
+    quadtree_free(tree);
+}
+
+body_t *make_point_body(vector_t center, double mass) {
+    list_t *shape = list_init(4, free);
+    for (int i = 0; i < 4; i++) {
+        vector_t *v = malloc(sizeof(*v));
+        *v = vec_add(center, (vector_t) {i == 0 || i == 3 ? -1 : 1, i < 2 ? -1 : 1});
+        list_add(shape, v);
+    }
+    return body_init(shape, mass, (rgb_color_t) {0, 0, 0});
+}
+
+scene_t *make_cluster(vector_t *positions, double *masses, size_t count) {
+    scene_t *scene = scene_init();
+    for (size_t i = 0; i < count; i++) {
+        scene_add_body(scene, make_point_body(positions[i], masses[i]));
+    }
+    return scene;
+}
+
+// Tests that create_nbody_gravity() with theta = 0 moves bodies
+// the same as create_newtonian_gravity() on every pair
+void test_nbody_gravity_matches_pairs() {
+    const size_t COUNT = 40;
+    const double DT = 1.0 / 60;
+    const int STEPS = 120;
+    // Strong enough that the bodies move tens of pixels, but not so close they scatter chaotically
+    const double STRONG_G = 1e3;
+    vector_t positions[NUM_POINTS];
+    double masses[NUM_POINTS];
+    make_points(positions, masses, COUNT);
+    scene_t *pairs = make_cluster(positions, masses, COUNT);
+    scene_t *tree = make_cluster(positions, masses, COUNT);
+    for (size_t i = 0; i < COUNT; i++) {
+        for (size_t j = i + 1; j < COUNT; j++) {
+            create_newtonian_gravity(pairs, STRONG_G, scene_get_body(pairs, i), scene_get_body(pairs, j));
+        }
+    }
+    list_t *bodies = list_init(COUNT, NULL);
+    for (size_t i = 0; i < COUNT; i++) {
+        list_add(bodies, scene_get_body(tree, i));
+    }
+    create_nbody_gravity(tree, STRONG_G, bodies, 0);
+    for (int step = 0; step < STEPS; step++) {
+        scene_tick(pairs, DT);
+        scene_tick(tree, DT);
+    }
+    double moved = 0;
+    for (size_t i = 0; i < COUNT; i++) {
+        moved += vec_magnitude(vec_subtract(body_get_centroid(scene_get_body(tree, i)), positions[i]));
+        assert(vec_within_epsilon(
+            1e-6,
+            body_get_centroid(scene_get_body(tree, i)),
+            body_get_centroid(scene_get_body(pairs, i))
+        ));
+    }
+    assert(moved / COUNT > 10);
+    scene_free(pairs);
+    scene_free(tree);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_theta_zero_exact)
+    DO_TEST(test_theta_half_close)
+    DO_TEST(test_rebuild)
+    DO_TEST(test_nbody_gravity_matches_pairs)
+
+    puts("quadtree_test PASS");
+}
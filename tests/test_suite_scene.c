@@ -13,6 +13,7 @@ void scene_remove_first(void *scene) {
 
 void test_empty_scene() {
     scene_t *scene = scene_init();
+    scene_set_integrator(scene, INTEGRATOR_SEMI_IMPLICIT_EULER);
     assert(scene_bodies(scene) == 0);
     for (int i = 0; i < 10; i++) scene_tick(scene, 1);
     assert(test_assert_fail(scene_get_first, scene));
@@ -40,6 +41,7 @@ list_t *make_shape() {
 void test_scene() {
     // Build a scene with 3 bodies
     scene_t *scene = scene_init();
+    scene_set_integrator(scene, INTEGRATOR_SEMI_IMPLICIT_EULER);
     assert(scene_bodies(scene) == 0);
     body_t *body1 = body_init(make_shape(), 1, (rgb_color_t) {1, 1, 1});
     scene_add_body(scene, body1);
@@ -106,6 +108,7 @@ void test_force_creator() {
     const double DT = 1e-6;
     const int STEPS = 1000000;
     scene_t *scene = scene_init();
+    scene_set_integrator(scene, INTEGRATOR_SEMI_IMPLICIT_EULER);
     body_t *body = body_init(make_shape(), 123, (rgb_color_t) {0, 0, 0});
     vector_t radius = {R, 0};
     body_set_centroid(body, radius);
@@ -114,7 +117,7 @@ void test_force_creator() {
     scene_add_force_creator(scene, centripetal_force, body, NULL);
     for (int i = 0; i < STEPS; i++) {
         vector_t expected_x = vec_rotate(radius, OMEGA * i * DT);
-        assert(vec_within(1e-4, body_get_centroid(body), expected_x));
+        assert(vec_within_epsilon(1e-4, body_get_centroid(body), expected_x));
         scene_tick(scene, DT);
     }
     scene_free(scene);
@@ -155,6 +158,7 @@ void test_force_creator_aux() {
     const double DT = 1e-3;
     const int STEPS = 100000;
     scene_t *scene = scene_init();
+    scene_set_integrator(scene, INTEGRATOR_SEMI_IMPLICIT_EULER);
     body_t *light = body_init(make_shape(), LIGHT_MASS, (rgb_color_t) {0, 0, 0});
     scene_add_body(scene, light);
     body_t *heavy = body_init(make_shape(), HEAVY_MASS, (rgb_color_t) {0, 0, 0});
@@ -208,6 +212,7 @@ void count_calls(void *aux) {
 
 void test_reaping() {
     scene_t *scene = scene_init();
+    scene_set_integrator(scene, INTEGRATOR_SEMI_IMPLICIT_EULER);
     for (int i = 0; i < 3; i++) {
         scene_add_body(scene, body_init(make_shape(), 1, (rgb_color_t) {0, 0, 0}));
     }
@@ -0,0 +1,237 @@
+#include "binary_io.h"
+#include "controls.h"
+#include "shot_log.h"
+#include "table.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const double DT = 1.0 / 120;
+// The same as pool -g, so the recorded games are the size the game's would be
+const size_t SNAPSHOT_INTERVAL = 24;
+const char *const SHOTS_PATH = "out/test_suite_shot_log.shots";
+// How many ticks space is held to wind up a shot taken with the controls
+const int WIND_UP_TICKS = 6;
+// The powers a computer player shoots with
+const double AI_POWERS[] = {0.8, 1.3, 1.9};
+
+/**
+ * A game of random shots as it was played, with the checksum after every tick.
+ */
+typedef struct {
+    shot_log_t *log;
+    double *checksums;
+    uint32_t ticks;
+} recorded_game_t;
+
+// Uniform in [0, 1), from a generator of its own so rand() is left to the rack
+double next_random(uint32_t *state) {
+    *state = *state * 1664525u + 1013904223u;
+    return (*state >> 8) / (double)(1 << 24);
+}
+
+/**
+ * Plays a game until a number of shots have been taken, recording it the way pool -g does.
+ * Shots alternate between a computer player's steps, see ai_play_shot(),
+ * and the controls: the mouse aims, space is held for a few ticks and then released.
+ */
+recorded_game_t record_game(unsigned int seed, size_t shots) {
+    // Racked the same way as shot_replay_init()
+    srand(seed);
+    scene_t *scene = scene_init();
+    scene_set_state(scene, MENU);
+    populate_scene(scene);
+    scene_set_state(scene, PLACING);
+
+    recorded_game_t game = {shot_log_init(seed, DT, SNAPSHOT_INTERVAL), NULL, 0};
+    size_t capacity = 1024;
+    game.checksums = malloc(sizeof(double) * capacity);
+    assert(game.checksums != NULL);
+    uint32_t random = seed;
+    int wind_up = 0;
+    while (shot_log_shots(game.log) < shots) {
+        if (game.ticks == capacity) {
+            capacity *= 2;
+            game.checksums = realloc(game.checksums, sizeof(double) * capacity);
+            assert(game.checksums != NULL);
+        }
+        game.checksums[game.ticks] = table_ball_checksum(scene);
+        int state = scene_get_state(scene);
+        assert(state != GAME_OVER_1 && state != GAME_OVER_2);
+        if (state == PLACING) {
+            assert(table_place_cue_ball(scene, CUE_BALL_START));
+            shot_log_add(game.log, (shot_event_t) {
+                .tick = game.ticks, .type = SHOT_PLACE, .position = CUE_BALL_START
+            });
+        }
+        else if (state == FIRING && table_get_cue(scene) != NULL && shot_log_shots(game.log) % 2 == 0) {
+            double angle = next_random(&random) * 2 * M_PI;
+            double power = AI_POWERS[(int)(next_random(&random) * 3)];
+            update_game_state(scene);
+            table_aim(scene, angle);
+            table_shoot(scene, power);
+            shot_log_add(game.log, (shot_event_t) {
+                .tick = game.ticks, .type = SHOT_SHOOT, .angle = angle, .power = power
+            });
+        }
+        else if (state == FIRING && table_get_cue(scene) != NULL && wind_up < WIND_UP_TICKS) {
+            // Aim at a whole pixel, as the mouse does, between pulls on the cue
+            vector_t mouse = {100 + (int)(next_random(&random) * 800), 100 + (int)(next_random(&random) * 300)};
+            controls_on_mouse(MOUSE_MOVED, scene, 0, mouse);
+            controls_on_key(SPACE, KEY_PRESSED, wind_up * DT, scene);
+            wind_up++;
+        }
+        else if (state == FIRING && table_get_cue(scene) != NULL) {
+            // Held for a whole number of milliseconds, as SDL times key presses
+            double power = (500 + (int)(next_random(&random) * 1500)) / 1000.0;
+            double pull_back = controls_get_pull_back(scene);
+            controls_on_key(SPACE, KEY_RELEASED, power, scene);
+            assert(scene_get_state(scene) == SETTLING);
+            shot_log_add(game.log, (shot_event_t) {
+                .tick = game.ticks, .type = SHOT_SHOOT, .angle = body_get_angle(table_get_cue(scene)),
+                .power = power, .pull_back = pull_back
+            });
+            wind_up = 0;
+        }
+        scene_tick(scene, DT);
+        update_game_state(scene);
+        table_park_sunk_balls(scene);
+        game.ticks++;
+        shot_log_observe(game.log, scene, game.ticks);
+    }
+    shot_log_set_ticks(game.log, game.ticks);
+    scene_free(scene);
+    return game;
+}
+
+void free_game(recorded_game_t game) {
+    shot_log_free(game.log);
+    free(game.checksums);
+}
+
+long file_size(const char *path) {
+    FILE *file = fopen(path, "rb");
+    assert(file != NULL);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+// Tests that compact doubles read back bit for bit, and that whole thousandths are short
+void test_compact_doubles() {
+    const double VALUES[] = {0, -0.0, 0.8, 1.3, 250, -3.5, -1e6, 1.0 / 3, M_PI, -1e9, NAN, INFINITY};
+    // -0.0 and values that are not whole thousandths take a marker and all 8 bytes
+    const long SIZES[] = {1, 9, 2, 2, 3, 2, 5, 9, 9, 9, 9, 9};
+    const size_t COUNT = sizeof(VALUES) / sizeof(VALUES[0]);
+    FILE *file = fopen(SHOTS_PATH, "w+b");
+    assert(file != NULL);
+    for (size_t i = 0; i < COUNT; i++) {
+        long start = ftell(file);
+        write_compact_double(file, VALUES[i]);
+        assert(ftell(file) - start == SIZES[i]);
+    }
+    rewind(file);
+    for (size_t i = 0; i < COUNT; i++) {
+        double value;
+        assert(read_compact_double(file, &value));
+        assert(memcmp(&value, &VALUES[i], sizeof(value)) == 0);
+    }
+    double value;
+    assert(!read_compact_double(file, &value));
+    fclose(file);
+}
+
+// Tests that replaying the recording gives the same balls at every tick as the game
+void test_replay_matches_game() {
+    recorded_game_t game = record_game(3, 12);
+    shot_replay_t *replay = shot_replay_init(game.log);
+    for (uint32_t tick = 0; tick < game.ticks; tick++) {
+        assert(shot_replay_get_tick(replay) == tick);
+        assert(table_ball_checksum(shot_replay_get_scene(replay)) == game.checksums[tick]);
+        shot_replay_step(replay);
+    }
+    shot_replay_free(replay);
+    free_game(game);
+}
+
+// Tests that a full game of 40 shots saves in well under a kilobyte, and that once reloaded
+// it seeks to the same balls as the game, forwards and backwards,
+// from its saved table and from the start
+void test_save_load_seek() {
+    recorded_game_t game = record_game(3, 40);
+    assert(shot_log_snapshots(game.log) == 1);
+    assert(shot_log_save(game.log, SHOTS_PATH));
+    assert(file_size(SHOTS_PATH) < 768);
+    shot_log_t *loaded = shot_log_load(SHOTS_PATH);
+    assert(loaded != NULL);
+    assert(shot_log_size(loaded) == shot_log_size(game.log));
+    assert(shot_log_snapshots(loaded) == 1);
+    assert(shot_log_get_ticks(loaded) == game.ticks);
+    for (size_t i = 0; i < shot_log_size(loaded); i++) {
+        shot_event_t expected = shot_log_get(game.log, i), event = shot_log_get(loaded, i);
+        assert(event.tick == expected.tick && event.type == expected.type);
+        assert(vec_equal(event.position, expected.position));
+        assert(event.angle == expected.angle && event.power == expected.power);
+        assert(event.pull_back == expected.pull_back);
+    }
+
+    // The table is saved after the 24th shot, about two thirds of the way through
+    uint32_t end = game.ticks - 1;
+    const uint32_t SEEKS[] = {end, 3 * end / 4, end / 10, end / 20, 7 * end / 10, 0, 9 * end / 10};
+    shot_replay_t *replay = shot_replay_init(loaded);
+    for (size_t i = 0; i < sizeof(SEEKS) / sizeof(SEEKS[0]); i++) {
+        shot_replay_seek(replay, SEEKS[i]);
+        assert(shot_replay_get_tick(replay) == SEEKS[i]);
+        assert(table_ball_checksum(shot_replay_get_scene(replay)) == game.checksums[SEEKS[i]]);
+    }
+    shot_replay_free(replay);
+    shot_log_free(loaded);
+    free_game(game);
+}
+
+// Tests that files that are cut short or are not recordings are not loaded
+void test_load_rejects_bad_files() {
+    recorded_game_t game = record_game(3, 4);
+    assert(shot_log_save(game.log, SHOTS_PATH));
+    long size = file_size(SHOTS_PATH);
+    FILE *file = fopen(SHOTS_PATH, "r+b");
+    assert(file != NULL);
+    char *bytes = malloc(size);
+    assert(bytes != NULL && fread(bytes, 1, size, file) == (size_t)size);
+    fclose(file);
+
+    file = fopen(SHOTS_PATH, "wb");
+    fwrite(bytes, 1, size - 1, file);
+    fclose(file);
+    assert(shot_log_load(SHOTS_PATH) == NULL);
+
+    bytes[0] = 'X';
+    file = fopen(SHOTS_PATH, "wb");
+    fwrite(bytes, 1, size, file);
+    fclose(file);
+    assert(shot_log_load(SHOTS_PATH) == NULL);
+    free(bytes);
+    free_game(game);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_compact_doubles)
+    DO_TEST(test_replay_matches_game)
+    DO_TEST(test_save_load_seek)
+    DO_TEST(test_load_rejects_bad_files)
+
+    remove(SHOTS_PATH);
+    puts("shot_log_test PASS");
+}
@@ -0,0 +1,155 @@
+#include "forces.h"
+#include "spring_network.h"
+#include "test_util.h"
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+
+const size_t LINKS = 50;
+const double LINK_MASS = 1;
+const double LINK_SPACING = 10;
+const double DT = 1.0 / 60;
+// The last link starts moving sideways at this speed
+const double INITIAL_SPEED = 100;
+
+list_t *make_shape() {
+    list_t *shape = list_init(4, free);
+    vector_t *v = malloc(sizeof(*v));
+    *v = (vector_t) {-1, -1};
+    list_add(shape, v);
+    v = malloc(sizeof(*v));
+    *v = (vector_t) {+1, -1};
+    list_add(shape, v);
+    v = malloc(sizeof(*v));
+    *v = (vector_t) {+1, +1};
+    list_add(shape, v);
+    v = malloc(sizeof(*v));
+    *v = (vector_t) {-1, +1};
+    list_add(shape, v);
+    return shape;
+}
+
+// A chain of LINKS bodies in a row, held at one end by a fixed body.
+// The springs are added by the caller.
+scene_t *make_chain(void) {
+    scene_t *scene = scene_init();
+    scene_set_integrator(scene, INTEGRATOR_SEMI_IMPLICIT_EULER);
+    for (size_t i = 0; i <= LINKS; i++) {
+        body_t *body = body_init(make_shape(), i == 0 ? DBL_MAX : LINK_MASS, (rgb_color_t) {0, 0, 0});
+        body_set_centroid(body, (vector_t) {LINK_SPACING * i, 0});
+        scene_add_body(scene, body);
+    }
+    body_set_velocity(scene_get_body(scene, LINKS), (vector_t) {0, INITIAL_SPEED});
+    return scene;
+}
+
+void add_network(scene_t *scene, double k) {
+    spring_network_t *network = spring_network_init();
+    for (size_t i = 0; i <= LINKS; i++) {
+        assert(spring_network_add_body(network, scene_get_body(scene, i)) == i);
+    }
+    for (size_t i = 0; i < LINKS; i++) {
+        spring_network_add(network, k, i, i + 1);
+    }
+    create_spring_network(scene, network);
+}
+
+double chain_energy(scene_t *scene, double k) {
+    double energy = 0;
+    for (size_t i = 1; i <= LINKS; i++) {
+        vector_t v = body_get_velocity(scene_get_body(scene, i));
+        vector_t stretch = vec_subtract(
+            body_get_centroid(scene_get_body(scene, i)),
+            body_get_centroid(scene_get_body(scene, i - 1))
+        );
+        energy += LINK_MASS * vec_dot(v, v) / 2 + k * vec_dot(stretch, stretch) / 2;
+    }
+    return energy;
+}
+
+// Tests that springs far too stiff for an explicit step at this dt
+// stay bounded, and that backward Euler only ever loses energy
+void test_stiff_chain_stable() {
+    const double K = 1e6;
+    const int STEPS = 600;
+    const int EXPLICIT_STEPS = 10;
+    // k dt^2 / m is about 280, where explicit integration blows up within a few ticks
+    assert(K * DT * DT / LINK_MASS > 100);
+    scene_t *scene = make_chain();
+    add_network(scene, K);
+    double energy = chain_energy(scene, K);
+    for (int step = 0; step < STEPS; step++) {
+        scene_tick(scene, DT);
+        double next = chain_energy(scene, K);
+        assert(isfinite(next));
+        assert(next <= energy * (1 + 1e-9));
+        energy = next;
+    }
+    assert(vec_equal(body_get_centroid(scene_get_body(scene, 0)), VEC_ZERO));
+    for (size_t i = 1; i <= LINKS; i++) {
+        vector_t position = body_get_centroid(scene_get_body(scene, i));
+        assert(vec_magnitude(position) < 2 * LINK_SPACING * LINKS);
+    }
+    scene_free(scene);
+
+    // The same chain with create_spring() gains energy every tick
+    scene = make_chain();
+    for (size_t i = 0; i < LINKS; i++) {
+        create_spring(scene, K, scene_get_body(scene, i), scene_get_body(scene, i + 1));
+    }
+    energy = chain_energy(scene, K);
+    for (int step = 0; step < EXPLICIT_STEPS; step++) {
+        scene_tick(scene, DT);
+    }
+    assert(!(chain_energy(scene, K) < 1e6 * energy));
+    scene_free(scene);
+}
+
+// Tests that a network moves a chain like create_spring() on each link
+// when the springs are soft enough for an explicit step to be accurate.
+// Backward Euler damps the chain a little each tick, so they drift apart slowly.
+void test_soft_chain_matches_explicit() {
+    const double K = 0.25;
+    const int STEPS = 240;
+    const double TOLERANCE = 0.005;
+    scene_t *implicit = make_chain();
+    add_network(implicit, K);
+    scene_t *explicit = make_chain();
+    for (size_t i = 0; i < LINKS; i++) {
+        create_spring(explicit, K, scene_get_body(explicit, i), scene_get_body(explicit, i + 1));
+    }
+    for (int step = 0; step < STEPS; step++) {
+        scene_tick(implicit, DT);
+        scene_tick(explicit, DT);
+    }
+    // Compare how far each link moved, relative to the furthest any link moved
+    double furthest = 0;
+    double worst = 0;
+    for (size_t i = 1; i <= LINKS; i++) {
+        vector_t start = {LINK_SPACING * i, 0};
+        vector_t expected = body_get_centroid(scene_get_body(explicit, i));
+        vector_t actual = body_get_centroid(scene_get_body(implicit, i));
+        furthest = fmax(furthest, vec_magnitude(vec_subtract(expected, start)));
+        worst = fmax(worst, vec_magnitude(vec_subtract(actual, expected)));
+    }
+    assert(furthest > LINK_SPACING);
+    assert(worst < TOLERANCE * furthest);
+    scene_free(implicit);
+    scene_free(explicit);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_stiff_chain_stable)
+    DO_TEST(test_soft_chain_matches_explicit)
+
+    puts("spring_network_test PASS");
+}